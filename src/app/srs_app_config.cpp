@@ -65,6 +65,12 @@ const char* _srs_version = "XCORE-"RTMP_SIG_SRS_SERVER;
 #define SRS_CONF_DEFAULT_LOG_FILE "./objs/srs.log"
 #define SRS_CONF_DEFAULT_LOG_LEVEL "trace"
 #define SRS_CONF_DEFAULT_LOG_TANK_CONSOLE "console"
+// the async log ring buffer size in MB, the max is 1GB.
+#define SRS_CONF_DEFAULT_LOG_ASYNC_SIZE 4
+#define SRS_CONF_MAX_LOG_ASYNC_SIZE 1024
+#define SRS_CONF_DEFAULT_LOG_ASYNC_POLICY_BLOCK "block"
+#define SRS_CONF_DEFAULT_EVENT_LOG_FILE "./objs/srs.event.log"
+#define SRS_CONF_DEFAULT_EVENT_LOG_FORMAT_BINARY "binary"
 #define SRS_CONF_DEFAULT_COFNIG_FILE "conf/srs.conf"
 #define SRS_CONF_DEFAULT_FF_LOG_DIR "./objs"
 #define SRS_CONF_DEFAULT_UTC_TIME false
@@ -109,8 +115,13 @@ const char* _srs_version = "XCORE-"RTMP_SIG_SRS_SERVER;
 #define SRS_CONF_DEFAULT_HTTP_AUDIO_FAST_CACHE 0
 
 #define SRS_CONF_DEFAULT_HTTP_STREAM_PORT "8080"
+#define SRS_CONF_DEFAULT_HTTP_FILE_CACHE 0
 #define SRS_CONF_DEFAULT_HTTP_API_PORT "1985"
 #define SRS_CONF_DEFAULT_HTTP_API_CROSSDOMAIN true
+// the default interval in seconds to push the stream events.
+#define SRS_CONF_DEFAULT_HTTP_API_EVENTS_INTERVAL 1.0
+// the default max streams of metrics, to limit the cardinality.
+#define SRS_CONF_DEFAULT_HTTP_API_METRICS_MAX_STREAMS 1000
 
 #define SRS_CONF_DEFAULT_HTTP_HEAETBEAT_ENABLED false
 #define SRS_CONF_DEFAULT_HTTP_HEAETBEAT_INTERVAL 9.9
@@ -487,6 +498,13 @@ SrsConfig::SrsConfig()
 SrsConfig::~SrsConfig()
 {
     srs_freep(root);
+    
+    std::map<std::string, SrsCompiledVhost*>::iterator it;
+    for (it = compiled_vhosts.begin(); it != compiled_vhosts.end(); ++it) {
+        SrsCompiledVhost* compiled = it->second;
+        srs_freep(compiled);
+    }
+    compiled_vhosts.clear();
 }
 
 bool SrsConfig::is_dolphin()
@@ -903,6 +921,9 @@ int SrsConfig::reload_conf(SrsConfig* conf)
     root = conf->root;
     conf->root = NULL;
     
+    // compile the new root before notify the subscribers.
+    compile_vhosts();
+    
     // merge config.
     std::vector<ISrsReloadHandler*>::iterator it;
 
@@ -1603,6 +1624,8 @@ int SrsConfig::check_config()
         std::string n = conf->name;
         if (n != "listen" && n != "pid" && n != "chunk_size" && n != "ff_log_dir" 
             && n != "srs_log_tank" && n != "srs_log_level" && n != "srs_log_file"
+            && n != "srs_log_async" && n != "srs_log_async_size" && n != "srs_log_async_policy"
+            && n != "srs_event_log" && n != "srs_event_log_file" && n != "srs_event_log_format"
             && n != "max_connections" && n != "daemon" && n != "heartbeat"
             && n != "http_api" && n != "stats" && n != "vhost" && n != "pithy_print_ms"
             && n != "http_stream" && n != "http_server" && n != "stream_caster"
@@ -1617,7 +1640,9 @@ int SrsConfig::check_config()
         SrsConfDirective* conf = get_http_api();
         for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
             string n = conf->at(i)->name;
-            if (n != "enabled" && n != "listen" && n != "crossdomain") {
+            if (n != "enabled" && n != "listen" && n != "crossdomain" && n != "events_interval"
+                && n != "metrics_max_streams"
+            ) {
                 ret = ERROR_SYSTEM_CONFIG_INVALID;
                 srs_error("unsupported http_api directive %s, ret=%d", n.c_str(), ret);
                 return ret;
@@ -1628,7 +1653,7 @@ int SrsConfig::check_config()
         SrsConfDirective* conf = get_http_stream();
         for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
             string n = conf->at(i)->name;
-            if (n != "enabled" && n != "listen" && n != "dir") {
+            if (n != "enabled" && n != "listen" && n != "dir" && n != "file_cache") {
                 ret = ERROR_SYSTEM_CONFIG_INVALID;
                 srs_error("unsupported http_stream directive %s, ret=%d", n.c_str(), ret);
                 return ret;
@@ -1681,6 +1706,16 @@ int SrsConfig::check_config()
         }
     }
     
+    ////////////////////////////////////////////////////////////////////////
+    // check async log
+    ////////////////////////////////////////////////////////////////////////
+    if (get_log_async_size() <= 0 || get_log_async_size() > SRS_CONF_MAX_LOG_ASYNC_SIZE) {
+        ret = ERROR_SYSTEM_CONFIG_INVALID;
+        srs_error("directive srs_log_async_size invalid, size=%dMB, must in (0, %d], ret=%d", 
+            get_log_async_size(), SRS_CONF_MAX_LOG_ASYNC_SIZE, ret);
+        return ret;
+    }
+    
     ////////////////////////////////////////////////////////////////////////
     // check max connections
     ////////////////////////////////////////////////////////////////////////
@@ -1859,7 +1894,7 @@ int SrsConfig::check_config()
                 && n != "publish_1stpkt_timeout" && n != "publish_normal_timeout"
                 && n != "security" && n != "http_remux"
                 && n != "http" && n != "http_static"
-                && n != "hds"
+                && n != "hds" && n != "fast_start"
             ) {
                 ret = ERROR_SYSTEM_CONFIG_INVALID;
                 srs_error("unsupported vhost directive %s, ret=%d", n.c_str(), ret);
@@ -1877,6 +1912,16 @@ int SrsConfig::check_config()
                         return ret;
                     }
                 }
+            } else if (n == "fast_start") {
+                for (int j = 0; j < (int)conf->directives.size(); j++) {
+                    string m = conf->at(j)->name.c_str();
+                    if (m != "burst" && m != "rate"
+                        ) {
+                        ret = ERROR_SYSTEM_CONFIG_INVALID;
+                        srs_error("unsupported vhost fast_start directive %s, ret=%d", m.c_str(), ret);
+                        return ret;
+                    }
+                }
             } else if (n == "mr") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name.c_str();
@@ -2134,6 +2179,8 @@ int SrsConfig::parse_buffer(SrsConfigBuffer* buffer)
         set_config_directive(root, "daemon", "off");
         set_config_directive(root, "srs_log_tank", "console");
     }
+    
+    compile_vhosts();
 
     return ret;
 }
@@ -2339,10 +2386,21 @@ int SrsConfig::get_stream_caster_rtp_port_max(SrsConfDirective* sc)
     return ::atoi(conf->arg0().c_str());
 }
 
-SrsConfDirective* SrsConfig::get_vhost(string vhost)
+void SrsConfig::compile_vhosts()
 {
     srs_assert(root);
     
+    // free the old compiled vhosts first, then the getters use the
+    // directive tree to compile the new ones.
+    std::map<std::string, SrsCompiledVhost*>::iterator it;
+    for (it = compiled_vhosts.begin(); it != compiled_vhosts.end(); ++it) {
+        SrsCompiledVhost* compiled = it->second;
+        srs_freep(compiled);
+    }
+    compiled_vhosts.clear();
+    
+    // index the vhosts, the first one is used when duplicated.
+    vhost_index.clear();
     for (int i = 0; i < (int)root->directives.size(); i++) {
         SrsConfDirective* conf = root->at(i);
         
@@ -2350,11 +2408,71 @@ SrsConfDirective* SrsConfig::get_vhost(string vhost)
             continue;
         }
         
-        if (conf->arg0() == vhost) {
-            return conf;
+        if (vhost_index.find(conf->arg0()) == vhost_index.end()) {
+            vhost_index[conf->arg0()] = conf;
         }
     }
     
+    std::map<std::string, SrsCompiledVhost*> vhosts;
+    std::map<std::string, SrsConfDirective*>::iterator it_index;
+    for (it_index = vhost_index.begin(); it_index != vhost_index.end(); ++it_index) {
+        std::string vhost = it_index->first;
+        
+        SrsCompiledVhost* compiled = new SrsCompiledVhost();
+        compiled->vhost = vhost;
+        compiled->enabled = get_vhost_enabled(vhost);
+        compiled->is_edge = get_vhost_is_edge(vhost);
+        compiled->gop_cache = get_gop_cache(vhost);
+        compiled->debug_srs_upnode = get_debug_srs_upnode(vhost);
+        compiled->atc = get_atc(vhost);
+        compiled->atc_auto = get_atc_auto(vhost);
+        compiled->time_jitter = get_time_jitter(vhost);
+        compiled->mix_correct = get_mix_correct(vhost);
+        compiled->queue_length = get_queue_length(vhost);
+        compiled->parse_sps = get_parse_sps(vhost);
+        compiled->mr_enabled = get_mr_enabled(vhost);
+        compiled->mr_sleep = get_mr_sleep_ms(vhost);
+        compiled->mw_sleep = get_mw_sleep_ms(vhost);
+        compiled->realtime = get_realtime_enabled(vhost);
+        compiled->tcp_nodelay = get_tcp_nodelay(vhost);
+        compiled->send_min_interval = get_send_min_interval(vhost);
+        compiled->fast_start_burst = get_fast_start_burst(vhost);
+        compiled->fast_start_rate = get_fast_start_rate(vhost);
+        compiled->reduce_sequence_header = get_reduce_sequence_header(vhost);
+        compiled->publish_1stpkt_timeout = get_publish_1stpkt_timeout(vhost);
+        compiled->publish_normal_timeout = get_publish_normal_timeout(vhost);
+        compiled->http_hooks_enabled = get_vhost_http_hooks_enabled(vhost);
+        compiled->security_enabled = get_security_enabled(vhost);
+        vhosts[vhost] = compiled;
+    }
+    
+    // use the compiled vhosts.
+    compiled_vhosts.swap(vhosts);
+}
+
+SrsCompiledVhost* SrsConfig::get_compiled_vhost(const string& vhost)
+{
+    std::map<std::string, SrsCompiledVhost*>::iterator it = compiled_vhosts.find(vhost);
+    if (it != compiled_vhosts.end()) {
+        return it->second;
+    }
+    
+    if (vhost != SRS_CONSTS_RTMP_DEFAULT_VHOST) {
+        return get_compiled_vhost(SRS_CONSTS_RTMP_DEFAULT_VHOST);
+    }
+    
+    return NULL;
+}
+
+SrsConfDirective* SrsConfig::get_vhost(string vhost)
+{
+    srs_assert(root);
+    
+    std::map<std::string, SrsConfDirective*>::iterator it = vhost_index.find(vhost);
+    if (it != vhost_index.end()) {
+        return it->second;
+    }
+    
     if (vhost != SRS_CONSTS_RTMP_DEFAULT_VHOST) {
         return get_vhost(SRS_CONSTS_RTMP_DEFAULT_VHOST);
     }
@@ -2379,6 +2497,11 @@ void SrsConfig::get_vhosts(vector<SrsConfDirective*>& vhosts)
 
 bool SrsConfig::get_vhost_enabled(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->enabled;
+    }
+    
     SrsConfDirective* vhost_conf = get_vhost(vhost);
     
     return get_vhost_enabled(vhost_conf);
@@ -2400,6 +2523,11 @@ bool SrsConfig::get_vhost_enabled(SrsConfDirective* vhost)
 
 bool SrsConfig::get_gop_cache(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->gop_cache;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2416,6 +2544,11 @@ bool SrsConfig::get_gop_cache(string vhost)
 
 bool SrsConfig::get_debug_srs_upnode(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->debug_srs_upnode;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2432,6 +2565,11 @@ bool SrsConfig::get_debug_srs_upnode(string vhost)
 
 bool SrsConfig::get_atc(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->atc;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2448,6 +2586,11 @@ bool SrsConfig::get_atc(string vhost)
 
 bool SrsConfig::get_atc_auto(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->atc_auto;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2464,6 +2607,11 @@ bool SrsConfig::get_atc_auto(string vhost)
 
 int SrsConfig::get_time_jitter(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->time_jitter;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
     
     std::string time_jitter = SRS_CONF_DEFAULT_TIME_JITTER;
@@ -2481,6 +2629,11 @@ int SrsConfig::get_time_jitter(string vhost)
 
 bool SrsConfig::get_mix_correct(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->mix_correct;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
     
     if (!conf) {
@@ -2497,6 +2650,11 @@ bool SrsConfig::get_mix_correct(string vhost)
 
 double SrsConfig::get_queue_length(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->queue_length;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2570,6 +2728,11 @@ int SrsConfig::get_chunk_size(string vhost)
 
 bool SrsConfig::get_parse_sps(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->parse_sps;
+    }
+    
     static bool DEFAULT = true;
     
     SrsConfDirective* conf = get_vhost(vhost);
@@ -2593,6 +2756,11 @@ bool SrsConfig::get_parse_sps(string vhost)
 
 bool SrsConfig::get_mr_enabled(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->mr_enabled;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2614,6 +2782,11 @@ bool SrsConfig::get_mr_enabled(string vhost)
 
 int SrsConfig::get_mr_sleep_ms(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->mr_sleep;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2635,6 +2808,11 @@ int SrsConfig::get_mr_sleep_ms(string vhost)
 
 int SrsConfig::get_mw_sleep_ms(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->mw_sleep;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2651,6 +2829,11 @@ int SrsConfig::get_mw_sleep_ms(string vhost)
 
 bool SrsConfig::get_realtime_enabled(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->realtime;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
 
     if (!conf) {
@@ -2667,6 +2850,11 @@ bool SrsConfig::get_realtime_enabled(string vhost)
 
 bool SrsConfig::get_tcp_nodelay(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->tcp_nodelay;
+    }
+    
     static bool DEFAULT = false;
     
     SrsConfDirective* conf = get_vhost(vhost);
@@ -2684,6 +2872,11 @@ bool SrsConfig::get_tcp_nodelay(string vhost)
 
 double SrsConfig::get_send_min_interval(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->send_min_interval;
+    }
+    
     static double DEFAULT = 0.0;
     
     SrsConfDirective* conf = get_vhost(vhost);
@@ -2699,8 +2892,67 @@ double SrsConfig::get_send_min_interval(string vhost)
     return ::atof(conf->arg0().c_str());
 }
 
+double SrsConfig::get_fast_start_burst(string vhost)
+{
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->fast_start_burst;
+    }
+    
+    static double DEFAULT = 0.0;
+    
+    SrsConfDirective* conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("fast_start");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("burst");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
+double SrsConfig::get_fast_start_rate(string vhost)
+{
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->fast_start_rate;
+    }
+    
+    static double DEFAULT = 2.0;
+    
+    SrsConfDirective* conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("fast_start");
+    if (!conf) {
+        return DEFAULT;
+    }
+    
+    conf = conf->get("rate");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_reduce_sequence_header(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->reduce_sequence_header;
+    }
+    
     static bool DEFAULT = false;
     
     SrsConfDirective* conf = get_vhost(vhost);
@@ -2718,6 +2970,11 @@ bool SrsConfig::get_reduce_sequence_header(string vhost)
 
 int SrsConfig::get_publish_1stpkt_timeout(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->publish_1stpkt_timeout;
+    }
+    
     // when no msg recevied for publisher, use larger timeout.
     static int DEFAULT = 20000;
     
@@ -2736,6 +2993,11 @@ int SrsConfig::get_publish_1stpkt_timeout(string vhost)
 
 int SrsConfig::get_publish_normal_timeout(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->publish_normal_timeout;
+    }
+    
     // the timeout for publish recv.
     // we must use more smaller timeout, for the recv never know the status
     // of underlayer socket.
@@ -2788,6 +3050,11 @@ SrsConfDirective* SrsConfig::get_vhost_http_hooks(string vhost)
 
 bool SrsConfig::get_vhost_http_hooks_enabled(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->http_hooks_enabled;
+    }
+    
     SrsConfDirective* conf = get_vhost_http_hooks(vhost);
 
     if (!conf) { 
@@ -2987,6 +3254,11 @@ int SrsConfig::get_bw_check_limit_kbps(string vhost)
 
 bool SrsConfig::get_vhost_is_edge(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->is_edge;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
     return get_vhost_is_edge(conf);
 }
@@ -3053,6 +3325,11 @@ string SrsConfig::get_vhost_edge_transform_vhost(string vhost)
 
 bool SrsConfig::get_security_enabled(string vhost)
 {
+    SrsCompiledVhost* compiled = get_compiled_vhost(vhost);
+    if (compiled) {
+        return compiled->security_enabled;
+    }
+    
     SrsConfDirective* conf = get_vhost(vhost);
     
     if (!conf) {
@@ -3616,6 +3893,78 @@ string SrsConfig::get_log_file()
     return conf->arg0();
 }
 
+bool SrsConfig::get_log_async()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_log_async");
+    if (!conf || conf->arg0().empty()) {
+        return false;
+    }
+    
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
+int SrsConfig::get_log_async_size()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_log_async_size");
+    if (!conf || conf->arg0().empty()) {
+        return SRS_CONF_DEFAULT_LOG_ASYNC_SIZE;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
+bool SrsConfig::get_log_async_block()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_log_async_policy");
+    if (!conf || conf->arg0().empty()) {
+        return false;
+    }
+    
+    return conf->arg0() == SRS_CONF_DEFAULT_LOG_ASYNC_POLICY_BLOCK;
+}
+
+bool SrsConfig::get_event_log_enabled()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_event_log");
+    if (!conf || conf->arg0().empty()) {
+        return false;
+    }
+    
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
+string SrsConfig::get_event_log_file()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_event_log_file");
+    if (!conf || conf->arg0().empty()) {
+        return SRS_CONF_DEFAULT_EVENT_LOG_FILE;
+    }
+    
+    return conf->arg0();
+}
+
+bool SrsConfig::get_event_log_binary()
+{
+    srs_assert(root);
+    
+    SrsConfDirective* conf = root->get("srs_event_log_format");
+    if (!conf || conf->arg0().empty()) {
+        return false;
+    }
+    
+    return conf->arg0() == SRS_CONF_DEFAULT_EVENT_LOG_FORMAT_BINARY;
+}
+
 bool SrsConfig::get_ffmpeg_log_enabled()
 {
     string log = get_ffmpeg_log_dir();
@@ -4183,6 +4532,38 @@ bool SrsConfig::get_http_api_crossdomain()
     return SRS_CONF_PERFER_TRUE(conf->arg0());
 }
 
+double SrsConfig::get_http_api_events_interval()
+{
+    SrsConfDirective* conf = get_http_api();
+    
+    if (!conf) {
+        return SRS_CONF_DEFAULT_HTTP_API_EVENTS_INTERVAL;
+    }
+    
+    conf = conf->get("events_interval");
+    if (!conf || conf->arg0().empty()) {
+        return SRS_CONF_DEFAULT_HTTP_API_EVENTS_INTERVAL;
+    }
+    
+    return ::atof(conf->arg0().c_str());
+}
+
+int SrsConfig::get_http_api_metrics_max_streams()
+{
+    SrsConfDirective* conf = get_http_api();
+    
+    if (!conf) {
+        return SRS_CONF_DEFAULT_HTTP_API_METRICS_MAX_STREAMS;
+    }
+    
+    conf = conf->get("metrics_max_streams");
+    if (!conf || conf->arg0().empty()) {
+        return SRS_CONF_DEFAULT_HTTP_API_METRICS_MAX_STREAMS;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_http_stream_enabled()
 {
     SrsConfDirective* conf = get_http_stream();
@@ -4249,6 +4630,21 @@ string SrsConfig::get_http_stream_dir()
     return conf->arg0();
 }
 
+int SrsConfig::get_http_stream_file_cache()
+{
+    SrsConfDirective* conf = get_http_stream();
+    if (!conf) {
+        return SRS_CONF_DEFAULT_HTTP_FILE_CACHE;
+    }
+    
+    conf = conf->get("file_cache");
+    if (!conf || conf->arg0().empty()) {
+        return SRS_CONF_DEFAULT_HTTP_FILE_CACHE;
+    }
+    
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_vhost_http_enabled(string vhost)
 {
     SrsConfDirective* vconf = get_vhost(vhost);
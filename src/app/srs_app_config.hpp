@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <vector>
 #include <string>
+#include <map>
 
 #include <srs_app_reload.hpp>
 
@@ -169,6 +170,40 @@ private:
     virtual int read_token(_srs_internal::SrsConfigBuffer* buffer, std::vector<std::string>& args, int& line_start);
 };
 
+/**
+* the compiled config of vhost, the typed values of the directives which
+* are used per connection or per message, to avoid the lookup of directive
+* tree. it's immutable, and rebuilt when config parsed or reloaded.
+*/
+struct SrsCompiledVhost
+{
+public:
+    std::string vhost;
+    bool enabled;
+    bool is_edge;
+    bool gop_cache;
+    bool debug_srs_upnode;
+    bool atc;
+    bool atc_auto;
+    int time_jitter;
+    bool mix_correct;
+    double queue_length;
+    bool parse_sps;
+    bool mr_enabled;
+    int mr_sleep;
+    int mw_sleep;
+    bool realtime;
+    bool tcp_nodelay;
+    double send_min_interval;
+    double fast_start_burst;
+    double fast_start_rate;
+    bool reduce_sequence_header;
+    int publish_1stpkt_timeout;
+    int publish_normal_timeout;
+    bool http_hooks_enabled;
+    bool security_enabled;
+};
+
 /**
 * the config service provider.
 * for the config supports reload, so never keep the reference cross st-thread,
@@ -221,6 +256,14 @@ private:
     * the directive root.
     */
     SrsConfDirective* root;
+    /**
+    * the index of vhost directives, key is the vhost name.
+    */
+    std::map<std::string, SrsConfDirective*> vhost_index;
+    /**
+    * the compiled vhosts, key is the vhost name.
+    */
+    std::map<std::string, SrsCompiledVhost*> compiled_vhosts;
 // reload section
 private:
     /**
@@ -418,6 +461,17 @@ public:
     */
     virtual int                 get_stream_caster_rtp_port_max(SrsConfDirective* sc);
 // vhost specified section
+private:
+    /**
+    * compile the vhosts, build the index of vhosts and the compiled vhosts.
+    * @remark must compile when root changed, that is, parsed or reloaded.
+    */
+    virtual void compile_vhosts();
+    /**
+    * get the compiled vhost, the default vhost if not found.
+    * @return NULL if not compiled, use the directive tree.
+    */
+    virtual SrsCompiledVhost*   get_compiled_vhost(const std::string& vhost);
 public:
     /**
     * get the vhost directive by vhost name.
@@ -547,6 +601,14 @@ public:
      * the minimal send interval in ms.
      */
     virtual double              get_send_min_interval(std::string vhost);
+    /**
+     * the fast start burst in seconds, 0 to disable.
+     */
+    virtual double              get_fast_start_burst(std::string vhost);
+    /**
+     * the fast start rate, the multiple of stream bitrate.
+     */
+    virtual double              get_fast_start_rate(std::string vhost);
     /**
      * whether reduce the sequence header.
      */
@@ -851,6 +913,33 @@ public:
     */
     virtual std::string         get_log_file();
     /**
+    * whether write the log file in async thread.
+    * @remark the async log requires restart to apply.
+    */
+    virtual bool                get_log_async();
+    /**
+    * get the ring buffer size in MB of async log.
+    */
+    virtual int                 get_log_async_size();
+    /**
+    * whether block the server when async log ring is full,
+    * false to drop the log.
+    */
+    virtual bool                get_log_async_block();
+    /**
+    * whether enable the structured event log of connections.
+    * @remark the event log requires restart to apply.
+    */
+    virtual bool                get_event_log_enabled();
+    /**
+    * get the event log file path.
+    */
+    virtual std::string         get_event_log_file();
+    /**
+    * whether write event log in length-prefixed binary, false for json lines.
+    */
+    virtual bool                get_event_log_binary();
+    /**
     * whether ffmpeg log enabled
     */
     virtual bool                get_ffmpeg_log_enabled();
@@ -1019,6 +1108,14 @@ public:
     * whether enable crossdomain for http api.
     */
     virtual bool                get_http_api_crossdomain();
+    /**
+    * get the interval in seconds to push the stream events.
+    */
+    virtual double              get_http_api_events_interval();
+    /**
+    * get the max streams of prometheus metrics, to limit the cardinality.
+    */
+    virtual int                 get_http_api_metrics_max_streams();
 // http stream section
 private:
     /**
@@ -1042,6 +1139,11 @@ public:
     * get the http stream root dir.
     */
     virtual std::string         get_http_stream_dir();
+    /**
+    * get the memory budget in MB of hot file cache for static files,
+    * for instance, the hls m3u8 and ts. 0 to disable the cache.
+    */
+    virtual int                 get_http_stream_file_cache();
 public:
     /**
     * get whether vhost enabled http stream
@@ -0,0 +1,213 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_event_log.hpp>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sstream>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_kernel_stream.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_protocol_kbps.hpp>
+#include <srs_rtmp_stack.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_log.hpp>
+
+// the max size of a binary event.
+#define SRS_EVENT_LOG_MAX_SIZE 4096
+
+// escape the string in json, for the stream name is specified by client.
+static string srs_event_json_escape(const string& str)
+{
+    std::stringstream ss;
+    
+    for (int i = 0; i < (int)str.length(); i++) {
+        char ch = str.at(i);
+        if (ch == '"' || ch == '\\') {
+            ss << '\\' << ch;
+        } else if ((unsigned char)ch < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (int)ch);
+            ss << buf;
+        } else {
+            ss << ch;
+        }
+    }
+    
+    return ss.str();
+}
+
+SrsEventLog* SrsEventLog::_instance = new SrsEventLog();
+
+SrsEventLog::SrsEventLog()
+{
+    enabled = false;
+    binary = false;
+    writer = NULL;
+}
+
+SrsEventLog::~SrsEventLog()
+{
+    close();
+}
+
+SrsEventLog* SrsEventLog::instance()
+{
+    return _instance;
+}
+
+int SrsEventLog::initialize()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!_srs_config->get_event_log_enabled()) {
+        return ret;
+    }
+    binary = _srs_config->get_event_log_binary();
+    
+    std::string filename = _srs_config->get_event_log_file();
+    int fd = ::open(filename.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+    if (fd == -1) {
+        ret = ERROR_SYSTEM_FILE_OPENE;
+        srs_error("open event log %s failed. ret=%d", filename.c_str(), ret);
+        return ret;
+    }
+    
+    // use the same ring size and policy with the async log.
+    int64_t ring_size = (int64_t)_srs_config->get_log_async_size() * 1024 * 1024;
+    writer = new SrsAsyncLogWriter();
+    if ((ret = writer->start(ring_size, _srs_config->get_log_async_block())) != ERROR_SUCCESS) {
+        ::close(fd);
+        srs_freep(writer);
+        srs_error("start event log writer failed. ret=%d", ret);
+        return ret;
+    }
+    writer->reopen(fd);
+    
+    enabled = true;
+    srs_trace("event log to %s, binary=%d", filename.c_str(), binary);
+    
+    return ret;
+}
+
+void SrsEventLog::close()
+{
+    enabled = false;
+    srs_freep(writer);
+}
+
+void SrsEventLog::on_event(SrsLogEvent event, int cid, SrsRequest* req, SrsKbps* kbps, int64_t duration, int code)
+{
+    if (!enabled) {
+        return;
+    }
+    
+    int64_t now = srs_get_system_time_ms();
+    int64_t send_bytes = kbps? kbps->get_send_bytes() : 0;
+    int64_t recv_bytes = kbps? kbps->get_recv_bytes() : 0;
+    
+    std::string ip, vhost, app, stream;
+    if (req) {
+        ip = req->ip;
+        vhost = req->vhost;
+        app = req->app;
+        stream = req->stream;
+    }
+    
+    if (!binary) {
+        std::stringstream ss;
+        ss << SRS_JOBJECT_START
+                << SRS_JFIELD_ORG("time", now) << SRS_JFIELD_CONT
+                << SRS_JFIELD_STR("event", event2str(event)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("cid", cid) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ERROR(code) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("duration", duration) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("send_bytes", send_bytes) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("recv_bytes", recv_bytes) << SRS_JFIELD_CONT
+                << SRS_JFIELD_STR("ip", srs_event_json_escape(ip)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_STR("vhost", srs_event_json_escape(vhost)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_STR("app", srs_event_json_escape(app)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_STR("stream", srs_event_json_escape(stream))
+            << SRS_JOBJECT_END << "\n";
+        
+        std::string line = ss.str();
+        writer->write(line.data(), (int)line.length());
+        return;
+    }
+    
+    // the fixed fields and the strings.
+    int size = 4 + 1 + 8 + 4 + 4 + 8 + 8 + 8;
+    size += 2 + (int)ip.length() + 2 + (int)vhost.length() + 2 + (int)app.length() + 2 + (int)stream.length();
+    if (size > SRS_EVENT_LOG_MAX_SIZE) {
+        srs_warn("ignore event %s for size %d exceed max %d", event2str(event).c_str(), size, SRS_EVENT_LOG_MAX_SIZE);
+        return;
+    }
+    
+    char buf[SRS_EVENT_LOG_MAX_SIZE];
+    SrsStream s;
+    if (s.initialize(buf, size) != ERROR_SUCCESS) {
+        return;
+    }
+    
+    s.write_4bytes(size - 4);
+    s.write_1bytes((int8_t)event);
+    s.write_8bytes(now);
+    s.write_4bytes(cid);
+    s.write_4bytes(code);
+    s.write_8bytes(duration);
+    s.write_8bytes(send_bytes);
+    s.write_8bytes(recv_bytes);
+    
+    s.write_2bytes((int16_t)ip.length());
+    s.write_string(ip);
+    s.write_2bytes((int16_t)vhost.length());
+    s.write_string(vhost);
+    s.write_2bytes((int16_t)app.length());
+    s.write_string(app);
+    s.write_2bytes((int16_t)stream.length());
+    s.write_string(stream);
+    
+    writer->write(buf, size);
+}
+
+std::string SrsEventLog::event2str(SrsLogEvent event)
+{
+    switch (event) {
+        case SrsLogEventConnect: return "connect";
+        case SrsLogEventClose: return "close";
+        case SrsLogEventPublish: return "publish";
+        case SrsLogEventUnpublish: return "unpublish";
+        case SrsLogEventPlay: return "play";
+        case SrsLogEventStop: return "stop";
+        default: return "unknown";
+    }
+}
+
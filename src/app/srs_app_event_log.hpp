@@ -0,0 +1,103 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_EVENT_LOG_HPP
+#define SRS_APP_EVENT_LOG_HPP
+
+/*
+#include <srs_app_event_log.hpp>
+*/
+
+#include <srs_core.hpp>
+
+#include <string>
+
+class SrsRequest;
+class SrsKbps;
+class SrsAsyncLogWriter;
+
+/**
+ * the lifecycle event of connection.
+ */
+enum SrsLogEvent
+{
+    SrsLogEventConnect = 1,
+    SrsLogEventClose = 2,
+    SrsLogEventPublish = 3,
+    SrsLogEventUnpublish = 4,
+    SrsLogEventPlay = 5,
+    SrsLogEventStop = 6
+};
+
+/**
+ * the structured event log of connections, for analytics without parsing
+ * the text log. each event is a line of json, or a length-prefixed binary
+ * record, written to the event log file by the async log writer.
+ * the binary record is, all integers in big-endian:
+ *      4B length, of the following bytes.
+ *      1B event, the SrsLogEvent.
+ *      8B time, the unix time in ms.
+ *      4B cid, the context id of connection.
+ *      4B code, the error code, 0 for success.
+ *      8B duration, in ms, of connection or publish or play.
+ *      8B send bytes, 8B recv bytes.
+ *      then the strings of ip, vhost, app, stream, each is 2B length with bytes.
+ */
+class SrsEventLog
+{
+private:
+    static SrsEventLog* _instance;
+private:
+    bool enabled;
+    bool binary;
+    SrsAsyncLogWriter* writer;
+private:
+    SrsEventLog();
+    virtual ~SrsEventLog();
+public:
+    static SrsEventLog* instance();
+public:
+    /**
+     * open the event log file and start the async writer when configured,
+     * @remark must start after daemon forked, for the os thread is not forked.
+     */
+    virtual int initialize();
+    /**
+     * drain the events to file and stop the writer.
+     */
+    virtual void close();
+    /**
+     * write a event of connection.
+     * @param cid the context id of connection.
+     * @param req the request of connection, NULL to ignore.
+     * @param kbps the bytes of connection, NULL to ignore.
+     * @param duration the duration in ms of connection or publish or play.
+     * @param code the error code, for example, the connection closed for.
+     */
+    virtual void on_event(SrsLogEvent event, int cid, SrsRequest* req, SrsKbps* kbps, int64_t duration, int code);
+private:
+    virtual std::string event2str(SrsLogEvent event);
+};
+
+#endif
+
@@ -25,7 +25,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #ifdef SRS_AUTO_HTTP_CORE
 
-#include <sstream>
 using namespace std;
 
 #include <srs_kernel_error.hpp>
@@ -65,17 +64,17 @@ void SrsHttpHeartbeat::heartbeat()
         ip = ips[_srs_config->get_stats_network() % (int)ips.size()];
     }
     
-    std::stringstream ss;
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_STR("device_id", device_id) << SRS_JFIELD_CONT
-        << SRS_JFIELD_STR("ip", ip);
+    SrsJsonWriter json;
+    json.object_start();
+    json.field_str("device_id", device_id);
+    json.field_str("ip", ip);
     if (_srs_config->get_heartbeat_summaries()) {
-        ss << SRS_JFIELD_CONT << SRS_JFIELD_ORG("summaries", "");
-        srs_api_dump_summaries(ss);
+        json.name("summaries");
+        srs_api_dump_summaries(&json);
     }
-    ss << SRS_JOBJECT_END;
+    json.object_end();
     
-    std::string req = ss.str();
+    std::string req = json.str();
     
     SrsHttpClient http;
     if ((ret = http.initialize(uri.get_host(), uri.get_port())) != ERROR_SUCCESS) {
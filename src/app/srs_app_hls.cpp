@@ -50,6 +50,7 @@ using namespace std;
 #include <srs_kernel_ts.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_app_http_hooks.hpp>
+#include <srs_kernel_perf.hpp>
 
 // drop the segment when duration of ts too small.
 #define SRS_AUTO_HLS_SEGMENT_MIN_DURATION_MS 100
@@ -132,22 +133,26 @@ string SrsHlsCacheWriter::cache()
     return data;
 }
 
-SrsHlsSegment::SrsHlsSegment(SrsTsContext* c, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc)
+SrsHlsSegment::SrsHlsSegment(bool write_cache, bool write_file)
 {
     duration = 0;
     sequence_no = 0;
     segment_start_dts = 0;
     is_sequence_header = false;
+    has_psi = false;
     writer = new SrsHlsCacheWriter(write_cache, write_file);
-    muxer = new SrsTSMuxer(writer, c, ac, vc);
 }
 
 SrsHlsSegment::~SrsHlsSegment()
 {
-    srs_freep(muxer);
     srs_freep(writer);
 }
 
+int SrsHlsSegment::write(SrsSharedPtrMessage* block)
+{
+    return writer->write(block->payload, block->size, NULL);
+}
+
 void SrsHlsSegment::update_duration(int64_t current_frame_dts)
 {
     // we use video/audio to update segment duration,
@@ -297,11 +302,10 @@ SrsHlsMuxer::SrsHlsMuxer()
     max_td = 0;
     _sequence_no = 0;
     current = NULL;
-    acodec = SrsCodecAudioReserved1;
+    psi = NULL;
     should_write_cache = false;
     should_write_file = true;
     async = new SrsAsyncCallWorker();
-    context = new SrsTsContext();
 }
 
 SrsHlsMuxer::~SrsHlsMuxer()
@@ -316,7 +320,7 @@ SrsHlsMuxer::~SrsHlsMuxer()
     srs_freep(current);
     srs_freep(req);
     srs_freep(async);
-    srs_freep(context);
+    srs_freep(psi);
 }
 
 void SrsHlsMuxer::dispose()
@@ -442,41 +446,8 @@ int SrsHlsMuxer::segment_open(int64_t segment_start_dts)
     // when segment open, the current segment must be NULL.
     srs_assert(!current);
 
-    // load the default acodec from config.
-    SrsCodecAudio default_acodec = SrsCodecAudioAAC;
-    if (true) {
-        std::string default_acodec_str = _srs_config->get_hls_acodec(req->vhost);
-        if (default_acodec_str == "mp3") {
-            default_acodec = SrsCodecAudioMP3;
-            srs_info("hls: use default mp3 acodec");
-        } else if (default_acodec_str == "aac") {
-            default_acodec = SrsCodecAudioAAC;
-            srs_info("hls: use default aac acodec");
-        } else if (default_acodec_str == "an") {
-            default_acodec = SrsCodecAudioDisabled;
-            srs_info("hls: use default an acodec for pure video");
-        } else {
-            srs_warn("hls: use aac for other codec=%s", default_acodec_str.c_str());
-        }
-    }
-
-    // load the default vcodec from config.
-    SrsCodecVideo default_vcodec = SrsCodecVideoAVC;
-    if (true) {
-        std::string default_vcodec_str = _srs_config->get_hls_vcodec(req->vhost);
-        if (default_vcodec_str == "h264") {
-            default_vcodec = SrsCodecVideoAVC;
-            srs_info("hls: use default h264 vcodec");
-        } else if (default_vcodec_str == "vn") {
-            default_vcodec = SrsCodecVideoDisabled;
-            srs_info("hls: use default vn vcodec for pure audio");
-        } else {
-            srs_warn("hls: use h264 for other codec=%s", default_vcodec_str.c_str());
-        }
-    }
-    
     // new segment.
-    current = new SrsHlsSegment(context, should_write_cache, should_write_file, default_acodec, default_vcodec);
+    current = new SrsHlsSegment(should_write_cache, should_write_file);
     current->sequence_no = _sequence_no++;
     current->segment_start_dts = segment_start_dts;
     
@@ -556,18 +527,12 @@ int SrsHlsMuxer::segment_open(int64_t segment_start_dts)
     
     // open temp ts file.
     std::string tmp_file = current->full_path + ".tmp";
-    if ((ret = current->muxer->open(tmp_file.c_str())) != ERROR_SUCCESS) {
+    if ((ret = current->writer->open(tmp_file.c_str())) != ERROR_SUCCESS) {
         srs_error("open hls muxer failed. ret=%d", ret);
         return ret;
     }
     srs_info("open HLS muxer success. path=%s, tmp=%s",
         current->full_path.c_str(), tmp_file.c_str());
-
-    // set the segment muxer audio codec.
-    // TODO: FIXME: refine code, use event instead.
-    if (acodec != SrsCodecAudioReserved1) {
-        current->muxer->update_acodec(acodec);
-    }
     
     return ret;
 }
@@ -625,20 +590,25 @@ bool SrsHlsMuxer::is_segment_absolutely_overflow()
     return current->duration >= hls_aof_ratio * hls_fragment + deviation;
 }
 
-int SrsHlsMuxer::update_acodec(SrsCodecAudio ac)
+int SrsHlsMuxer::update_psi(SrsSharedPtrMessage* block)
 {
-    srs_assert(current);
-    srs_assert(current->muxer);
-    acodec = ac;
-    return current->muxer->update_acodec(ac);
-}
-
-bool SrsHlsMuxer::pure_audio()
-{
-    return current && current->muxer && current->muxer->video_codec() == SrsCodecVideoDisabled;
+    int ret = ERROR_SUCCESS;
+    
+    srs_freep(psi);
+    psi = block->copy();
+    
+    // when codec changed in segment, write the new PAT/PMT,
+    // or the PAT/PMT is written before the first frame of segment.
+    if (current && current->has_psi) {
+        if ((ret = current->write(psi)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return ret;
 }
 
-int SrsHlsMuxer::flush_audio(SrsTsCache* cache)
+int SrsHlsMuxer::write_audio(SrsSharedPtrMessage* block, int64_t pts)
 {
     int ret = ERROR_SUCCESS;
 
@@ -648,24 +618,13 @@ int SrsHlsMuxer::flush_audio(SrsTsCache* cache)
         return ret;
     }
     
-    if (!cache->audio || cache->audio->payload->length() <= 0) {
-        return ret;
-    }
-    
     // update the duration of segment.
-    current->update_duration(cache->audio->pts);
+    current->update_duration(pts);
     
-    if ((ret = current->muxer->write_audio(cache->audio)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    
-    // write success, clear and free the msg
-    srs_freep(cache->audio);
-
-    return ret;
+    return write_block(block);
 }
 
-int SrsHlsMuxer::flush_video(SrsTsCache* cache)
+int SrsHlsMuxer::write_video(SrsSharedPtrMessage* block, int64_t dts)
 {
     int ret = ERROR_SUCCESS;
 
@@ -675,23 +634,10 @@ int SrsHlsMuxer::flush_video(SrsTsCache* cache)
         return ret;
     }
     
-    if (!cache->video || cache->video->payload->length() <= 0) {
-        return ret;
-    }
-    
-    srs_assert(current);
-    
     // update the duration of segment.
-    current->update_duration(cache->video->dts);
-    
-    if ((ret = current->muxer->write_video(cache->video)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    
-    // write success, clear and free the msg
-    srs_freep(cache->video);
+    current->update_duration(dts);
     
-    return ret;
+    return write_block(block);
 }
 
 int SrsHlsMuxer::segment_close(string log_desc)
@@ -705,6 +651,9 @@ int SrsHlsMuxer::segment_close(string log_desc)
     
     // when close current segment, the current segment must not be NULL.
     srs_assert(current);
+    
+    // measure the segment close, flush, rename and refresh m3u8.
+    SrsPerfAuto(SrsPerfStageHlsSegment);
 
     // assert segment duplicate.
     std::vector<SrsHlsSegment*>::iterator it;
@@ -737,7 +686,7 @@ int SrsHlsMuxer::segment_close(string log_desc)
             current->segment_start_dts);
     
         // close the muxer of finished segment.
-        srs_freep(current->muxer);
+        current->writer->close();
         std::string full_path = current->full_path;
         current = NULL;
         
@@ -815,6 +764,23 @@ int SrsHlsMuxer::segment_close(string log_desc)
     return ret;
 }
 
+int SrsHlsMuxer::write_block(SrsSharedPtrMessage* block)
+{
+    int ret = ERROR_SUCCESS;
+    
+    srs_assert(current);
+    
+    // each segment must start with PAT/PMT.
+    if (!current->has_psi && psi) {
+        if ((ret = current->write(psi)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        current->has_psi = true;
+    }
+    
+    return current->write(block);
+}
+
 int SrsHlsMuxer::refresh_m3u8()
 {
     int ret = ERROR_SUCCESS;
@@ -929,12 +895,10 @@ int SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
 
 SrsHlsCache::SrsHlsCache()
 {
-    cache = new SrsTsCache();
 }
 
 SrsHlsCache::~SrsHlsCache()
 {
-    srs_freep(cache);
 }
 
 int SrsHlsCache::on_publish(SrsHlsMuxer* muxer, SrsRequest* req, int64_t segment_start_dts)
@@ -990,11 +954,7 @@ int SrsHlsCache::on_unpublish(SrsHlsMuxer* muxer)
 {
     int ret = ERROR_SUCCESS;
     
-    if ((ret = muxer->flush_audio(cache)) != ERROR_SUCCESS) {
-        srs_error("m3u8 muxer flush audio failed. ret=%d", ret);
-        return ret;
-    }
-    
+    // the cached audio is flushed by the remuxer before unpublish.
     if ((ret = muxer->segment_close("unpublish")) != ERROR_SUCCESS) {
         return ret;
     }
@@ -1013,15 +973,10 @@ int SrsHlsCache::on_sequence_header(SrsHlsMuxer* muxer)
     return muxer->on_sequence_header();
 }
 
-int SrsHlsCache::write_audio(SrsAvcAacCodec* codec, SrsHlsMuxer* muxer, int64_t pts, SrsCodecSample* sample)
+int SrsHlsCache::write_audio(SrsHlsMuxer* muxer, SrsSharedPtrMessage* block, int64_t pts)
 {
     int ret = ERROR_SUCCESS;
     
-    // write audio to cache.
-    if ((ret = cache->cache_audio(codec, pts, sample)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    
     // reap when current source is pure audio.
     // it maybe changed when stream info changed,
     // for example, pure audio when start, audio/video when publishing,
@@ -1030,55 +985,40 @@ int SrsHlsCache::write_audio(SrsAvcAacCodec* codec, SrsHlsMuxer* muxer, int64_t
     // @see https://github.com/ossrs/srs/issues/151
     // we use absolutely overflow of segment to make jwplayer/ffplay happy
     // @see https://github.com/ossrs/srs/issues/151#issuecomment-71155184
-    if (cache->audio && muxer->is_segment_absolutely_overflow()) {
+    if (muxer->is_segment_absolutely_overflow()) {
         srs_info("hls: absolute audio reap segment.");
-        if ((ret = reap_segment("audio", muxer, cache->audio->pts)) != ERROR_SUCCESS) {
-            return ret;
-        }
-    }
-    
-    // for pure audio, aggregate some frame to one.
-    if (muxer->pure_audio() && cache->audio) {
-        if (pts - cache->audio->start_pts < SRS_CONSTS_HLS_PURE_AUDIO_AGGREGATE) {
+        if ((ret = reap_segment("audio", muxer, pts)) != ERROR_SUCCESS) {
             return ret;
         }
     }
     
-    // directly write the audio frame by frame to ts,
-    // it's ok for the hls overload, or maybe cause the audio corrupt,
-    // which introduced by aggregate the audios to a big one.
+    // the pure audio is aggregated by the remuxer,
     // @see https://github.com/ossrs/srs/issues/512
-    if ((ret = muxer->flush_audio(cache)) != ERROR_SUCCESS) {
+    if ((ret = muxer->write_audio(block, pts)) != ERROR_SUCCESS) {
         return ret;
     }
     
     return ret;
 }
     
-int SrsHlsCache::write_video(SrsAvcAacCodec* codec, SrsHlsMuxer* muxer, int64_t dts, SrsCodecSample* sample)
+int SrsHlsCache::write_video(SrsHlsMuxer* muxer, SrsSharedPtrMessage* block, int64_t dts, bool keyframe)
 {
     int ret = ERROR_SUCCESS;
     
-    // write video to cache.
-    if ((ret = cache->cache_video(codec, dts, sample)) != ERROR_SUCCESS) {
-        return ret;
-    }
-    
     // when segment overflow, reap if possible.
     if (muxer->is_segment_overflow()) {
         // do reap ts if any of:
         //      a. wait keyframe and got keyframe.
         //      b. always reap when not wait keyframe.
-        if (!muxer->wait_keyframe() || sample->frame_type == SrsCodecVideoAVCFrameKeyFrame) {
-            // reap the segment, which will also flush the video.
-            if ((ret = reap_segment("video", muxer, cache->video->dts)) != ERROR_SUCCESS) {
+        if (!muxer->wait_keyframe() || keyframe) {
+            if ((ret = reap_segment("video", muxer, dts)) != ERROR_SUCCESS) {
                 return ret;
             }
         }
     }
     
     // flush video when got one
-    if ((ret = muxer->flush_video(cache)) != ERROR_SUCCESS) {
+    if ((ret = muxer->write_video(block, dts)) != ERROR_SUCCESS) {
         srs_error("m3u8 muxer flush video failed. ret=%d", ret);
         return ret;
     }
@@ -1099,26 +1039,12 @@ int SrsHlsCache::reap_segment(string log_desc, SrsHlsMuxer* muxer, int64_t segme
         return ret;
     }
     
-    // open new ts.
+    // open new ts, the caller write the block to it.
     if ((ret = muxer->segment_open(segment_start_dts)) != ERROR_SUCCESS) {
         srs_error("m3u8 muxer open segment failed. ret=%d", ret);
         return ret;
     }
     
-    // segment open, flush video first.
-    if ((ret = muxer->flush_video(cache)) != ERROR_SUCCESS) {
-        srs_error("m3u8 muxer flush video failed. ret=%d", ret);
-        return ret;
-    }
-    
-    // segment open, flush the audio.
-    // @see: ngx_rtmp_hls_open_fragment
-    /* start fragment with audio to make iPhone happy */
-    if ((ret = muxer->flush_audio(cache)) != ERROR_SUCCESS) {
-        srs_error("m3u8 muxer flush audio failed. ret=%d", ret);
-        return ret;
-    }
-    
     return ret;
 }
 
@@ -1130,10 +1056,6 @@ SrsHls::SrsHls()
     hls_enabled = false;
     hls_can_dispose = false;
     last_update_time = 0;
-
-    codec = new SrsAvcAacCodec();
-    sample = new SrsCodecSample();
-    jitter = new SrsRtmpJitter();
     
     muxer = new SrsHlsMuxer();
     hls_cache = new SrsHlsCache();
@@ -1145,9 +1067,6 @@ SrsHls::SrsHls()
 SrsHls::~SrsHls()
 {
     srs_freep(_req);
-    srs_freep(codec);
-    srs_freep(sample);
-    srs_freep(jitter);
     
     srs_freep(muxer);
     srs_freep(hls_cache);
@@ -1296,7 +1215,12 @@ int SrsHls::on_meta_data(SrsAmf0Object* metadata)
     return ret;
 }
 
-int SrsHls::on_audio(SrsSharedPtrMessage* shared_audio)
+bool SrsHls::is_ts_enabled()
+{
+    return hls_enabled;
+}
+
+int SrsHls::on_ts_sequence_header()
 {
     int ret = ERROR_SUCCESS;
     
@@ -1304,56 +1228,30 @@ int SrsHls::on_audio(SrsSharedPtrMessage* shared_audio)
         return ret;
     }
     
-    // update the hls time, for hls_dispose.
-    last_update_time = srs_get_system_time_ms();
+    return hls_cache->on_sequence_header(muxer);
+}
 
-    SrsSharedPtrMessage* audio = shared_audio->copy();
-    SrsAutoFree(SrsSharedPtrMessage, audio);
-    
-    sample->clear();
-    if ((ret = codec->audio_aac_demux(audio->payload, audio->size, sample)) != ERROR_SUCCESS) {
-        if (ret != ERROR_HLS_TRY_MP3) {
-            srs_error("hls aac demux audio failed. ret=%d", ret);
-            return ret;
-        }
-        if ((ret = codec->audio_mp3_demux(audio->payload, audio->size, sample)) != ERROR_SUCCESS) {
-            srs_error("hls mp3 demux audio failed. ret=%d", ret);
-            return ret;
-        }
-    }
-    srs_info("audio decoded, type=%d, codec=%d, cts=%d, size=%d, time=%"PRId64, 
-        sample->frame_type, codec->audio_codec_id, sample->cts, audio->size, audio->timestamp);
-    SrsCodecAudio acodec = (SrsCodecAudio)codec->audio_codec_id;
-    
-    // ts support audio codec: aac/mp3
-    if (acodec != SrsCodecAudioAAC && acodec != SrsCodecAudioMP3) {
-        return ret;
-    }
+int SrsHls::on_ts_psi(SrsSharedPtrMessage* psi)
+{
+    // always keep the PAT/PMT, which is used when hls enabled by reload.
+    return muxer->update_psi(psi);
+}
 
-    // when codec changed, write new header.
-    if ((ret = muxer->update_acodec(acodec)) != ERROR_SUCCESS) {
-        srs_error("http: ts audio write header failed. ret=%d", ret);
-        return ret;
-    }
-    
-    // ignore sequence header
-    if (acodec == SrsCodecAudioAAC && sample->aac_packet_type == SrsCodecAudioTypeSequenceHeader) {
-        return hls_cache->on_sequence_header(muxer);
-    }
+int SrsHls::on_ts_audio(SrsSharedPtrMessage* block, int64_t pts)
+{
+    int ret = ERROR_SUCCESS;
     
-    // TODO: FIXME: config the jitter of HLS.
-    if ((ret = jitter->correct(audio, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
-        srs_error("rtmp jitter correct audio failed. ret=%d", ret);
+    if (!hls_enabled) {
         return ret;
     }
     
-    // the dts calc from rtmp/flv header.
-    int64_t dts = audio->timestamp * 90;
+    // update the hls time, for hls_dispose.
+    last_update_time = srs_get_system_time_ms();
     
     // for pure audio, we need to update the stream dts also.
-    stream_dts = dts;
+    stream_dts = pts;
     
-    if ((ret = hls_cache->write_audio(codec, muxer, dts, sample)) != ERROR_SUCCESS) {
+    if ((ret = hls_cache->write_audio(muxer, block, pts)) != ERROR_SUCCESS) {
         srs_error("hls cache write audio failed. ret=%d", ret);
         return ret;
     }
@@ -1361,7 +1259,7 @@ int SrsHls::on_audio(SrsSharedPtrMessage* shared_audio)
     return ret;
 }
 
-int SrsHls::on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps)
+int SrsHls::on_ts_video(SrsSharedPtrMessage* block, int64_t dts, bool keyframe)
 {
     int ret = ERROR_SUCCESS;
     
@@ -1371,49 +1269,9 @@ int SrsHls::on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps)
     
     // update the hls time, for hls_dispose.
     last_update_time = srs_get_system_time_ms();
-
-    SrsSharedPtrMessage* video = shared_video->copy();
-    SrsAutoFree(SrsSharedPtrMessage, video);
-    
-    // user can disable the sps parse to workaround when parse sps failed.
-    // @see https://github.com/ossrs/srs/issues/474
-    if (is_sps_pps) {
-        codec->avc_parse_sps = _srs_config->get_parse_sps(_req->vhost);
-    }
-    
-    sample->clear();
-    if ((ret = codec->video_avc_demux(video->payload, video->size, sample)) != ERROR_SUCCESS) {
-        srs_error("hls codec demux video failed. ret=%d", ret);
-        return ret;
-    }
-    srs_info("video decoded, type=%d, codec=%d, avc=%d, cts=%d, size=%d, time=%"PRId64, 
-        sample->frame_type, codec->video_codec_id, sample->avc_packet_type, sample->cts, video->size, video->timestamp);
-    
-    // ignore info frame,
-    // @see https://github.com/ossrs/srs/issues/288#issuecomment-69863909
-    if (sample->frame_type == SrsCodecVideoAVCFrameVideoInfoFrame) {
-        return ret;
-    }
-    
-    if (codec->video_codec_id != SrsCodecVideoAVC) {
-        return ret;
-    }
-    
-    // ignore sequence header
-    if (sample->frame_type == SrsCodecVideoAVCFrameKeyFrame
-         && sample->avc_packet_type == SrsCodecVideoAVCTypeSequenceHeader) {
-        return hls_cache->on_sequence_header(muxer);
-    }
-    
-    // TODO: FIXME: config the jitter of HLS.
-    if ((ret = jitter->correct(video, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
-        srs_error("rtmp jitter correct video failed. ret=%d", ret);
-        return ret;
-    }
     
-    int64_t dts = video->timestamp * 90;
     stream_dts = dts;
-    if ((ret = hls_cache->write_video(codec, muxer, dts, sample)) != ERROR_SUCCESS) {
+    if ((ret = hls_cache->write_video(muxer, block, dts, keyframe)) != ERROR_SUCCESS) {
         srs_error("hls cache write video failed. ret=%d", ret);
         return ret;
     }
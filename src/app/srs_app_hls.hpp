@@ -35,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_file.hpp>
 #include <srs_app_async_call.hpp>
+#include <srs_app_ts_remux.hpp>
 
 class SrsSharedPtrMessage;
 class SrsCodecSample;
@@ -110,16 +111,23 @@ public:
     std::string uri;
     // ts full file to write.
     std::string full_path;
-    // the muxer to write ts.
+    // the writer to write ts blocks.
     SrsHlsCacheWriter* writer;
-    SrsTSMuxer* muxer;
+    // whether the PAT/PMT is written to segment.
+    bool has_psi;
     // current segment start dts for m3u8
     int64_t segment_start_dts;
     // whether current segement is sequence header.
     bool is_sequence_header;
 public:
-    SrsHlsSegment(SrsTsContext* c, bool write_cache, bool write_file, SrsCodecAudio ac, SrsCodecVideo vc);
+    SrsHlsSegment(bool write_cache, bool write_file);
     virtual ~SrsHlsSegment();
+public:
+    /**
+    * write the ts block to segment.
+    * @param block the 188 bytes aligned ts packets from the shared remuxer.
+    */
+    virtual int write(SrsSharedPtrMessage* block);
 public:
     /**
     * update the segment duration.
@@ -219,16 +227,11 @@ private:
     */
     SrsHlsSegment* current;
     /**
-    * the current audio codec, when open new muxer,
-    * set the muxer audio codec.
+    * the PAT/PMT block from the shared remuxer,
+    * write to each segment before the first frame.
     * @see https://github.com/ossrs/srs/issues/301
     */
-    SrsCodecAudio acodec;
-    /**
-     * the ts context, to keep cc continous between ts.
-     * @see https://github.com/ossrs/srs/issues/375
-     */
-    SrsTsContext* context;
+    SrsSharedPtrMessage* psi;
 public:
     SrsHlsMuxer();
     virtual ~SrsHlsMuxer();
@@ -274,44 +277,37 @@ public:
     */
     virtual bool is_segment_absolutely_overflow();
 public:
-    virtual int update_acodec(SrsCodecAudio ac);
     /**
-     * whether current hls muxer is pure audio mode.
-     */
-    virtual bool pure_audio();
-    virtual int flush_audio(SrsTsCache* cache);
-    virtual int flush_video(SrsTsCache* cache);
+    * when the PAT/PMT changed, for example, the audio codec changed.
+    */
+    virtual int update_psi(SrsSharedPtrMessage* block);
+    /**
+    * write the ts block of audio or video to current segment.
+    * @param dts the dts in 90khz of block, to update the segment duration.
+    */
+    virtual int write_audio(SrsSharedPtrMessage* block, int64_t pts);
+    virtual int write_video(SrsSharedPtrMessage* block, int64_t dts);
     /**
     * close segment(ts).
     * @param log_desc the description for log.
     */
     virtual int segment_close(std::string log_desc);
 private:
+    virtual int write_block(SrsSharedPtrMessage* block);
     virtual int refresh_m3u8();
     virtual int _refresh_m3u8(std::string m3u8_file);
 };
 
 /**
 * hls stream cache, 
-* use to cache hls stream and flush to hls muxer.
+* use to reap the segment and flush the ts blocks to hls muxer.
 * 
-* when write stream to ts file:
-* video frame will directly flush to M3u8Muxer,
-* audio frame need to cache, because it's small and flv tbn problem.
-* 
-* whatever, the Hls cache used to cache video/audio,
-* and flush video/audio to m3u8 muxer if needed.
-* 
-* about the flv tbn problem:
-*   flv tbn is 1/1000, ts tbn is 1/90000,
-*   when timestamp convert to flv tbn, it will loose precise,
-*   so we must gather audio frame together, and recalc the timestamp @see SrsTsAacJitter,
-*   we use a aac jitter to correct the audio pts.
+* the audio/video are remuxed to ts blocks by the shared SrsTsRemuxer of source,
+* which cache the audio for flv tbn problem, @see SrsTsCache.
+* so the hls cache only decide when to reap segment, then write the block to muxer.
 */
 class SrsHlsCache
 {
-private:
-    SrsTsCache* cache;
 public:
     SrsHlsCache();
     virtual ~SrsHlsCache();
@@ -329,13 +325,13 @@ public:
     */
     virtual int on_sequence_header(SrsHlsMuxer* muxer);
     /**
-    * write audio to cache, if need to flush, flush to muxer.
+    * write audio block to muxer, reap segment when absolutely overflow.
     */
-    virtual int write_audio(SrsAvcAacCodec* codec, SrsHlsMuxer* muxer, int64_t pts, SrsCodecSample* sample);
+    virtual int write_audio(SrsHlsMuxer* muxer, SrsSharedPtrMessage* block, int64_t pts);
     /**
-    * write video to muxer.
+    * write video block to muxer, reap segment when overflow.
     */
-    virtual int write_video(SrsAvcAacCodec* codec, SrsHlsMuxer* muxer, int64_t dts, SrsCodecSample* sample);
+    virtual int write_video(SrsHlsMuxer* muxer, SrsSharedPtrMessage* block, int64_t dts, bool keyframe);
 private:
     /**
     * reopen the muxer for a new hls segment,
@@ -349,9 +345,11 @@ private:
 /**
 * delivery RTMP stream to HLS(m3u8 and ts),
 * SrsHls provides interface with SrsSource.
+* the audio/video are remuxed by the SrsTsRemuxer of source,
+* which is shared with the http ts clients.
 * TODO: FIXME: add utest for hls.
 */
-class SrsHls
+class SrsHls : public ISrsTsRemuxHandler
 {
 private:
     SrsHlsMuxer* muxer;
@@ -363,9 +361,6 @@ private:
     int64_t last_update_time;
 private:
     SrsSource* source;
-    SrsAvcAacCodec* codec;
-    SrsCodecSample* sample;
-    SrsRtmpJitter* jitter;
     SrsPithyPrint* pprint;
     /**
     * we store the stream dts,
@@ -407,17 +402,13 @@ public:
     * get some information from metadata, it's optinal.
     */
     virtual int on_meta_data(SrsAmf0Object* metadata);
-    /**
-    * mux the audio packets to ts.
-    * @param shared_audio, directly ptr, copy it if need to save it.
-    */
-    virtual int on_audio(SrsSharedPtrMessage* shared_audio);
-    /**
-     * mux the video packets to ts.
-     * @param shared_video, directly ptr, copy it if need to save it.
-     * @param is_sps_pps whether the video is h.264 sps/pps.
-     */
-    virtual int on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps);
+// interface ISrsTsRemuxHandler
+public:
+    virtual bool is_ts_enabled();
+    virtual int on_ts_sequence_header();
+    virtual int on_ts_psi(SrsSharedPtrMessage* psi);
+    virtual int on_ts_audio(SrsSharedPtrMessage* block, int64_t pts);
+    virtual int on_ts_video(SrsSharedPtrMessage* block, int64_t dts, bool keyframe);
 private:
     virtual void hls_show_mux_log();
 };
@@ -25,8 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #ifdef SRS_AUTO_HTTP_API
 
-#include <sstream>
 #include <stdlib.h>
+#include <vector>
 using namespace std;
 
 #include <srs_kernel_log.hpp>
@@ -42,14 +42,43 @@ using namespace std;
 #include <srs_app_config.hpp>
 #include <srs_app_source.hpp>
 #include <srs_app_http_conn.hpp>
+#include <srs_kernel_perf.hpp>
 
-int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string data)
+// the cache of json writers, reused by the api responses.
+std::vector<SrsJsonWriter*> _srs_api_json_cache;
+
+SrsApiJsonWriter::SrsApiJsonWriter()
+{
+    if (_srs_api_json_cache.empty()) {
+        json = new SrsJsonWriter(SRS_API_JSON_BUFFER);
+    } else {
+        json = _srs_api_json_cache.back();
+        _srs_api_json_cache.pop_back();
+    }
+    json->reset();
+}
+
+SrsApiJsonWriter::~SrsApiJsonWriter()
+{
+    if ((int)_srs_api_json_cache.size() < SRS_API_JSON_CACHE) {
+        _srs_api_json_cache.push_back(json);
+    } else {
+        srs_freep(json);
+    }
+}
+
+SrsJsonWriter* SrsApiJsonWriter::get()
+{
+    return json;
+}
+
+int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, char* data, int size)
 {
     int ret = ERROR_SUCCESS;
     
     SrsHttpHeader* h = w->header();
     
-    h->set_content_length(data.length() + callback.length() + 2);
+    h->set_content_length(size + callback.length() + 2);
     h->set_content_type("text/javascript");
     
     if (!callback.empty() && (ret = w->write((char*)callback.data(), (int)callback.length())) != ERROR_SUCCESS) {
@@ -60,7 +89,7 @@ int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string da
     if ((ret = w->write(c0, 1)) != ERROR_SUCCESS) {
         return ret;
     }
-    if ((ret = w->write((char*)data.data(), (int)data.length())) != ERROR_SUCCESS) {
+    if ((ret = w->write(data, size)) != ERROR_SUCCESS) {
         return ret;
     }
     
@@ -72,60 +101,38 @@ int srs_api_response_jsonp(ISrsHttpResponseWriter* w, string callback, string da
     return ret;
 }
 
-int srs_api_response_jsonp_code(ISrsHttpResponseWriter* w, string callback, int code)
-{
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-            << SRS_JFIELD_ERROR(code)
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response_jsonp(w, callback, ss.str());
-}
-
-int srs_api_response_json(ISrsHttpResponseWriter* w, string data)
+int srs_api_response_json(ISrsHttpResponseWriter* w, char* data, int size)
 {
     SrsHttpHeader* h = w->header();
     
-    h->set_content_length(data.length());
+    h->set_content_length(size);
     h->set_content_type("application/json");
     
-    return w->write((char*)data.data(), (int)data.length());
-}
-
-int srs_api_response_json_code(ISrsHttpResponseWriter* w, int code)
-{
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-            << SRS_JFIELD_ERROR(code)
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response_json(w, ss.str());
+    return w->write(data, size);
 }
 
-int srs_api_response(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string json)
+int srs_api_response(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, SrsJsonWriter* json)
 {
     // no jsonp, directly response.
     if (!r->is_jsonp()) {
-        return srs_api_response_json(w, json);
+        return srs_api_response_json(w, json->bytes(), json->size());
     }
     
     // jsonp, get function name from query("callback")
     string callback = r->query_get("callback");
-    return srs_api_response_jsonp(w, callback, json);
+    return srs_api_response_jsonp(w, callback, json->bytes(), json->size());
 }
 
 int srs_api_response_code(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, int code)
 {
-    // no jsonp, directly response.
-    if (!r->is_jsonp()) {
-        return srs_api_response_json_code(w, code);
-    }
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
     
-    // jsonp, get function name from query("callback")
-    string callback = r->query_get("callback");
-    return srs_api_response_jsonp_code(w, callback, code);
+    json->object_start();
+    json->field_error(code);
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiRoot::SrsGoApiRoot()
@@ -139,17 +146,19 @@ SrsGoApiRoot::~SrsGoApiRoot()
 int SrsGoApiRoot::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("urls", SRS_JOBJECT_START)
-            << SRS_JFIELD_STR("api", "the api root")
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("urls");
+    json->field_str("api", "the api root");
+    json->object_end();
+    json->object_end();
         
-    return srs_api_response(w, r, ss.str());
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiApi::SrsGoApiApi()
@@ -163,17 +172,19 @@ SrsGoApiApi::~SrsGoApiApi()
 int SrsGoApiApi::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("urls", SRS_JOBJECT_START)
-            << SRS_JFIELD_STR("v1", "the api version 1.0")
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("urls");
+    json->field_str("v1", "the api version 1.0");
+    json->object_end();
+    json->object_end();
         
-    return srs_api_response(w, r, ss.str());
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiV1::SrsGoApiV1()
@@ -187,34 +198,42 @@ SrsGoApiV1::~SrsGoApiV1()
 int SrsGoApiV1::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("urls", SRS_JOBJECT_START)
-            << SRS_JFIELD_STR("versions", "the version of SRS") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("summaries", "the summary(pid, argv, pwd, cpu, mem) of SRS") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("rusages", "the rusage of SRS") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("self_proc_stats", "the self process stats") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("system_proc_stats", "the system process stats") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("meminfos", "the meminfo of system") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("authors", "the license, copyright, authors and contributors") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("features", "the supported features of SRS") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("requests", "the request itself, for http debug") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("vhosts", "manage all vhosts or specified vhost") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("streams", "manage all streams or specified stream") << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("clients", "manage all clients or specified client, default query top 10 clients") << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("tests", SRS_JOBJECT_START)
-                << SRS_JFIELD_STR("requests", "show the request info") << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("errors", "always return an error 100") << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("redirects", "always redirect to /api/v1/test/errors") << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("[vhost]", "http vhost for http://error.srs.com:1985/api/v1/tests/errors")
-            << SRS_JOBJECT_END
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    
+    json->field_obj("urls");
+    json->field_str("versions", "the version of SRS");
+    json->field_str("summaries", "the summary(pid, argv, pwd, cpu, mem) of SRS");
+    json->field_str("rusages", "the rusage of SRS");
+    json->field_str("self_proc_stats", "the self process stats");
+    json->field_str("system_proc_stats", "the system process stats");
+    json->field_str("meminfos", "the meminfo of system");
+    json->field_str("authors", "the license, copyright, authors and contributors");
+    json->field_str("features", "the supported features of SRS");
+    json->field_str("requests", "the request itself, for http debug");
+    json->field_str("vhosts", "manage all vhosts or specified vhost");
+    json->field_str("streams", "manage all streams or specified stream");
+    json->field_str("clients", "manage all clients or specified client, paged by ?cursor=&count=, filter by ?stream= or ?vhost=");
+    json->field_str("events", "push the changed streams by server-sent events, at /api/v1/events/streams");
+    json->field_str("metrics", "the prometheus metrics of server, vhosts and streams, at /metrics");
+    json->field_str("perf", "the histograms in us of hot stages, reset by ?reset=true");
+    
+    json->field_obj("tests");
+    json->field_str("requests", "show the request info");
+    json->field_str("errors", "always return an error 100");
+    json->field_str("redirects", "always redirect to /api/v1/test/errors");
+    json->field_str("[vhost]", "http vhost for http://error.srs.com:1985/api/v1/tests/errors");
+    json->object_end();
+    
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiVersion::SrsGoApiVersion()
@@ -228,20 +247,22 @@ SrsGoApiVersion::~SrsGoApiVersion()
 int SrsGoApiVersion::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("major", VERSION_MAJOR) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("minor", VERSION_MINOR) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("revision", VERSION_REVISION) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("version", RTMP_SIG_SRS_VERSION)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_int("major", VERSION_MAJOR);
+    json->field_int("minor", VERSION_MINOR);
+    json->field_int("revision", VERSION_REVISION);
+    json->field_str("version", RTMP_SIG_SRS_VERSION);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiSummaries::SrsGoApiSummaries()
@@ -254,9 +275,11 @@ SrsGoApiSummaries::~SrsGoApiSummaries()
 
 int SrsGoApiSummaries::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
-    std::stringstream ss;
-    srs_api_dump_summaries(ss);
-    return srs_api_response(w, r, ss.str());
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    srs_api_dump_summaries(json);
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiRusages::SrsGoApiRusages()
@@ -270,36 +293,38 @@ SrsGoApiRusages::~SrsGoApiRusages()
 int SrsGoApiRusages::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
     
     SrsRusage* ru = srs_get_system_rusage();
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("ok", (ru->ok? "true":"false")) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sample_time", ru->sample_time) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_utime", ru->r.ru_utime.tv_sec) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_stime", ru->r.ru_stime.tv_sec) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_maxrss", ru->r.ru_maxrss) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_ixrss", ru->r.ru_ixrss) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_idrss", ru->r.ru_idrss) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_isrss", ru->r.ru_isrss) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_minflt", ru->r.ru_minflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_majflt", ru->r.ru_majflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_nswap", ru->r.ru_nswap) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_inblock", ru->r.ru_inblock) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_oublock", ru->r.ru_oublock) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_msgsnd", ru->r.ru_msgsnd) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_msgrcv", ru->r.ru_msgrcv) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_nsignals", ru->r.ru_nsignals) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_nvcsw", ru->r.ru_nvcsw) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ru_nivcsw", ru->r.ru_nivcsw)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_bool("ok", ru->ok);
+    json->field_int("sample_time", ru->sample_time);
+    json->field_int("ru_utime", ru->r.ru_utime.tv_sec);
+    json->field_int("ru_stime", ru->r.ru_stime.tv_sec);
+    json->field_int("ru_maxrss", ru->r.ru_maxrss);
+    json->field_int("ru_ixrss", ru->r.ru_ixrss);
+    json->field_int("ru_idrss", ru->r.ru_idrss);
+    json->field_int("ru_isrss", ru->r.ru_isrss);
+    json->field_int("ru_minflt", ru->r.ru_minflt);
+    json->field_int("ru_majflt", ru->r.ru_majflt);
+    json->field_int("ru_nswap", ru->r.ru_nswap);
+    json->field_int("ru_inblock", ru->r.ru_inblock);
+    json->field_int("ru_oublock", ru->r.ru_oublock);
+    json->field_int("ru_msgsnd", ru->r.ru_msgsnd);
+    json->field_int("ru_msgrcv", ru->r.ru_msgrcv);
+    json->field_int("ru_nsignals", ru->r.ru_nsignals);
+    json->field_int("ru_nvcsw", ru->r.ru_nvcsw);
+    json->field_int("ru_nivcsw", ru->r.ru_nivcsw);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiSelfProcStats::SrsGoApiSelfProcStats()
@@ -313,65 +338,67 @@ SrsGoApiSelfProcStats::~SrsGoApiSelfProcStats()
 int SrsGoApiSelfProcStats::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
     
     SrsProcSelfStat* u = srs_get_self_proc_stat();
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("ok", (u->ok? "true":"false")) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sample_time", u->sample_time) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("percent", u->percent) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("pid", u->pid) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("comm", u->comm) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("state", u->state) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("ppid", u->ppid) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("pgrp", u->pgrp) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("session", u->session) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("tty_nr", u->tty_nr) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("tpgid", u->tpgid) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("flags", u->flags) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("minflt", u->minflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cminflt", u->cminflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("majflt", u->majflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cmajflt", u->cmajflt) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("utime", u->utime) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("stime", u->stime) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cutime", u->cutime) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cstime", u->cstime) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("priority", u->priority) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("nice", u->nice) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("num_threads", u->num_threads) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("itrealvalue", u->itrealvalue) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("starttime", u->starttime) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("vsize", u->vsize) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("rss", u->rss) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("rsslim", u->rsslim) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("startcode", u->startcode) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("endcode", u->endcode) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("startstack", u->startstack) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("kstkesp", u->kstkesp) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("kstkeip", u->kstkeip) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("signal", u->signal) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("blocked", u->blocked) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sigignore", u->sigignore) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sigcatch", u->sigcatch) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("wchan", u->wchan) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("nswap", u->nswap) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cnswap", u->cnswap) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("exit_signal", u->exit_signal) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("processor", u->processor) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("rt_priority", u->rt_priority) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("policy", u->policy) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("delayacct_blkio_ticks", u->delayacct_blkio_ticks) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("guest_time", u->guest_time) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("cguest_time", u->cguest_time)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_bool("ok", u->ok);
+    json->field_int("sample_time", u->sample_time);
+    json->field_number("percent", u->percent);
+    json->field_int("pid", u->pid);
+    json->field_str("comm", u->comm);
+    json->field_str("state", std::string(1, u->state));
+    json->field_int("ppid", u->ppid);
+    json->field_int("pgrp", u->pgrp);
+    json->field_int("session", u->session);
+    json->field_int("tty_nr", u->tty_nr);
+    json->field_int("tpgid", u->tpgid);
+    json->field_int("flags", u->flags);
+    json->field_int("minflt", u->minflt);
+    json->field_int("cminflt", u->cminflt);
+    json->field_int("majflt", u->majflt);
+    json->field_int("cmajflt", u->cmajflt);
+    json->field_int("utime", u->utime);
+    json->field_int("stime", u->stime);
+    json->field_int("cutime", u->cutime);
+    json->field_int("cstime", u->cstime);
+    json->field_int("priority", u->priority);
+    json->field_int("nice", u->nice);
+    json->field_int("num_threads", u->num_threads);
+    json->field_int("itrealvalue", u->itrealvalue);
+    json->field_int("starttime", u->starttime);
+    json->field_int("vsize", u->vsize);
+    json->field_int("rss", u->rss);
+    json->field_int("rsslim", u->rsslim);
+    json->field_int("startcode", u->startcode);
+    json->field_int("endcode", u->endcode);
+    json->field_int("startstack", u->startstack);
+    json->field_int("kstkesp", u->kstkesp);
+    json->field_int("kstkeip", u->kstkeip);
+    json->field_int("signal", u->signal);
+    json->field_int("blocked", u->blocked);
+    json->field_int("sigignore", u->sigignore);
+    json->field_int("sigcatch", u->sigcatch);
+    json->field_int("wchan", u->wchan);
+    json->field_int("nswap", u->nswap);
+    json->field_int("cnswap", u->cnswap);
+    json->field_int("exit_signal", u->exit_signal);
+    json->field_int("processor", u->processor);
+    json->field_int("rt_priority", u->rt_priority);
+    json->field_int("policy", u->policy);
+    json->field_int("delayacct_blkio_ticks", u->delayacct_blkio_ticks);
+    json->field_int("guest_time", u->guest_time);
+    json->field_int("cguest_time", u->cguest_time);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiSystemProcStats::SrsGoApiSystemProcStats()
@@ -385,30 +412,32 @@ SrsGoApiSystemProcStats::~SrsGoApiSystemProcStats()
 int SrsGoApiSystemProcStats::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
     
     SrsProcSystemStat* s = srs_get_system_proc_stat();
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("ok", (s->ok? "true":"false")) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sample_time", s->sample_time) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("percent", s->percent) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("user", s->user) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("nice", s->nice) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sys", s->sys) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("idle", s->idle) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("iowait", s->iowait) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("irq", s->irq) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("softirq", s->softirq) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("steal", s->steal) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("guest", s->guest)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_bool("ok", s->ok);
+    json->field_int("sample_time", s->sample_time);
+    json->field_number("percent", s->percent);
+    json->field_int("user", s->user);
+    json->field_int("nice", s->nice);
+    json->field_int("sys", s->sys);
+    json->field_int("idle", s->idle);
+    json->field_int("iowait", s->iowait);
+    json->field_int("irq", s->irq);
+    json->field_int("softirq", s->softirq);
+    json->field_int("steal", s->steal);
+    json->field_int("guest", s->guest);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiMemInfos::SrsGoApiMemInfos()
@@ -422,31 +451,33 @@ SrsGoApiMemInfos::~SrsGoApiMemInfos()
 int SrsGoApiMemInfos::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
     
     SrsMemInfo* m = srs_get_meminfo();
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("ok", (m->ok? "true":"false")) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("sample_time", m->sample_time) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("percent_ram", m->percent_ram) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("percent_swap", m->percent_swap) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("MemActive", m->MemActive) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("RealInUse", m->RealInUse) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("NotInUse", m->NotInUse) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("MemTotal", m->MemTotal) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("MemFree", m->MemFree) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("Buffers", m->Buffers) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("Cached", m->Cached) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("SwapTotal", m->SwapTotal) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("SwapFree", m->SwapFree)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_bool("ok", m->ok);
+    json->field_int("sample_time", m->sample_time);
+    json->field_number("percent_ram", m->percent_ram);
+    json->field_number("percent_swap", m->percent_swap);
+    json->field_int("MemActive", m->MemActive);
+    json->field_int("RealInUse", m->RealInUse);
+    json->field_int("NotInUse", m->NotInUse);
+    json->field_int("MemTotal", m->MemTotal);
+    json->field_int("MemFree", m->MemFree);
+    json->field_int("Buffers", m->Buffers);
+    json->field_int("Cached", m->Cached);
+    json->field_int("SwapTotal", m->SwapTotal);
+    json->field_int("SwapFree", m->SwapFree);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiAuthors::SrsGoApiAuthors()
@@ -460,22 +491,24 @@ SrsGoApiAuthors::~SrsGoApiAuthors()
 int SrsGoApiAuthors::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
-    
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_STR("primary", RTMP_SIG_SRS_PRIMARY) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("license", RTMP_SIG_SRS_LICENSE) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("copyright", RTMP_SIG_SRS_COPYRIGHT) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("authors", RTMP_SIG_SRS_AUTHROS) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("contributors_link", RTMP_SIG_SRS_CONTRIBUTORS_URL) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("contributors", SRS_AUTO_CONSTRIBUTORS)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
     
-    return srs_api_response(w, r, ss.str());
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_str("primary", RTMP_SIG_SRS_PRIMARY);
+    json->field_str("license", RTMP_SIG_SRS_LICENSE);
+    json->field_str("copyright", RTMP_SIG_SRS_COPYRIGHT);
+    json->field_str("authors", RTMP_SIG_SRS_AUTHROS);
+    json->field_str("contributors_link", RTMP_SIG_SRS_CONTRIBUTORS_URL);
+    json->field_str("contributors", SRS_AUTO_CONSTRIBUTORS);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiFeatures::SrsGoApiFeatures()
@@ -489,7 +522,6 @@ SrsGoApiFeatures::~SrsGoApiFeatures()
 int SrsGoApiFeatures::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
 #ifdef SRS_AUTO_SSL
     bool ssl = true;
@@ -577,31 +609,34 @@ int SrsGoApiFeatures::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     bool mr = false;
 #endif
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_BOOL("ssl", ssl) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("hls", hls) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("hds", hds) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("callback", callback) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("api", api) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("httpd", httpd) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("dvr", dvr) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("transcode", transcode) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("ingest", ingest) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("stat", _stat) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("nginx", nginx) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("ffmpeg", ffmpeg) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("stream_caster", caster) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("complex_send", complex_send) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("tcp_nodelay", tcp_nodelay) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("so_sendbuf", so_sendbuf) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("mr", mr)
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_bool("ssl", ssl);
+    json->field_bool("hls", hls);
+    json->field_bool("hds", hds);
+    json->field_bool("callback", callback);
+    json->field_bool("api", api);
+    json->field_bool("httpd", httpd);
+    json->field_bool("dvr", dvr);
+    json->field_bool("transcode", transcode);
+    json->field_bool("ingest", ingest);
+    json->field_bool("stat", _stat);
+    json->field_bool("nginx", nginx);
+    json->field_bool("ffmpeg", ffmpeg);
+    json->field_bool("stream_caster", caster);
+    json->field_bool("complex_send", complex_send);
+    json->field_bool("tcp_nodelay", tcp_nodelay);
+    json->field_bool("so_sendbuf", so_sendbuf);
+    json->field_bool("mr", mr);
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiRequests::SrsGoApiRequests()
@@ -617,54 +652,52 @@ int SrsGoApiRequests::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     ISrsHttpMessage* req = r;
     
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_STR("uri", req->uri()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("path", req->path()) << SRS_JFIELD_CONT;
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_obj("data");
+    json->field_str("uri", req->uri());
+    json->field_str("path", req->path());
     
     // method
     if (req->is_http_get()) {
-        ss  << SRS_JFIELD_STR("METHOD", "GET");
+        json->field_str("METHOD", "GET");
     } else if (req->is_http_post()) {
-        ss  << SRS_JFIELD_STR("METHOD", "POST");
+        json->field_str("METHOD", "POST");
     } else if (req->is_http_put()) {
-        ss  << SRS_JFIELD_STR("METHOD", "PUT");
+        json->field_str("METHOD", "PUT");
     } else if (req->is_http_delete()) {
-        ss  << SRS_JFIELD_STR("METHOD", "DELETE");
+        json->field_str("METHOD", "DELETE");
     } else {
-        ss  << SRS_JFIELD_ORG("METHOD", req->method());
+        json->field_int("METHOD", req->method());
     }
-    ss << SRS_JFIELD_CONT;
     
     // request headers
-    ss      << SRS_JFIELD_NAME("headers") << SRS_JOBJECT_START;
+    json->field_obj("headers");
     for (int i = 0; i < req->request_header_count(); i++) {
         std::string key = req->request_header_key_at(i);
         std::string value = req->request_header_value_at(i);
-        if ( i < req->request_header_count() - 1) {
-            ss      << SRS_JFIELD_STR(key, value) << SRS_JFIELD_CONT;
-        } else {
-            ss      << SRS_JFIELD_STR(key, value);
-        }
+        json->field_str(key.c_str(), value);
     }
-    ss      << SRS_JOBJECT_END << SRS_JFIELD_CONT;
+    json->object_end();
     
     // server informations
-    ss      << SRS_JFIELD_NAME("server") << SRS_JOBJECT_START
-                << SRS_JFIELD_STR("sigature", RTMP_SIG_SRS_KEY) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("name", RTMP_SIG_SRS_NAME) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("version", RTMP_SIG_SRS_VERSION) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("link", RTMP_SIG_SRS_URL) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("time", srs_get_system_time_ms())
-            << SRS_JOBJECT_END
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
-    
-    return srs_api_response(w, r, ss.str());
+    json->field_obj("server");
+    json->field_str("sigature", RTMP_SIG_SRS_KEY);
+    json->field_str("name", RTMP_SIG_SRS_NAME);
+    json->field_str("version", RTMP_SIG_SRS_VERSION);
+    json->field_str("link", RTMP_SIG_SRS_URL);
+    json->field_int("time", srs_get_system_time_ms());
+    json->object_end();
+    
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiVhosts::SrsGoApiVhosts()
@@ -680,7 +713,6 @@ int SrsGoApiVhosts::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     int ret = ERROR_SUCCESS;
     
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
     // path: {pattern}{vhost_id}
     // e.g. /api/v1/vhosts/100     pattern= /api/v1/vhosts/, vhost_id=100
@@ -693,31 +725,31 @@ int SrsGoApiVhosts::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return srs_api_response_code(w, r, ret);
     }
     
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    
     if (r->is_http_get()) {
-        std::stringstream data;
-        
+        // the json is streaming, so response the error code only when failed.
         if (!vhost) {
-            ret = stat->dumps_vhosts(data);
-            
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("vhosts", data.str())
-                << SRS_JOBJECT_END;
+            json->name("vhosts");
+            ret = stat->dumps_vhosts(json);
         } else {
-            ret = vhost->dumps(data);
-            
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("vhost", data.str())
-                << SRS_JOBJECT_END;
+            json->name("vhost");
+            ret = vhost->dumps(json);
         }
         
-        return srs_api_response(w, r, ss.str());
+        if (ret != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
+        }
     }
     
-    return srs_api_response(w, r, ss.str());
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
 }
 
 SrsGoApiStreams::SrsGoApiStreams()
@@ -733,7 +765,6 @@ int SrsGoApiStreams::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     int ret = ERROR_SUCCESS;
     
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
     // path: {pattern}{stream_id}
     // e.g. /api/v1/streams/100     pattern= /api/v1/streams/, stream_id=100
@@ -747,27 +778,29 @@ int SrsGoApiStreams::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     }
     
     if (r->is_http_get()) {
-        std::stringstream data;
+        SrsApiJsonWriter aw;
+        SrsJsonWriter* json = aw.get();
+        
+        json->object_start();
+        json->field_error(ERROR_SUCCESS);
+        json->field_int("server", stat->server_id());
         
+        // the json is streaming, so response the error code only when failed.
         if (!stream) {
-            ret = stat->dumps_streams(data);
-            
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("streams", data.str())
-                << SRS_JOBJECT_END;
+            json->name("streams");
+            ret = stat->dumps_streams(json);
         } else {
-            ret = stream->dumps(data);
-            
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("stream", data.str())
-                << SRS_JOBJECT_END;
+            json->name("stream");
+            ret = stream->dumps(json);
+        }
+        
+        if (ret != ERROR_SUCCESS) {
+            return srs_api_response_code(w, r, ret);
         }
         
-        return srs_api_response(w, r, ss.str());
+        json->object_end();
+        
+        return srs_api_response(w, r, json);
     }
     
     return ret;
@@ -786,7 +819,6 @@ int SrsGoApiClients::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     int ret = ERROR_SUCCESS;
     
     SrsStatistic* stat = SrsStatistic::instance();
-    std::stringstream ss;
     
     // path: {pattern}{client_id}
     // e.g. /api/v1/clients/100     pattern= /api/v1/clients/, client_id=100
@@ -810,27 +842,59 @@ int SrsGoApiClients::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         srs_warn("kickoff client id=%d ok", cid);
         return srs_api_response_code(w, r, ret);
     } else if (r->is_http_get()) {
-        std::stringstream data;
+        SrsApiJsonWriter aw;
+        SrsJsonWriter* json = aw.get();
+        
+        json->object_start();
+        json->field_error(ERROR_SUCCESS);
+        json->field_int("server", stat->server_id());
         
         if (!client) {
-            ret = stat->dumps_clients(data, 0, 10);
+            // query: ?cursor=100&count=10&stream=200&vhost=300
+            // cursor is the next of last page, and filter by stream or vhost id.
+            std::string query = r->query_get("cursor");
+            int cursor = query.empty()? -1 : ::atoi(query.c_str());
             
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("clients", data.str())
-                << SRS_JOBJECT_END;
-        } else {
-            ret = client->dumps(data);
+            // the empty page never advance the cursor, reject it.
+            query = r->query_get("count");
+            int count = query.empty()? SRS_API_CLIENTS_PAGE : ::atoi(query.c_str());
+            if (count <= 0) {
+                ret = ERROR_REQUEST_DATA;
+                srs_error("clients page count=%s invalid. ret=%d", query.c_str(), ret);
+                return srs_api_response_code(w, r, ret);
+            }
+            count = srs_min(SRS_API_CLIENTS_PAGE_MAX, count);
+            
+            SrsStatisticStream* stream = NULL;
+            if (!(query = r->query_get("stream")).empty() && (stream = stat->find_stream(::atoi(query.c_str()))) == NULL) {
+                ret = ERROR_RTMP_STREAM_NOT_FOUND;
+                srs_error("stream stream_id=%s not found. ret=%d", query.c_str(), ret);
+                return srs_api_response_code(w, r, ret);
+            }
+            
+            SrsStatisticVhost* vhost = NULL;
+            if (!(query = r->query_get("vhost")).empty() && (vhost = stat->find_vhost(::atoi(query.c_str()))) == NULL) {
+                ret = ERROR_RTMP_VHOST_NOT_FOUND;
+                srs_error("vhost id=%s not found. ret=%d", query.c_str(), ret);
+                return srs_api_response_code(w, r, ret);
+            }
             
-            ss << SRS_JOBJECT_START
-                    << SRS_JFIELD_ERROR(ret) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("server", stat->server_id()) << SRS_JFIELD_CONT
-                    << SRS_JFIELD_ORG("client", data.str())
-                << SRS_JOBJECT_END;
+            int next = -1;
+            json->name("clients");
+            if ((ret = stat->dumps_clients(json, cursor, count, vhost, stream, next)) != ERROR_SUCCESS) {
+                return srs_api_response_code(w, r, ret);
+            }
+            json->field_int("next", next);
+        } else {
+            json->name("client");
+            if ((ret = client->dumps(json)) != ERROR_SUCCESS) {
+                return srs_api_response_code(w, r, ret);
+            }
         }
         
-        return srs_api_response(w, r, ss.str());
+        json->object_end();
+        
+        return srs_api_response(w, r, json);
     } else {
         return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
     }
@@ -838,6 +902,167 @@ int SrsGoApiClients::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     return ret;
 }
 
+SrsGoApiStreamEvents::SrsGoApiStreamEvents()
+{
+}
+
+SrsGoApiStreamEvents::~SrsGoApiStreamEvents()
+{
+}
+
+int SrsGoApiStreamEvents::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
+    
+    SrsStatistic* stat = SrsStatistic::instance();
+    int interval = (int)(_srs_config->get_http_api_events_interval() * 1000);
+    interval = srs_max(100, interval);
+    
+    w->header()->set_content_type("text/event-stream");
+    w->header()->set("Cache-Control", "no-cache");
+    w->write_header(SRS_CONSTS_HTTP_OK);
+    
+    // the snapshots of the client, the first event is all streams.
+    std::map<int64_t, SrsStatisticStreamSnapshot> snapshots;
+    
+    // the writer is reused by all events of the client.
+    SrsJsonWriter json;
+    
+    static char* data = (char*)"data: ";
+    static char* eol = (char*)"\n\n";
+    static char* heartbeat = (char*)":\n\n";
+    
+    while (true) {
+        int nb_changed = 0;
+        
+        json.reset();
+        json.object_start();
+        json.field_int("server", stat->server_id());
+        json.name("streams");
+        if ((ret = stat->dumps_streams_delta(&json, snapshots, nb_changed)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        json.object_end();
+        
+        // send the changed streams, or a comment line as heartbeat,
+        // which also detect the client closed.
+        if (nb_changed > 0) {
+            iovec iovs[3];
+            iovs[0].iov_base = data;
+            iovs[0].iov_len = 6;
+            iovs[1].iov_base = json.bytes();
+            iovs[1].iov_len = json.size();
+            iovs[2].iov_base = eol;
+            iovs[2].iov_len = 2;
+            ret = w->writev(iovs, 3, NULL);
+        } else {
+            ret = w->write(heartbeat, 3);
+        }
+        
+        if (ret != ERROR_SUCCESS) {
+            if (!srs_is_client_gracefully_close(ret)) {
+                srs_error("http: push stream events failed. ret=%d", ret);
+            }
+            return ret;
+        }
+        
+        st_usleep(interval * 1000);
+    }
+    
+    return ret;
+}
+
+SrsGoApiMetrics::SrsGoApiMetrics()
+{
+    buffer = new SrsMetricsBuffer(SRS_API_METRICS_BUFFER);
+}
+
+SrsGoApiMetrics::~SrsGoApiMetrics()
+{
+    srs_freep(buffer);
+}
+
+int SrsGoApiMetrics::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
+    
+    SrsStatistic* stat = SrsStatistic::instance();
+    
+    // reuse the buffer, which grows to the max size of metrics.
+    buffer->reset();
+    if ((ret = stat->dumps_metrics(buffer, _srs_config->get_http_api_metrics_max_streams())) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    w->header()->set_content_length(buffer->size());
+    w->header()->set_content_type("text/plain; version=0.0.4");
+    
+    return w->write(buffer->bytes(), buffer->size());
+}
+
+SrsGoApiPerf::SrsGoApiPerf()
+{
+}
+
+SrsGoApiPerf::~SrsGoApiPerf()
+{
+}
+
+int SrsGoApiPerf::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+{
+    SrsStatistic* stat = SrsStatistic::instance();
+    
+#ifdef SRS_PERF_HISTOGRAM
+    bool enabled = true;
+#else
+    bool enabled = false;
+#endif
+    
+    // reset all histograms when ?reset=true
+    bool reset = r->query_get("reset") == "true";
+    
+    SrsApiJsonWriter aw;
+    SrsJsonWriter* json = aw.get();
+    
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    json->field_int("server", stat->server_id());
+    json->field_bool("enabled", enabled);
+    json->field_str("unit", "us");
+    json->field_obj("data");
+    
+    for (int i = 0; i < SrsPerfStageMax; i++) {
+        SrsPerfHistogram* h = srs_perf_histogram((SrsPerfStage)i);
+        
+        json->field_obj(h->get_name());
+        json->field_int("count", h->get_count());
+        json->field_int("avg", h->avg());
+        json->field_int("p50", h->percentile(50));
+        json->field_int("p90", h->percentile(90));
+        json->field_int("p99", h->percentile(99));
+        json->field_int("p999", h->percentile(99.9));
+        json->field_int("max", h->get_max());
+        json->object_end();
+        
+        if (reset) {
+            h->reset();
+        }
+    }
+    
+    json->object_end();
+    json->object_end();
+    
+    return srs_api_response(w, r, json);
+}
+
 SrsGoApiError::SrsGoApiError()
 {
 }
@@ -906,20 +1131,16 @@ int SrsHttpApi::do_cycle()
     // @see https://github.com/ossrs/srs/issues/398
     skt.set_recv_timeout(SRS_HTTP_RECV_TIMEOUT_US);
     
+    // the message is reused for all requests of connection.
+    SrsHttpMessage* req = new SrsHttpMessage(&skt, this);
+    SrsAutoFree(SrsHttpMessage, req);
+    
     // process http messages.
     while(!disposed) {
-        ISrsHttpMessage* req = NULL;
-        
         // get a http message
-        if ((ret = parser->parse_message(&skt, this, &req)) != ERROR_SUCCESS) {
+        if ((ret = parser->parse_message(&skt, req)) != ERROR_SUCCESS) {
             return ret;
         }
-
-        // if SUCCESS, always NOT-NULL.
-        srs_assert(req);
-        
-        // always free it in this scope.
-        SrsAutoFree(ISrsHttpMessage, req);
         
         // ok, handle http request.
         SrsHttpResponseWriter writer(&skt);
@@ -980,6 +1201,10 @@ int SrsHttpApi::process_request(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return w->final_request();
     }
     
+#ifdef SRS_PERF_HISTOGRAM
+    int64_t starttime = srs_perf_now_us();
+#endif
+    
     // use default server mux to serve http request.
     if ((ret = mux->serve_http(w, r)) != ERROR_SUCCESS) {
         if (!srs_is_client_gracefully_close(ret)) {
@@ -988,6 +1213,14 @@ int SrsHttpApi::process_request(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return ret;
     }
     
+#ifdef SRS_PERF_HISTOGRAM
+    // only the response with content-length, ignore the stream,
+    // for instance, the http flv and server-sent events.
+    if (w->header()->content_length() >= 0) {
+        srs_perf_record(SrsPerfStageHttpRequest, srs_perf_now_us() - starttime);
+    }
+#endif
+    
     return ret;
 }
 
@@ -36,11 +36,38 @@ class SrsStSocket;
 class ISrsHttpMessage;
 class SrsHttpParser;
 class SrsHttpHandler;
+class SrsMetricsBuffer;
+class SrsJsonWriter;
 
 #include <srs_app_st.hpp>
 #include <srs_app_conn.hpp>
 #include <srs_http_stack.hpp>
 
+// the default and max count of clients in a page.
+#define SRS_API_CLIENTS_PAGE 10
+#define SRS_API_CLIENTS_PAGE_MAX 1000
+// the initial size of prometheus metrics buffer, grows when exceed.
+#define SRS_API_METRICS_BUFFER 64 * 1024
+// the initial size of json writer, and the max writers to cache.
+#define SRS_API_JSON_BUFFER 4 * 1024
+#define SRS_API_JSON_CACHE 8
+
+/**
+ * get a json writer from cache to response the api, put back when destroy.
+ * @remark the response may yield when write to socket, so each request
+ *      must use its own writer, never share one in handler.
+ */
+class SrsApiJsonWriter
+{
+private:
+    SrsJsonWriter* json;
+public:
+    SrsApiJsonWriter();
+    virtual ~SrsApiJsonWriter();
+public:
+    virtual SrsJsonWriter* get();
+};
+
 // for http root.
 class SrsGoApiRoot : public ISrsHttpHandler
 {
@@ -177,6 +204,49 @@ public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
 };
 
+/**
+ * the server-sent events of streams, push the changed counters of
+ * streams in interval, to avoid the client to poll the whole streams.
+ * @see https://html.spec.whatwg.org/multipage/server-sent-events.html
+ */
+class SrsGoApiStreamEvents : public ISrsHttpHandler
+{
+public:
+    SrsGoApiStreamEvents();
+    virtual ~SrsGoApiStreamEvents();
+public:
+    virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
+};
+
+/**
+ * the prometheus metrics of server, vhosts and streams,
+ * rendered from statistic to a reused buffer.
+ * @see https://prometheus.io/docs/instrumenting/exposition_formats/
+ */
+class SrsGoApiMetrics : public ISrsHttpHandler
+{
+private:
+    SrsMetricsBuffer* buffer;
+public:
+    SrsGoApiMetrics();
+    virtual ~SrsGoApiMetrics();
+public:
+    virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
+};
+
+/**
+ * the histograms of hot stages, in us.
+ * @see SRS_PERF_HISTOGRAM
+ */
+class SrsGoApiPerf : public ISrsHttpHandler
+{
+public:
+    SrsGoApiPerf();
+    virtual ~SrsGoApiPerf();
+public:
+    virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
+};
+
 class SrsGoApiError : public ISrsHttpHandler
 {
 public:
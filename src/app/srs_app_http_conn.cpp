@@ -56,6 +56,8 @@ using namespace std;
 #include <srs_app_http_stream.hpp>
 #include <srs_app_http_api.hpp>
 #include <srs_app_utility.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_kernel_perf.hpp>
 
 #endif
 
@@ -242,6 +244,43 @@ int SrsHttpResponseWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
     return ret;
 }
 
+int SrsHttpResponseWriter::sendfile(SrsFileReader* fs, int64_t offset, int size)
+{
+    int ret = ERROR_SUCCESS;
+    
+#ifndef SRS_PERF_SENDFILE
+    ret = ERROR_HTTP_SENDFILE_UNSUPPORTED;
+#else
+    // write the header data in memory.
+    if (!header_wrote) {
+        write_header(SRS_CONSTS_HTTP_OK);
+    }
+    
+    // the chunked encoding requires the chunk header for each write.
+    if (content_length == -1) {
+        return ERROR_HTTP_SENDFILE_UNSUPPORTED;
+    }
+    
+    // whatever header is wrote, we should try to send header.
+    if ((ret = send_header(NULL, 0)) != ERROR_SUCCESS) {
+        srs_error("http: send header failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // check the bytes send and content length.
+    written += size;
+    if (written > content_length) {
+        ret = ERROR_HTTP_CONTENT_LENGTH;
+        srs_error("http: exceed content length. ret=%d", ret);
+        return ret;
+    }
+    
+    ret = skt->sendfile(fs->get_fd(), offset, size, NULL);
+#endif
+    
+    return ret;
+}
+
 void SrsHttpResponseWriter::write_header(int code)
 {
     if (header_wrote) {
@@ -301,6 +340,11 @@ int SrsHttpResponseWriter::send_header(char* data, int size)
     return skt->write((void*)buf.c_str(), buf.length(), NULL);
 }
 
+void SrsHttpResponseWriter::set_pacer(SrsPacer* pacer)
+{
+    skt->set_pacer(pacer);
+}
+
 SrsHttpResponseReader::SrsHttpResponseReader(SrsHttpMessage* msg, SrsStSocket* io)
 {
     skt = io;
@@ -319,6 +363,7 @@ int SrsHttpResponseReader::initialize(SrsFastBuffer* body)
 {
     int ret = ERROR_SUCCESS;
     
+    is_eof = false;
     nb_chunk = 0;
     nb_left_chunk = 0;
     nb_total_read = 0;
@@ -506,6 +551,16 @@ int SrsHttpResponseReader::read_specified(char* data, int nb_data, int* nb_read)
     return ret;
 }
 
+SrsHttpSlice::SrsHttpSlice()
+{
+    offset = 0;
+    size = 0;
+}
+
+SrsHttpSlice::~SrsHttpSlice()
+{
+}
+
 SrsHttpMessage::SrsHttpMessage(SrsStSocket* io, SrsConnection* c) : ISrsHttpMessage()
 {
     conn = c;
@@ -516,6 +571,8 @@ SrsHttpMessage::SrsHttpMessage(SrsStSocket* io, SrsConnection* c) : ISrsHttpMess
     _body = new SrsHttpResponseReader(this, io);
     _http_ts_send_buffer = new char[SRS_HTTP_TS_SEND_BUFFER_SIZE];
     jsonp = false;
+    _header_block = NULL;
+    _nb_header_block = 0;
 }
 
 SrsHttpMessage::~SrsHttpMessage()
@@ -523,19 +580,36 @@ SrsHttpMessage::~SrsHttpMessage()
     srs_freep(_body);
     srs_freep(_uri);
     srs_freepa(_http_ts_send_buffer);
+    srs_freepa(_header_block);
 }
 
-int SrsHttpMessage::update(string url, http_parser* header, SrsFastBuffer* body, vector<SrsHttpHeaderField>& headers)
+int SrsHttpMessage::update(char* block, int nb_block, SrsHttpSlice url, http_parser* header, SrsFastBuffer* body, vector<SrsHttpHeaderSlice>& headers)
 {
     int ret = ERROR_SUCCESS;
     
-    _url = url;
+    // copy the header block, only grow when not enough,
+    // for the block in buffer will be overwrote by the next message.
+    if (_nb_header_block < nb_block) {
+        srs_freepa(_header_block);
+        _header_block = new char[nb_block];
+        _nb_header_block = nb_block;
+    }
+    memcpy(_header_block, block, nb_block);
+    
     _header = *header;
-    _headers = headers;
+    // swap the header slices with parser, both vectors keep its capacity,
+    // for the parser always clear it before parse the next message.
+    _headers.swap(headers);
+    
+    // reset the state of last message.
+    infinite_chunked = false;
+    jsonp = false;
+    jsonp_method = "";
     
     // whether chunked.
-    std::string transfer_encoding = get_request_header("Transfer-Encoding");
-    chunked = (transfer_encoding == "chunked");
+    SrsHttpSlice* transfer_encoding = header_slice("Transfer-Encoding");
+    chunked = transfer_encoding && transfer_encoding->size == 7
+        && memcmp(_header_block + transfer_encoding->offset, "chunked", 7) == 0;
     
     // whether keep alive.
     keep_alive = http_should_keep_alive(header);
@@ -545,50 +619,31 @@ int SrsHttpMessage::update(string url, http_parser* header, SrsFastBuffer* body,
         return ret;
     }
     
-    // parse uri from url.
-    std::string host = get_request_header("Host");
+    // parse uri to schema/server:port/path?query,
+    // build the uri in the reused string, never alloc when capacity is enough.
+    _uri_cache.assign("http://");
     
     // use server public ip when no host specified.
     // to make telnet happy.
-    if (host.empty()) {
-        host= srs_get_public_internet_address();
+    SrsHttpSlice* host = header_slice("Host");
+    if (host && host->size > 0) {
+        _uri_cache.append(_header_block + host->offset, host->size);
+    } else {
+        _uri_cache.append(srs_get_public_internet_address());
     }
+    _uri_cache.append(_header_block + url.offset, url.size);
     
-    // parse uri to schema/server:port/path?query
-    std::string uri = "http://" + host + _url;
-    if ((ret = _uri->initialize(uri)) != ERROR_SUCCESS) {
+    if ((ret = _uri->initialize(_uri_cache)) != ERROR_SUCCESS) {
         return ret;
     }
     
-    // must format as key=value&...&keyN=valueN
-    std::string q = _uri->get_query();
-    size_t pos = string::npos;
-    while (!q.empty()) {
-        std::string k = q;
-        if ((pos = q.find("=")) != string::npos) {
-            k = q.substr(0, pos);
-            q = q.substr(pos + 1);
-        } else {
-            q = "";
-        }
-        
-        std::string v = q;
-        if ((pos = q.find("&")) != string::npos) {
-            v = q.substr(0, pos);
-            q = q.substr(pos + 1);
-        } else {
-            q = "";
-        }
-        
-        _query[k] = v;
-    }
-    
     // parse ext.
-    _ext = _uri->get_path();
-    if ((pos = _ext.rfind(".")) != string::npos) {
-        _ext = _ext.substr(pos);
+    const char* path = _uri->get_path();
+    const char* pext = strrchr(path, '.');
+    if (pext) {
+        _ext.assign(pext);
     } else {
-        _ext = "";
+        _ext.clear();
     }
     
     // parse jsonp request message.
@@ -804,8 +859,26 @@ string SrsHttpMessage::query_get(string key)
 {
     std::string v;
     
-    if (_query.find(key) != _query.end()) {
-        v = _query[key];
+    // scan the query in place, for most requests only get one or two params,
+    // which is cheaper than parse all params to a map for each request.
+    // must format as key=value&...&keyN=valueN
+    const char* p = _uri->get_query();
+    while (*p) {
+        const char* end = strchr(p, '&');
+        if (!end) {
+            end = p + strlen(p);
+        }
+        
+        const char* eq = (const char*)memchr(p, '=', end - p);
+        const char* pk = eq? eq : end;
+        if (pk - p == (int)key.length() && memcmp(p, key.data(), key.length()) == 0) {
+            if (eq) {
+                v.assign(eq + 1, end - eq - 1);
+            }
+            return v;
+        }
+        
+        p = *end? end + 1 : end;
     }
     
     return v;
@@ -819,31 +892,41 @@ int SrsHttpMessage::request_header_count()
 string SrsHttpMessage::request_header_key_at(int index)
 {
     srs_assert(index < request_header_count());
-    SrsHttpHeaderField item = _headers[index];
-    return item.first;
+    SrsHttpSlice& key = _headers[index].first;
+    return string(_header_block + key.offset, key.size);
 }
 
 string SrsHttpMessage::request_header_value_at(int index)
 {
     srs_assert(index < request_header_count());
-    SrsHttpHeaderField item = _headers[index];
-    return item.second;
+    SrsHttpSlice& value = _headers[index].second;
+    return string(_header_block + value.offset, value.size);
 }
 
 string SrsHttpMessage::get_request_header(string name)
 {
-    std::vector<SrsHttpHeaderField>::iterator it;
+    SrsHttpSlice* value = header_slice(name.c_str());
+    
+    if (!value) {
+        return "";
+    }
+    
+    return string(_header_block + value->offset, value->size);
+}
+
+SrsHttpSlice* SrsHttpMessage::header_slice(const char* name)
+{
+    int nb_name = (int)strlen(name);
+    std::vector<SrsHttpHeaderSlice>::iterator it;
     
     for (it = _headers.begin(); it != _headers.end(); ++it) {
-        SrsHttpHeaderField& elem = *it;
-        std::string key = elem.first;
-        std::string value = elem.second;
-        if (key == name) {
-            return value;
+        SrsHttpSlice& key = it->first;
+        if (key.size == nb_name && memcmp(_header_block + key.offset, name, nb_name) == 0) {
+            return &it->second;
         }
     }
     
-    return "";
+    return NULL;
 }
 
 SrsRequest* SrsHttpMessage::to_request(string vhost)
@@ -878,6 +961,8 @@ bool SrsHttpMessage::is_jsonp()
 SrsHttpParser::SrsHttpParser()
 {
     buffer = new SrsFastBuffer();
+    type = HTTP_REQUEST;
+    block = NULL;
 }
 
 SrsHttpParser::~SrsHttpParser()
@@ -898,9 +983,8 @@ int SrsHttpParser::initialize(enum http_parser_type type)
     settings.on_body = on_body;
     settings.on_message_complete = on_message_complete;
     
-    http_parser_init(&parser, type);
-    // callback object ptr.
-    parser.data = (void*)this;
+    // the parser is reset for each message.
+    this->type = type;
     
     return ret;
 }
@@ -911,16 +995,39 @@ int SrsHttpParser::parse_message(SrsStSocket* skt, SrsConnection* conn, ISrsHttp
     
     int ret = ERROR_SUCCESS;
     
+    // create msg
+    SrsHttpMessage* msg = new SrsHttpMessage(skt, conn);
+    
+    if ((ret = parse_message(skt, msg)) != ERROR_SUCCESS) {
+        srs_freep(msg);
+        return ret;
+    }
+    
+    // parse ok, return the msg.
+    *ppmsg = msg;
+    
+    return ret;
+}
+
+int SrsHttpParser::parse_message(SrsStSocket* skt, SrsHttpMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
     // reset request data.
-    field_name = "";
-    field_value = "";
     expect_field_name = true;
     state = SrsHttpParseStateInit;
     header = http_parser();
-    url = "";
+    block = NULL;
+    url = SrsHttpSlice();
     headers.clear();
     header_parsed = 0;
     
+    // reset the parser, for the body is never parsed by it,
+    // the parser must start at the header of each message.
+    http_parser_init(&parser, type);
+    // callback object ptr.
+    parser.data = (void*)this;
+    
     // do parse
     if ((ret = parse_message_imp(skt)) != ERROR_SUCCESS) {
         if (!srs_is_client_gracefully_close(ret)) {
@@ -929,19 +1036,12 @@ int SrsHttpParser::parse_message(SrsStSocket* skt, SrsConnection* conn, ISrsHttp
         return ret;
     }
     
-    // create msg
-    SrsHttpMessage* msg = new SrsHttpMessage(skt, conn);
-    
     // initalize http msg, parse url.
-    if ((ret = msg->update(url, &header, buffer, headers)) != ERROR_SUCCESS) {
+    if ((ret = msg->update(block, header_parsed, url, &header, buffer, headers)) != ERROR_SUCCESS) {
         srs_error("initialize http msg failed. ret=%d", ret);
-        srs_freep(msg);
         return ret;
     }
     
-    // parse ok, return the msg.
-    *ppmsg = msg;
-    
     return ret;
 }
 
@@ -949,48 +1049,58 @@ int SrsHttpParser::parse_message_imp(SrsStSocket* skt)
 {
     int ret = ERROR_SUCCESS;
     
+    // the bytes already scanned for the header end,
+    // never scan them again when read more bytes.
+    int nb_scanned = 0;
+    
     while (true) {
-        ssize_t nparsed = 0;
-        
         // when got entire http header, parse it.
         // @see https://github.com/ossrs/srs/issues/400
         char* start = buffer->bytes();
-        char* end = start + buffer->size();
-        for (char* p = start; p <= end - 4; p++) {
+        int size = buffer->size();
+        
+        int nb_header = 0;
+        for (int i = srs_max(0, nb_scanned - 3); i <= size - 4; i++) {
+            char* p = start + i;
             // SRS_HTTP_CRLFCRLF "\r\n\r\n" // 0x0D0A0D0A
             if (p[0] == SRS_CONSTS_CR && p[1] == SRS_CONSTS_LF && p[2] == SRS_CONSTS_CR && p[3] == SRS_CONSTS_LF) {
-                nparsed = http_parser_execute(&parser, &settings, buffer->bytes(), buffer->size());
-                srs_info("buffer=%d, nparsed=%d, header=%d", buffer->size(), (int)nparsed, header_parsed);
+                nb_header = i + 4;
                 break;
             }
         }
         
-        // consume the parsed bytes.
-        if (nparsed && header_parsed) {
-            buffer->read_slice(header_parsed);
-        }
-        
-        // ok atleast header completed,
-        // never wait for body completed, for maybe chunked.
-        if (state == SrsHttpParseStateHeaderComplete || state == SrsHttpParseStateMessageComplete) {
-            break;
-        }
-        
-        // when nothing parsed, read more to parse.
-        if (nparsed == 0) {
+        // when no header end, read more to parse.
+        if (nb_header == 0) {
+            nb_scanned = size;
+            
             // when requires more, only grow 1bytes, but the buffer will cache more.
-            if ((ret = buffer->grow(skt, buffer->size() + 1)) != ERROR_SUCCESS) {
+            if ((ret = buffer->grow(skt, size + 1)) != ERROR_SUCCESS) {
                 if (!srs_is_client_gracefully_close(ret)) {
                     srs_error("read body from server failed. ret=%d", ret);
                 }
                 return ret;
             }
+            continue;
         }
-    }
-    
-    // parse last header.
-    if (!field_name.empty() && !field_value.empty()) {
-        headers.push_back(std::make_pair(field_name, field_value));
+        
+        // only parse the header of the first message, the left bytes
+        // are body or the pipelined messages, which are kept in buffer.
+        ssize_t nparsed = http_parser_execute(&parser, &settings, start, nb_header);
+        srs_info("buffer=%d, nparsed=%d, header=%d", size, (int)nparsed, nb_header);
+        
+        if (nparsed != nb_header || HTTP_PARSER_ERRNO(&parser) != HPE_OK
+            || (state != SrsHttpParseStateHeaderComplete && state != SrsHttpParseStateMessageComplete)
+        ) {
+            ret = ERROR_HTTP_PARSE_HEADER;
+            srs_error("parse http header failed, nparsed=%d, header=%d, errno=%d. ret=%d",
+                (int)nparsed, nb_header, (int)HTTP_PARSER_ERRNO(&parser), ret);
+            return ret;
+        }
+        
+        // consume the header, the slices in block is valid util buffer grow.
+        header_parsed = nb_header;
+        block = buffer->read_slice(nb_header);
+        break;
     }
     
     return ret;
@@ -1016,7 +1126,6 @@ int SrsHttpParser::on_headers_complete(http_parser* parser)
     obj->header = *parser;
     // save the parser when header parse completed.
     obj->state = SrsHttpParseStateHeaderComplete;
-    obj->header_parsed = (int)parser->nread;
     
     srs_info("***HEADERS COMPLETE***");
     
@@ -1042,9 +1151,11 @@ int SrsHttpParser::on_url(http_parser* parser, const char* at, size_t length)
     SrsHttpParser* obj = (SrsHttpParser*)parser->data;
     srs_assert(obj);
     
-    if (length > 0) {
-        obj->url.append(at, (int)length);
+    // the url maybe callback in pieces, which are continuous in buffer.
+    if (obj->url.size == 0) {
+        obj->url.offset = (int)(at - obj->buffer->bytes());
     }
+    obj->url.size += (int)length;
     
     srs_info("Method: %d, Url: %.*s", parser->method, (int)length, at);
     
@@ -1056,19 +1167,16 @@ int SrsHttpParser::on_header_field(http_parser* parser, const char* at, size_t l
     SrsHttpParser* obj = (SrsHttpParser*)parser->data;
     srs_assert(obj);
     
-    // field value=>name, reap the field.
-    if (!obj->expect_field_name) {
-        obj->headers.push_back(std::make_pair(obj->field_name, obj->field_value));
-        
-        // reset the field name when parsed.
-        obj->field_name = "";
-        obj->field_value = "";
+    // field value=>name, start a new field.
+    if (!obj->expect_field_name || obj->headers.empty()) {
+        SrsHttpSlice key;
+        key.offset = (int)(at - obj->buffer->bytes());
+        obj->headers.push_back(std::make_pair(key, SrsHttpSlice()));
     }
     obj->expect_field_name = true;
     
-    if (length > 0) {
-        obj->field_name.append(at, (int)length);
-    }
+    // the field maybe callback in pieces, which are continuous in buffer.
+    obj->headers.back().first.size += (int)length;
     
     srs_info("Header field(%d bytes): %.*s", (int)length, (int)length, at);
     return 0;
@@ -1079,9 +1187,16 @@ int SrsHttpParser::on_header_value(http_parser* parser, const char* at, size_t l
     SrsHttpParser* obj = (SrsHttpParser*)parser->data;
     srs_assert(obj);
     
-    if (length > 0) {
-        obj->field_value.append(at, (int)length);
+    // the value must follow a field.
+    if (obj->headers.empty()) {
+        return 0;
     }
+    
+    SrsHttpSlice& value = obj->headers.back().second;
+    if (value.size == 0) {
+        value.offset = (int)(at - obj->buffer->bytes());
+    }
+    value.size += (int)length;
     obj->expect_field_name = false;
     
     srs_info("Header value(%d bytes): %.*s", (int)length, (int)length, at);
@@ -1107,11 +1222,12 @@ SrsHttpUri::~SrsHttpUri()
 {
 }
 
-int SrsHttpUri::initialize(string _url)
+int SrsHttpUri::initialize(const string& _url)
 {
     int ret = ERROR_SUCCESS;
     
-    url = _url;
+    // assign to the fields, which reuse the capacity when uri reused.
+    url.assign(_url);
     const char* purl = url.c_str();
     
     http_parser_url hp_u;
@@ -1123,22 +1239,18 @@ int SrsHttpUri::initialize(string _url)
         return ret;
     }
     
-    std::string field = get_uri_field(url, &hp_u, UF_SCHEMA);
-    if(!field.empty()){
-        schema = field;
-    }
-    
-    host = get_uri_field(url, &hp_u, UF_HOST);
+    get_uri_field(schema, &hp_u, UF_SCHEMA);
+    get_uri_field(host, &hp_u, UF_HOST);
     
-    field = get_uri_field(url, &hp_u, UF_PORT);
-    if(!field.empty()){
-        port = atoi(field.c_str());
+    port = SRS_DEFAULT_HTTP_PORT;
+    if((hp_u.field_set & (1 << UF_PORT)) != 0){
+        port = ::atoi(purl + hp_u.field_data[UF_PORT].off);
     }
     
-    path = get_uri_field(url, &hp_u, UF_PATH);
+    get_uri_field(path, &hp_u, UF_PATH);
     srs_info("parse url %s success", purl);
     
-    query = get_uri_field(url, &hp_u, UF_QUERY);
+    get_uri_field(query, &hp_u, UF_QUERY);
     srs_info("parse query %s success", query.c_str());
     
     return ret;
@@ -1174,22 +1286,23 @@ const char* SrsHttpUri::get_query()
     return query.data();
 }
 
-string SrsHttpUri::get_uri_field(string uri, http_parser_url* hp_u, http_parser_url_fields field)
+void SrsHttpUri::get_uri_field(string& v, http_parser_url* hp_u, http_parser_url_fields field)
 {
     if((hp_u->field_set & (1 << field)) == 0){
-        return "";
+        v.clear();
+        return;
     }
     
     srs_verbose("uri field matched, off=%d, len=%d, value=%.*s",
                 hp_u->field_data[field].off,
                 hp_u->field_data[field].len,
                 hp_u->field_data[field].len,
-                uri.c_str() + hp_u->field_data[field].off);
+                url.c_str() + hp_u->field_data[field].off);
     
     int offset = hp_u->field_data[field].off;
     int len = hp_u->field_data[field].len;
     
-    return uri.substr(offset, len);
+    v.assign(url, offset, len);
 }
 
 SrsHttpConn::SrsHttpConn(IConnectionManager* cm, st_netfd_t fd, ISrsHttpServeMux* m)
@@ -1245,20 +1358,16 @@ int SrsHttpConn::do_cycle()
     // @see https://github.com/ossrs/srs/issues/398
     skt.set_recv_timeout(SRS_HTTP_RECV_TIMEOUT_US);
     
+    // the message is reused for all requests of connection.
+    SrsHttpMessage* req = new SrsHttpMessage(&skt, this);
+    SrsAutoFree(SrsHttpMessage, req);
+    
     // process http messages.
     while (!disposed) {
-        ISrsHttpMessage* req = NULL;
-        
         // get a http message
-        if ((ret = parser->parse_message(&skt, this, &req)) != ERROR_SUCCESS) {
+        if ((ret = parser->parse_message(&skt, req)) != ERROR_SUCCESS) {
             return ret;
         }
-
-        // if SUCCESS, always NOT-NULL.
-        srs_assert(req);
-        
-        // always free it in this scope.
-        SrsAutoFree(ISrsHttpMessage, req);
         
         // may should discard the body.
         if ((ret = on_got_http_message(req)) != ERROR_SUCCESS) {
@@ -1271,6 +1380,16 @@ int SrsHttpConn::do_cycle()
             return ret;
         }
         
+        // read all rest bytes in request body,
+        // for the pipelined requests follow it in buffer.
+        char buf[SRS_HTTP_READ_CACHE_BYTES];
+        ISrsHttpResponseReader* br = req->body_reader();
+        while (!br->eof()) {
+            if ((ret = br->read(buf, SRS_HTTP_READ_CACHE_BYTES, NULL)) != ERROR_SUCCESS) {
+                return ret;
+            }
+        }
+        
         // donot keep alive, disconnect it.
         // @see https://github.com/ossrs/srs/issues/399
         if (!req->is_keep_alive()) {
@@ -1288,6 +1407,10 @@ int SrsHttpConn::process_request(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     srs_trace("HTTP %s %s, content-length=%"PRId64"", 
         r->method_str().c_str(), r->url().c_str(), r->content_length());
     
+#ifdef SRS_PERF_HISTOGRAM
+    int64_t starttime = srs_perf_now_us();
+#endif
+    
     // use default server mux to serve http request.
     if ((ret = http_mux->serve_http(w, r)) != ERROR_SUCCESS) {
         if (!srs_is_client_gracefully_close(ret)) {
@@ -1296,6 +1419,14 @@ int SrsHttpConn::process_request(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return ret;
     }
     
+#ifdef SRS_PERF_HISTOGRAM
+    // only the response with content-length, ignore the stream,
+    // for instance, the http flv and server-sent events.
+    if (w->header()->content_length() >= 0) {
+        srs_perf_record(SrsPerfStageHttpRequest, srs_perf_now_us() - starttime);
+    }
+#endif
+    
     return ret;
 }
 
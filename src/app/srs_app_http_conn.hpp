@@ -69,6 +69,7 @@ class SrsConnection;
 class SrsHttpMessage;
 class SrsHttpStreamServer;
 class SrsHttpStaticServer;
+class SrsPacer;
 
 // the http chunked header size,
 // for writev, there always one chunk to send it.
@@ -110,8 +111,13 @@ public:
     virtual SrsHttpHeader* header();
     virtual int write(char* data, int size);
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+    virtual int sendfile(SrsFileReader* fs, int64_t offset, int size);
     virtual void write_header(int code);
     virtual int send_header(char* data, int size);
+    /**
+     * set the pacer of socket to limit the send rate, NULL to disable.
+     */
+    virtual void set_pacer(SrsPacer* pacer);
 };
 
 /**
@@ -147,8 +153,22 @@ private:
     virtual int read_specified(char* data, int nb_data, int* nb_read);
 };
 
-// for http header.
-typedef std::pair<std::string, std::string> SrsHttpHeaderField;
+/**
+ * the slice in the http header block, by offset and size,
+ * to parse the header without copy each field to string.
+ */
+class SrsHttpSlice
+{
+public:
+    int offset;
+    int size;
+public:
+    SrsHttpSlice();
+    virtual ~SrsHttpSlice();
+};
+
+// for http header, the key and value slice in header block.
+typedef std::pair<SrsHttpSlice, SrsHttpSlice> SrsHttpHeaderSlice;
 
 // A Request represents an HTTP request received by a server
 // or to be sent by a client.
@@ -160,9 +180,9 @@ class SrsHttpMessage : public ISrsHttpMessage
 {
 private:
     /**
-     * parsed url.
+     * the uri to parse, schema://host/url, reused for each request.
      */
-    std::string _url;
+    std::string _uri_cache;
     /**
      * the extension of file, for example, .flv
      */
@@ -198,10 +218,14 @@ private:
      */
     // TODO: FIXME: remove it.
     char* _http_ts_send_buffer;
-    // http headers
-    std::vector<SrsHttpHeaderField> _headers;
-    // the query map
-    std::map<std::string, std::string> _query;
+    /**
+     * the copy of header block, all headers are slices in it,
+     * the block is reused when message reused by connection.
+     */
+    char* _header_block;
+    int _nb_header_block;
+    // http headers, swapped with parser for each request.
+    std::vector<SrsHttpHeaderSlice> _headers;
     // the transport connection, can be NULL.
     SrsConnection* conn;
     // whether request is jsonp.
@@ -214,9 +238,12 @@ public:
 public:
     /**
      * set the original messages, then update the message.
+     * @param block the header block, the url and headers are slices in it.
+     * @param headers the header slices, swapped into the message.
+     * @remark the message can be updated again to reuse it for next request.
      */
-    virtual int update(std::string url, http_parser* header,
-        SrsFastBuffer* body, std::vector<SrsHttpHeaderField>& headers
+    virtual int update(char* block, int nb_block, SrsHttpSlice url, http_parser* header,
+        SrsFastBuffer* body, std::vector<SrsHttpHeaderSlice>& headers
     );
 public:
     virtual SrsConnection* connection();
@@ -291,6 +318,12 @@ public:
     virtual std::string request_header_key_at(int index);
     virtual std::string request_header_value_at(int index);
     virtual std::string get_request_header(std::string name);
+private:
+    /**
+     * find the value slice of header in block.
+     * @return NULL if not found.
+     */
+    virtual SrsHttpSlice* header_slice(const char* name);
 public:
     /**
      * convert the http message to a request.
@@ -312,15 +345,18 @@ private:
     http_parser parser;
     // the global parse buffer.
     SrsFastBuffer* buffer;
+private:
+    // the parser type, HTTP_REQUEST or HTTP_RESPONSE.
+    enum http_parser_type type;
 private:
     // http parse data, reset before parse message.
     bool expect_field_name;
-    std::string field_name;
-    std::string field_value;
     SrsHttpParseState state;
     http_parser header;
-    std::string url;
-    std::vector<SrsHttpHeaderField> headers;
+    // the header block in buffer, the url and headers are slices in it.
+    char* block;
+    SrsHttpSlice url;
+    std::vector<SrsHttpHeaderSlice> headers;
     int header_parsed;
 public:
     SrsHttpParser();
@@ -338,6 +374,13 @@ public:
      * @remark, if success, *ppmsg always NOT-NULL, *ppmsg always is_complete().
      */
     virtual int parse_message(SrsStSocket* skt, SrsConnection* conn, ISrsHttpMessage** ppmsg);
+    /**
+     * parse a http message to the specified msg, which is reused by connection,
+     * to avoid allocating the message for each request.
+     * @remark only the header of message is consumed, the left bytes in buffer
+     *      is the body or the pipelined messages.
+     */
+    virtual int parse_message(SrsStSocket* skt, SrsHttpMessage* msg);
 private:
     /**
      * parse the HTTP message to member field: msg.
@@ -372,7 +415,7 @@ public:
     /**
      * initialize the http uri.
      */
-    virtual int initialize(std::string _url);
+    virtual int initialize(const std::string& _url);
 public:
     virtual const char* get_url();
     virtual const char* get_schema();
@@ -382,10 +425,10 @@ public:
     virtual const char* get_query();
 private:
     /**
-     * get the parsed url field.
-     * @return return empty string if not set.
+     * get the parsed url field to v, reuse the capacity of v.
+     * @remark v is cleared if not set.
      */
-    virtual std::string get_uri_field(std::string uri, http_parser_url* hp_u, http_parser_url_fields field);
+    virtual void get_uri_field(std::string& v, http_parser_url* hp_u, http_parser_url_fields field);
 };
 
 class SrsHttpConn : public SrsConnection
@@ -458,37 +458,30 @@ int SrsHttpHooks::do_post(std::string url, std::string req, int& code, string& r
         return ret;
     }
     
-    // parse string res to json.
-    SrsJsonAny* info = SrsJsonAny::loads((char*)res.c_str());
-    if (!info) {
-        ret = ERROR_HTTP_DATA_INVALID;
-        srs_error("invalid response %s. ret=%d", res.c_str(), ret);
-        return ret;
-    }
-    SrsAutoFree(SrsJsonAny, info);
+    // scan the res in place, never build the json tree.
+    SrsJsonReader info(res.data(), (int)res.length());
     
     // response error code in string.
-    if (!info->is_object()) {
+    if (!info.is_object()) {
         if (res != SRS_HTTP_RESPONSE_OK) {
             ret = ERROR_HTTP_DATA_INVALID;
-            srs_error("invalid response number %s. ret=%d", res.c_str(), ret);
+            srs_error("invalid response %s. ret=%d", res.c_str(), ret);
             return ret;
         }
         return ret;
     }
     
     // response standard object, format in json: {"code": 0, "data": ""}
-    SrsJsonObject* res_info = info->to_object();
-    SrsJsonAny* res_code = NULL;
-    if ((res_code = res_info->ensure_property_integer("code")) == NULL) {
+    int64_t res_code = 0;
+    if (!info.get_integer("code", &res_code)) {
         ret = ERROR_RESPONSE_CODE;
         srs_error("invalid response without code, ret=%d", ret);
         return ret;
     }
 
-    if ((res_code->to_integer()) != ERROR_SUCCESS) {
+    if (res_code != ERROR_SUCCESS) {
         ret = ERROR_RESPONSE_CODE;
-        srs_error("error response code=%d. ret=%d", res_code->to_integer(), ret);
+        srs_error("error response code=%"PRId64". ret=%d", res_code, ret);
         return ret;
     }
 
@@ -57,15 +57,204 @@ using namespace std;
 
 #ifdef SRS_AUTO_HTTP_SERVER
 
-SrsVodStream::SrsVodStream(string root_dir)
+SrsHttpFileBlock::SrsHttpFileBlock()
+{
+    data = NULL;
+    size = 0;
+    ino = 0;
+    mtime = 0;
+    cached = false;
+    shared_count = 0;
+}
+
+SrsHttpFileBlock::~SrsHttpFileBlock()
+{
+    srs_freepa(data);
+}
+
+SrsHttpFileCache::SrsHttpFileCache()
+{
+    budget = 0;
+    nb_bytes = 0;
+}
+
+SrsHttpFileCache::~SrsHttpFileCache()
+{
+    std::list<SrsHttpFileBlock*>::iterator it;
+    for (it = lru.begin(); it != lru.end(); ++it) {
+        SrsHttpFileBlock* block = *it;
+        srs_freep(block);
+    }
+    lru.clear();
+    blocks.clear();
+}
+
+void SrsHttpFileCache::set_budget(int64_t size)
+{
+    budget = srs_max(0, size);
+    shrink(0);
+}
+
+bool SrsHttpFileCache::enabled()
+{
+    return budget > 0;
+}
+
+int SrsHttpFileCache::fetch(string fullpath, SrsHttpFileBlock** pblock)
+{
+    int ret = ERROR_SUCCESS;
+    
+    *pblock = NULL;
+    
+    // stat the file to check whether it's rewrote,
+    // the hls muxer writes to temp file then rename, so the inode changed.
+    struct stat st;
+    bool exists = (::stat(fullpath.c_str(), &st) == 0);
+#ifdef SRS_OSX
+    int64_t mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    int64_t mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    
+    std::map<std::string, std::list<SrsHttpFileBlock*>::iterator>::iterator it = blocks.find(fullpath);
+    if (it != blocks.end()) {
+        SrsHttpFileBlock* block = *it->second;
+        
+        // hit, move to the front of lru.
+        if (exists && block->ino == (int64_t)st.st_ino && block->mtime == mtime && block->size == (int64_t)st.st_size) {
+            lru.splice(lru.begin(), lru, it->second);
+            block->shared_count++;
+            *pblock = block;
+            return ret;
+        }
+        
+        // stale, the file is rewrote or removed.
+        srs_info("http cache stale file=%s", fullpath.c_str());
+        remove(block);
+    }
+    
+    // only cache the regular file not larger than 1/4 budget.
+    if (!exists || !S_ISREG(st.st_mode) || st.st_size <= 0 || (int64_t)st.st_size > budget / 4) {
+        return ret;
+    }
+    
+    SrsFileReader fs;
+    if ((ret = fs.open(fullpath)) != ERROR_SUCCESS) {
+        srs_warn("http cache open file %s failed, ret=%d", fullpath.c_str(), ret);
+        return ret;
+    }
+    
+    int size = (int)st.st_size;
+    char* data = new char[size];
+    
+    // read all content, serve from disk when file changed during read.
+    int nb_read = 0;
+    while (nb_read < size) {
+        ssize_t nread = 0;
+        if ((ret = fs.read(data + nb_read, size - nb_read, &nread)) != ERROR_SUCCESS || nread <= 0) {
+            srs_freepa(data);
+            return ret;
+        }
+        nb_read += (int)nread;
+    }
+    
+    shrink(size);
+    
+    SrsHttpFileBlock* block = new SrsHttpFileBlock();
+    block->path = fullpath;
+    block->data = data;
+    block->size = size;
+    block->ino = (int64_t)st.st_ino;
+    block->mtime = mtime;
+    block->cached = true;
+    block->shared_count = 1;
+    
+    lru.push_front(block);
+    blocks[fullpath] = lru.begin();
+    nb_bytes += size;
+    
+    srs_info("http cache file=%s, size=%d, total=%"PRId64"", fullpath.c_str(), size, nb_bytes);
+    
+    *pblock = block;
+    return ret;
+}
+
+void SrsHttpFileCache::release(SrsHttpFileBlock* block)
+{
+    srs_assert(block->shared_count > 0);
+    block->shared_count--;
+    
+    // free the evicted block when no viewer refers to it.
+    if (!block->cached && block->shared_count == 0) {
+        srs_freep(block);
+    }
+}
+
+void SrsHttpFileCache::remove(SrsHttpFileBlock* block)
+{
+    std::map<std::string, std::list<SrsHttpFileBlock*>::iterator>::iterator it = blocks.find(block->path);
+    srs_assert(it != blocks.end());
+    
+    lru.erase(it->second);
+    blocks.erase(it);
+    nb_bytes -= block->size;
+    block->cached = false;
+    
+    // the viewers serving it will free it when release.
+    if (block->shared_count == 0) {
+        srs_freep(block);
+    }
+}
+
+void SrsHttpFileCache::shrink(int64_t required)
+{
+    // evict the least recently used blocks.
+    while (!lru.empty() && nb_bytes + required > budget) {
+        remove(lru.back());
+    }
+}
+
+SrsVodStream::SrsVodStream(string root_dir, SrsHttpFileCache* c)
     : SrsHttpFileServer(root_dir)
 {
+    cache = c;
 }
 
 SrsVodStream::~SrsVodStream()
 {
 }
 
+int SrsVodStream::serve_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, string fullpath)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsHttpFileBlock* block = NULL;
+    if (cache->enabled() && (ret = cache->fetch(fullpath, &block)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // not cacheable, serve from disk.
+    if (!block) {
+        return SrsHttpFileServer::serve_file(w, r, fullpath);
+    }
+    
+    w->header()->set_content_length(block->size);
+    w->header()->set_content_type(srs_http_mime_type(fullpath));
+    
+    // the block is kept util sent, even it's evicted when we wait for socket.
+    ret = w->write(block->data, block->size);
+    cache->release(block);
+    
+    if (ret != ERROR_SUCCESS) {
+        if (!srs_is_client_gracefully_close(ret)) {
+            srs_error("write cached file=%s failed, ret=%d", fullpath.c_str(), ret);
+        }
+        return ret;
+    }
+    
+    return w->final_request();
+}
+
 int SrsVodStream::serve_flv_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, string fullpath, int offset)
 {
     int ret = ERROR_SUCCESS;
@@ -206,16 +395,25 @@ int SrsVodStream::serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r
 SrsHttpStaticServer::SrsHttpStaticServer(SrsServer* svr)
 {
     server = svr;
+    cache = new SrsHttpFileCache();
+    
+    _srs_config->subscribe(this);
 }
 
 SrsHttpStaticServer::~SrsHttpStaticServer()
 {
+    _srs_config->unsubscribe(this);
+    
+    srs_freep(cache);
 }
 
 int SrsHttpStaticServer::initialize()
 {
     int ret = ERROR_SUCCESS;
     
+    // the hot file cache, budget in MB.
+    cache->set_budget((int64_t)_srs_config->get_http_stream_file_cache() * 1024 * 1024);
+    
     bool default_root_exists = false;
     
     // http static file and flv vod stream mount for each vhost.
@@ -247,7 +445,7 @@ int SrsHttpStaticServer::initialize()
         }
         
         // mount the http of vhost.
-        if ((ret = mux.handle(mount, new SrsVodStream(dir))) != ERROR_SUCCESS) {
+        if ((ret = mux.handle(mount, new SrsVodStream(dir, cache))) != ERROR_SUCCESS) {
             srs_error("http: mount dir=%s for vhost=%s failed. ret=%d", dir.c_str(), vhost.c_str(), ret);
             return ret;
         }
@@ -262,7 +460,7 @@ int SrsHttpStaticServer::initialize()
     if (!default_root_exists) {
         // add root
         std::string dir = _srs_config->get_http_stream_dir();
-        if ((ret = mux.handle("/", new SrsVodStream(dir))) != ERROR_SUCCESS) {
+        if ((ret = mux.handle("/", new SrsVodStream(dir, cache))) != ERROR_SUCCESS) {
             srs_error("http: mount root dir=%s failed. ret=%d", dir.c_str(), ret);
             return ret;
         }
@@ -272,6 +470,36 @@ int SrsHttpStaticServer::initialize()
     return ret;
 }
 
+int SrsHttpStaticServer::on_reload_http_stream_enabled()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // apply the new budget in MB.
+    cache->set_budget((int64_t)_srs_config->get_http_stream_file_cache() * 1024 * 1024);
+    
+    return ret;
+}
+
+int SrsHttpStaticServer::on_reload_http_stream_disabled()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // release all cached blocks, the blocks in use are freed after the last write.
+    cache->set_budget(0);
+    
+    return ret;
+}
+
+int SrsHttpStaticServer::on_reload_http_stream_updated()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // resize the cache, evict the least recently used blocks when shrink.
+    cache->set_budget((int64_t)_srs_config->get_http_stream_file_cache() * 1024 * 1024);
+    
+    return ret;
+}
+
 int SrsHttpStaticServer::on_reload_vhost_http_updated()
 {
     int ret = ERROR_SUCCESS;
@@ -30,10 +30,75 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_core.hpp>
 
+#include <list>
+#include <map>
+#include <string>
+
 #include <srs_app_http_conn.hpp>
 
 #ifdef SRS_AUTO_HTTP_SERVER
 
+/**
+ * the content of a hot file in memory, for example, the hls m3u8 and ts,
+ * which are requested by lots of viewers right after written.
+ * the block is shared by all viewers serving it, and freed when
+ * evicted from cache and no viewer refers to it.
+ */
+class SrsHttpFileBlock
+{
+public:
+    std::string path;
+    char* data;
+    int size;
+    // the stat of file when cached, the block is stale when file rewrote.
+    int64_t ino;
+    int64_t mtime;
+    // whether the block is in cache, false when evicted.
+    bool cached;
+    // the number of viewers serving the block.
+    int shared_count;
+public:
+    SrsHttpFileBlock();
+    virtual ~SrsHttpFileBlock();
+};
+
+/**
+ * the LRU cache of hot files, keyed by the path of file,
+ * the block is invalidated when the inode, size or mtime of file changed.
+ * @remark all vod streams share one cache, in the memory budget.
+ */
+class SrsHttpFileCache
+{
+private:
+    // the memory budget in bytes, 0 to disable the cache.
+    int64_t budget;
+    // the bytes of all cached blocks.
+    int64_t nb_bytes;
+    // the blocks, the front is the most recently used.
+    std::list<SrsHttpFileBlock*> lru;
+    std::map<std::string, std::list<SrsHttpFileBlock*>::iterator> blocks;
+public:
+    SrsHttpFileCache();
+    virtual ~SrsHttpFileCache();
+public:
+    /**
+     * set the memory budget in bytes, evict blocks when exceed.
+     */
+    virtual void set_budget(int64_t size);
+    virtual bool enabled();
+    /**
+     * fetch the block of file, load it from disk when miss or stale.
+     * @param pblock output the block, NULL when file is not cacheable,
+     *       for example, too large or not exists, user should serve it from disk.
+     * @remark user must release the block when served.
+     */
+    virtual int fetch(std::string fullpath, SrsHttpFileBlock** pblock);
+    virtual void release(SrsHttpFileBlock* block);
+private:
+    virtual void remove(SrsHttpFileBlock* block);
+    virtual void shrink(int64_t required);
+};
+
 /**
  * the flv vod stream supports flv?start=offset-bytes.
  * for example, http://server/file.flv?start=10240
@@ -42,10 +107,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 class SrsVodStream : public SrsHttpFileServer
 {
+private:
+    SrsHttpFileCache* cache;
 public:
-    SrsVodStream(std::string root_dir);
+    SrsVodStream(std::string root_dir, SrsHttpFileCache* c);
     virtual ~SrsVodStream();
 protected:
+    /**
+     * serve the hot file from cache, or from disk when not cacheable.
+     */
+    virtual int serve_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
     virtual int serve_flv_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int offset);
     virtual int serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int start, int end);
 };
@@ -58,6 +129,8 @@ class SrsHttpStaticServer : virtual public ISrsReloadHandler
 {
 private:
     SrsServer* server;
+    // the hot file cache for all vod streams.
+    SrsHttpFileCache* cache;
 public:
     SrsHttpServeMux mux;
 public:
@@ -67,6 +140,9 @@ public:
     virtual int initialize();
 // interface ISrsReloadHandler.
 public:
+    virtual int on_reload_http_stream_enabled();
+    virtual int on_reload_http_stream_disabled();
+    virtual int on_reload_http_stream_updated();
     virtual int on_reload_vhost_http_updated();
 };
 
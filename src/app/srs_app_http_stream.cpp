@@ -51,11 +51,14 @@ using namespace std;
 #include <srs_kernel_aac.hpp>
 #include <srs_kernel_mp3.hpp>
 #include <srs_kernel_ts.hpp>
+#include <srs_kernel_buffer.hpp>
 #include <srs_app_pithy_print.hpp>
 #include <srs_app_source.hpp>
 #include <srs_app_server.hpp>
 #include <srs_app_recv_thread.hpp>
 #include <srs_app_http_hooks.hpp>
+#include <srs_app_pacer.hpp>
+#include <srs_app_event_log.hpp>
 
 #endif
 
@@ -191,38 +194,40 @@ ISrsStreamEncoder::~ISrsStreamEncoder()
 
 SrsTsStreamEncoder::SrsTsStreamEncoder()
 {
-    enc = new SrsTsEncoder();
+    writer = NULL;
+    nb_iovss_cache = 0;
+    iovss_cache = NULL;
 }
 
 SrsTsStreamEncoder::~SrsTsStreamEncoder()
 {
-    srs_freep(enc);
+    srs_freepa(iovss_cache);
 }
 
 int SrsTsStreamEncoder::initialize(SrsFileWriter* w, SrsStreamCache* /*c*/)
 {
     int ret = ERROR_SUCCESS;
     
-    if ((ret = enc->initialize(w)) != ERROR_SUCCESS) {
-        return ret;
-    }
+    srs_assert(w);
+    writer = w;
     
     return ret;
 }
 
-int SrsTsStreamEncoder::write_audio(int64_t timestamp, char* data, int size)
+int SrsTsStreamEncoder::write_audio(int64_t /*timestamp*/, char* data, int size)
 {
-    return enc->write_audio(timestamp, data, size);
+    return writer->write(data, size, NULL);
 }
 
-int SrsTsStreamEncoder::write_video(int64_t timestamp, char* data, int size)
+int SrsTsStreamEncoder::write_video(int64_t /*timestamp*/, char* data, int size)
 {
-    return enc->write_video(timestamp, data, size);
+    return writer->write(data, size, NULL);
 }
 
-int SrsTsStreamEncoder::write_metadata(int64_t /*timestamp*/, char* /*data*/, int /*size*/)
+int SrsTsStreamEncoder::write_metadata(int64_t /*timestamp*/, char* data, int size)
 {
-    return ERROR_SUCCESS;
+    // the PAT/PMT block.
+    return writer->write(data, size, NULL);
 }
 
 bool SrsTsStreamEncoder::has_cache()
@@ -237,6 +242,36 @@ int SrsTsStreamEncoder::dump_cache(SrsConsumer* /*consumer*/, SrsRtmpJitterAlgor
     return ERROR_SUCCESS;
 }
 
+int SrsTsStreamEncoder::write_blocks(SrsSharedPtrMessage** msgs, int count)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // realloc the iovss.
+    iovec* iovs = iovss_cache;
+    if (nb_iovss_cache < count) {
+        srs_freepa(iovss_cache);
+        
+        nb_iovss_cache = count;
+        iovs = iovss_cache = new iovec[count];
+    }
+    
+    // the blocks are 188 bytes aligned ts packets, write directly.
+    for (int i = 0; i < count; i++) {
+        SrsSharedPtrMessage* msg = msgs[i];
+        iovs[i].iov_base = msg->payload;
+        iovs[i].iov_len = msg->size;
+    }
+    
+    if ((ret = writer->writev(iovs, count, NULL)) != ERROR_SUCCESS) {
+        if (!srs_is_client_gracefully_close(ret)) {
+            srs_error("write ts blocks failed. ret=%d", ret);
+        }
+        return ret;
+    }
+    
+    return ret;
+}
+
 SrsFlvStreamEncoder::SrsFlvStreamEncoder()
 {
     enc = new SrsFlvEncoder();
@@ -416,10 +451,12 @@ int SrsMp3StreamEncoder::dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorith
 SrsStreamWriter::SrsStreamWriter(ISrsHttpResponseWriter* w)
 {
     writer = w;
+    merged = new SrsSimpleBuffer();
 }
 
 SrsStreamWriter::~SrsStreamWriter()
 {
+    srs_freep(merged);
 }
 
 int SrsStreamWriter::open(std::string /*file*/)
@@ -443,17 +480,50 @@ int64_t SrsStreamWriter::tellg()
 
 int SrsStreamWriter::write(void* buf, size_t count, ssize_t* pnwrite)
 {
+    int ret = ERROR_SUCCESS;
+    
     if (pnwrite) {
         *pnwrite = count;
     }
-    return writer->write((char*)buf, (int)count);
+    
+    // copy to merged buffer, for the buf is reused by encoder.
+    if (count > 0) {
+        merged->append((char*)buf, (int)count);
+    }
+    
+    if (merged->length() >= SRS_HTTP_STREAM_MERGED_BYTES) {
+        return flush();
+    }
+    
+    return ret;
 }
 
 int SrsStreamWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
 {
+    int ret = ERROR_SUCCESS;
+    
+    // keep the order of bytes, send the merged first.
+    if ((ret = flush()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
     return writer->writev(iov, iovcnt, pnwrite);
 }
 
+int SrsStreamWriter::flush()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (merged->length() <= 0) {
+        return ret;
+    }
+    
+    ret = writer->write(merged->bytes(), merged->length());
+    merged->erase(merged->length());
+    
+    return ret;
+}
+
 SrsLiveStream::SrsLiveStream(SrsSource* s, SrsRequest* r, SrsStreamCache* c)
 {
     source = s;
@@ -486,14 +556,26 @@ int SrsLiveStream::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         return ret;
     }
     
-    ret = do_serve_http(w, r);
+    SrsEventLog::instance()->on_event(SrsLogEventPlay, _srs_context->get_id(), req, NULL, 0, ret);
+    int64_t starttime = srs_get_system_time_ms();
+    
+    // the pacer for fast start, reset it when serve done.
+    SrsPacer pacer;
+    ret = do_serve_http(w, r, &pacer);
+    
+    SrsHttpResponseWriter* hw = dynamic_cast<SrsHttpResponseWriter*>(w);
+    if (hw) {
+        hw->set_pacer(NULL);
+    }
     
     http_hooks_on_stop();
+    SrsEventLog::instance()->on_event(SrsLogEventStop, _srs_context->get_id(), req, NULL,
+        srs_get_system_time_ms() - starttime, ret);
     
     return ret;
 }
 
-int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
+int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, SrsPacer* pacer)
 {
     int ret = ERROR_SUCCESS;
     
@@ -528,9 +610,18 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     }
     SrsAutoFree(ISrsStreamEncoder, enc);
     
+    SrsTsStreamEncoder* tse = dynamic_cast<SrsTsStreamEncoder*>(enc);
+    
     // create consumer of souce, ignore gop cache, use the audio gop cache.
+    // for ts, consume the ts blocks of the shared remuxer.
     SrsConsumer* consumer = NULL;
-    if ((ret = source->create_consumer(NULL, consumer, true, true, !enc->has_cache())) != ERROR_SUCCESS) {
+    if (tse) {
+        ret = source->create_ts_consumer(NULL, consumer);
+    } else {
+        ret = source->create_consumer(NULL, consumer, true, true, !enc->has_cache());
+    }
+    if (ret != ERROR_SUCCESS) {
+        srs_freep(consumer);
         srs_error("http: create consumer failed. ret=%d", ret);
         return ret;
     }
@@ -557,6 +648,20 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         }
     }
     
+    // limit the send rate of the dumped gop cache, for the burst of players.
+    double burst = _srs_config->get_fast_start_burst(req->vhost);
+    SrsHttpResponseWriter* hw = dynamic_cast<SrsHttpResponseWriter*>(w);
+    if (burst > 0 && hw) {
+        int kbps = (int)(consumer->queue_kbps() * _srs_config->get_fast_start_rate(req->vhost));
+        pacer->start(kbps, burst);
+        hw->set_pacer(pacer);
+    }
+    
+    // send the stream header, for instance, the flv header.
+    if ((ret = writer.flush()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
 #ifdef SRS_PERF_FAST_FLV_ENCODER
     SrsFastFlvStreamEncoder* ffe = dynamic_cast<SrsFastFlvStreamEncoder*>(enc);
 #endif
@@ -567,8 +672,9 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
     SrsResponseOnlyHttpConn* hc = dynamic_cast<SrsResponseOnlyHttpConn*>(hr->connection());
     
     int mw_sleep = _srs_config->get_mw_sleep_ms(req->vhost);
+    bool realtime = _srs_config->get_realtime_enabled(req->vhost);
     
-    SrsHttpRecvThread* trd = new SrsHttpRecvThread(hc);
+    SrsHttpRecvThread* trd = new SrsHttpRecvThread(hc, consumer);
     SrsAutoFree(SrsHttpRecvThread, trd);
     
     if ((ret = trd->start()) != ERROR_SUCCESS) {
@@ -585,6 +691,9 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             return ret;
         }
 
+        // wait for message to incoming, the same as rtmp players.
+        consumer->wait_mw(realtime, mw_sleep);
+        
         // get messages from consumer.
         // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
         int count = 0;
@@ -593,12 +702,9 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
             return ret;
         }
         
+        // the wait maybe wakeup by client closed or stream unmounted.
         if (count <= 0) {
-            srs_info("http: sleep %dms for no msg", SRS_CONSTS_RTMP_PULSE_TIMEOUT_US);
-            // directly use sleep, donot use consumer wait.
-            st_usleep(mw_sleep * 1000);
-            
-            // ignore when nothing got.
+            srs_verbose("http: mw wait %dms and got nothing.", mw_sleep);
             continue;
         }
 
@@ -608,15 +714,24 @@ int SrsLiveStream::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
         }
         
         // sendout all messages.
-#ifdef SRS_PERF_FAST_FLV_ENCODER
-        if (ffe) {
-            ret = ffe->write_tags(msgs.msgs, count);
+        if (tse) {
+            ret = tse->write_blocks(msgs.msgs, count);
         } else {
-            ret = streaming_send_messages(enc, msgs.msgs, count);
-        }
+#ifdef SRS_PERF_FAST_FLV_ENCODER
+            if (ffe) {
+                ret = ffe->write_tags(msgs.msgs, count);
+            } else {
+                ret = streaming_send_messages(enc, msgs.msgs, count);
+            }
 #else
-        ret = streaming_send_messages(enc, msgs.msgs, count);
+            ret = streaming_send_messages(enc, msgs.msgs, count);
 #endif
+        }
+        
+        // sendout the merged bytes in one chunk.
+        if (ret == ERROR_SUCCESS) {
+            ret = writer.flush();
+        }
     
         // free the messages.
         for (int i = 0; i < count; i++) {
@@ -34,6 +34,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #ifdef SRS_AUTO_HTTP_SERVER
 
+class SrsSimpleBuffer;
+class SrsPacer;
+
+// the max bytes to merge the small writes of stream encoder,
+// flush when exceed, to bound the memory and latency.
+#define SRS_HTTP_STREAM_MERGED_BYTES 65536
+
 /**
 * for the srs http stream cache, 
 * for example, the audio stream cache to make android(weixin) happy.
@@ -133,12 +140,18 @@ public:
 #endif
 
 /**
-* the ts stream encoder, remux rtmp stream to ts stream.
+* the ts stream encoder, write the ts blocks to client.
+* the rtmp stream is remuxed to ts blocks once by the SrsTsRemuxer of source,
+* so the encoder only write the shared blocks, never remux for each client.
 */
 class SrsTsStreamEncoder : public ISrsStreamEncoder
 {
 private:
-    SrsTsEncoder* enc;
+    SrsFileWriter* writer;
+private:
+    // the cache for writev.
+    int nb_iovss_cache;
+    iovec* iovss_cache;
 public:
     SrsTsStreamEncoder();
     virtual ~SrsTsStreamEncoder();
@@ -150,6 +163,11 @@ public:
 public:
     virtual bool has_cache();
     virtual int dump_cache(SrsConsumer* consumer, SrsRtmpJitterAlgorithm jitter);
+public:
+    /**
+    * write the ts blocks in a time.
+    */
+    virtual int write_blocks(SrsSharedPtrMessage** msgs, int count);
 };
 
 /**
@@ -196,11 +214,16 @@ public:
 
 /**
 * write stream to http response direclty.
+* the small writes, for instance, the adts header and raw data of each aac frame,
+* are merged in buffer and sent in one chunk when flush,
+* that is, one chunk and one writev for each merged-write(mw_sleep) interval.
 */
 class SrsStreamWriter : public SrsFileWriter
 {
 private:
     ISrsHttpResponseWriter* writer;
+    // the merged bytes to send.
+    SrsSimpleBuffer* merged;
 public:
     SrsStreamWriter(ISrsHttpResponseWriter* w);
     virtual ~SrsStreamWriter();
@@ -213,6 +236,11 @@ public:
 public:
     virtual int write(void* buf, size_t count, ssize_t* pnwrite);
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+public:
+    /**
+     * send all merged bytes in one chunk.
+     */
+    virtual int flush();
 };
 
 /**
@@ -232,7 +260,7 @@ public:
 public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
 private:
-    virtual int do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
+    virtual int do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, SrsPacer* pacer);
     virtual int http_hooks_on_play();
     virtual void http_hooks_on_stop();
     virtual int streaming_send_messages(ISrsStreamEncoder* enc, SrsSharedPtrMessage** msgs, int nb_msgs);
@@ -30,12 +30,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
 using namespace std;
 
 #include <srs_kernel_log.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_app_server.hpp>
 #include <srs_app_utility.hpp>
+#include <srs_app_statistic.hpp>
+#include <srs_core_performance.hpp>
 
 // set the max packet size.
 #define SRS_UDP_MAX_PACKET_SIZE 65535
@@ -276,6 +280,55 @@ int SrsTcpListener::cycle()
 {
     int ret = ERROR_SUCCESS;
     
+#ifdef SRS_PERF_BATCH_ACCEPT
+    // wait for the listen fd readable, then accept all pending clients.
+    if (st_netfd_poll(_stfd, POLLIN, ST_UTIME_NO_TIMEOUT) != 0) {
+        // ignore error.
+        if (errno != EINTR) {
+            srs_error("ignore accept thread stoppped for poll listen fd error");
+        }
+        return ret;
+    }
+    
+    int nb_clients = 0;
+    while (nb_clients < SRS_PERF_BATCH_ACCEPT_MAX) {
+        // the client fd is nonblocking, which is required by st.
+        int client_fd = ::accept4(_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // for EAGAIN, no more clients; others, ignore and retry in next loop.
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                srs_warn("ignore accept client error, errno=%d", errno);
+            }
+            break;
+        }
+        
+        st_netfd_t client_stfd = st_netfd_open_socket(client_fd);
+        if (client_stfd == NULL) {
+            ::close(client_fd);
+            srs_warn("ignore open client socket failed, fd=%d", client_fd);
+            continue;
+        }
+        nb_clients++;
+        srs_verbose("get a client. fd=%d", client_fd);
+        
+        //回调SrsStreamListener的on_tcp_client
+        if ((ret = handler->on_tcp_client(client_stfd)) != ERROR_SUCCESS) {
+            srs_warn("accept client error. ret=%d", ret);
+            break;
+        }
+    }
+    
+    SrsStatistic::instance()->on_accept(nb_clients);
+    
+    // the batch is full, maybe more pending clients,
+    // yield to other threads and accept them in next loop.
+    if (nb_clients >= SRS_PERF_BATCH_ACCEPT_MAX) {
+        st_usleep(0);
+    }
+#else
     st_netfd_t client_stfd = st_accept(_stfd, NULL, NULL, ST_UTIME_NO_TIMEOUT);
     
     if(client_stfd == NULL){
@@ -286,11 +339,15 @@ int SrsTcpListener::cycle()
         return ret;
     }
     srs_verbose("get a client. fd=%d", st_netfd_fileno(client_stfd));
+    
+    SrsStatistic::instance()->on_accept(1);
+    
     //回调SrsStreamListener的on_tcp_client
     if ((ret = handler->on_tcp_client(client_stfd)) != ERROR_SUCCESS) {
         srs_warn("accept client error. ret=%d", ret);
         return ret;
     }
+#endif
     
     return ret;
 }
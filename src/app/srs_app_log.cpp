@@ -29,6 +29,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
 
 #include <srs_app_config.hpp>
 #include <srs_kernel_error.hpp>
@@ -88,6 +93,290 @@ void SrsThreadContext::clear_cid()
 // reserved for the end of log data, it must be strlen(LOG_TAIL)
 #define LOG_TAIL_SIZE 1
 
+// the min and max size of async log ring.
+#define SRS_LOG_ASYNC_MIN_SIZE 65536
+#define SRS_LOG_ASYNC_MAX_SIZE 0x40000000
+// the interval in us for async writer to drain the ring.
+#define SRS_LOG_ASYNC_INTERVAL_US 10000
+// the interval in us for st thread to wait for ring when block.
+#define SRS_LOG_ASYNC_BLOCK_US 1000
+// the max started writers, the server log and event log.
+#define SRS_LOG_ASYNC_MAX_WRITERS 4
+
+// the started writers, stopped at exit or abort to drain the logs.
+static SrsAsyncLogWriter* _srs_async_writers[SRS_LOG_ASYNC_MAX_WRITERS];
+static bool _srs_async_hooked = false;
+
+SrsAsyncLogWriter::SrsAsyncLogWriter()
+{
+    buf = NULL;
+    size = 0;
+    head = tail = 0;
+    
+    fd = -1;
+    pending_fd = -1;
+    
+    block = false;
+    nb_dropped = 0;
+    nb_failed_bytes = 0;
+    failed_errno = 0;
+    
+    started = false;
+    stopping = false;
+}
+
+SrsAsyncLogWriter::~SrsAsyncLogWriter()
+{
+    stop();
+    
+    if (fd > 0) {
+        ::close(fd);
+    }
+    if (pending_fd > 0) {
+        ::close(pending_fd);
+    }
+    
+    srs_freepa(buf);
+}
+
+int SrsAsyncLogWriter::start(int64_t ring_size, bool b)
+{
+    int ret = ERROR_SUCCESS;
+    
+    block = b;
+    
+    // round up to power of 2, for the position is masked.
+    size = SRS_LOG_ASYNC_MIN_SIZE;
+    while ((int64_t)size < ring_size && size < SRS_LOG_ASYNC_MAX_SIZE) {
+        size <<= 1;
+    }
+    buf = new char[size];
+    
+    if (pthread_create(&tid, NULL, writer_thread, this) != 0) {
+        ret = ERROR_SYSTEM_CREATE_THREAD;
+        return ret;
+    }
+    started = true;
+    
+    // register to drain the logs when exit or abort.
+    for (int i = 0; i < SRS_LOG_ASYNC_MAX_WRITERS; i++) {
+        if (!_srs_async_writers[i]) {
+            _srs_async_writers[i] = this;
+            break;
+        }
+    }
+    if (!_srs_async_hooked) {
+        _srs_async_hooked = true;
+        ::atexit(stop_all);
+        ::signal(SIGABRT, on_abort);
+    }
+    
+    return ret;
+}
+
+void SrsAsyncLogWriter::stop()
+{
+    if (!started) {
+        return;
+    }
+    
+    stopping = true;
+    pthread_join(tid, NULL);
+    started = false;
+    
+    for (int i = 0; i < SRS_LOG_ASYNC_MAX_WRITERS; i++) {
+        if (_srs_async_writers[i] == this) {
+            _srs_async_writers[i] = NULL;
+        }
+    }
+}
+
+void SrsAsyncLogWriter::stop_all()
+{
+    for (int i = 0; i < SRS_LOG_ASYNC_MAX_WRITERS; i++) {
+        SrsAsyncLogWriter* writer = _srs_async_writers[i];
+        if (writer) {
+            writer->stop();
+        }
+    }
+}
+
+void SrsAsyncLogWriter::on_abort(int signo)
+{
+    // drain the logs before crash, the abort will raise again
+    // with the default action when the handler return.
+    stop_all();
+    ::signal(signo, SIG_DFL);
+}
+
+void SrsAsyncLogWriter::reopen(int log_fd)
+{
+    int old_fd = __sync_lock_test_and_set(&pending_fd, log_fd);
+    
+    // the writer thread never got the old one, close it.
+    if (old_fd > 0) {
+        ::close(old_fd);
+    }
+}
+
+bool SrsAsyncLogWriter::write(const char* data, int nb_data)
+{
+    // report the dropped logs when ring is available.
+    if (nb_dropped > 0) {
+        char note[64];
+        int nb_note = snprintf(note, sizeof(note), "[async log dropped %d logs]\n", nb_dropped);
+        if (enqueue(note, nb_note)) {
+            nb_dropped = 0;
+        }
+    }
+    
+    // report the logs failed to write by writer thread.
+    if (nb_failed_bytes > 0) {
+        int nb_failed = __sync_lock_test_and_set(&nb_failed_bytes, 0);
+        char note[96];
+        int nb_note = snprintf(note, sizeof(note), "[async log write failed, dropped %d bytes, errno=%d]\n", 
+            nb_failed, failed_errno);
+        if (!enqueue(note, nb_note)) {
+            __sync_fetch_and_add(&nb_failed_bytes, nb_failed);
+        }
+    }
+    
+    // the log larger than ring, never write it.
+    if (nb_data > (int)size) {
+        nb_dropped++;
+        return false;
+    }
+    
+    if (enqueue(data, nb_data)) {
+        return true;
+    }
+    
+    if (!block) {
+        nb_dropped++;
+        return false;
+    }
+    
+    // block the whole server, wait for the writer to drain the ring.
+    while (!enqueue(data, nb_data)) {
+        ::usleep(SRS_LOG_ASYNC_BLOCK_US);
+    }
+    
+    return true;
+}
+
+bool SrsAsyncLogWriter::enqueue(const char* data, int nb_data)
+{
+    uint32_t h = head;
+    uint32_t t = tail;
+    __sync_synchronize();
+    
+    // no space in ring.
+    if (size - (h - t) < (uint32_t)nb_data) {
+        return false;
+    }
+    
+    // copy to ring, maybe wrap to the begin.
+    uint32_t pos = h & (size - 1);
+    uint32_t nb_first = srs_min((uint32_t)nb_data, size - pos);
+    memcpy(buf + pos, data, nb_first);
+    memcpy(buf, data + nb_first, nb_data - nb_first);
+    
+    // publish the data to writer thread.
+    __sync_synchronize();
+    head = h + nb_data;
+    
+    return true;
+}
+
+void* SrsAsyncLogWriter::writer_thread(void* arg)
+{
+    SrsAsyncLogWriter* writer = (SrsAsyncLogWriter*)arg;
+    
+    while (true) {
+        // drain the ring once more when stopping.
+        bool quit = writer->stopping;
+        writer->drain();
+        
+        if (quit) {
+            break;
+        }
+        
+        ::usleep(SRS_LOG_ASYNC_INTERVAL_US);
+    }
+    
+    return NULL;
+}
+
+void SrsAsyncLogWriter::drain()
+{
+    // switch to the new log file, for example, reload.
+    int new_fd = __sync_lock_test_and_set(&pending_fd, -1);
+    if (new_fd > 0) {
+        if (fd > 0) {
+            ::close(fd);
+        }
+        fd = new_fd;
+    }
+    
+    uint32_t t = tail;
+    uint32_t h = head;
+    __sync_synchronize();
+    
+    if (h == t) {
+        return;
+    }
+    
+    // write all logs in ring by writev.
+    uint32_t pos = t & (size - 1);
+    uint32_t nb_data = h - t;
+    uint32_t nb_first = srs_min(nb_data, size - pos);
+    
+    iovec iovs[2];
+    iovs[0].iov_base = buf + pos;
+    iovs[0].iov_len = nb_first;
+    iovs[1].iov_base = buf;
+    iovs[1].iov_len = nb_data - nb_first;
+    
+    // the writev maybe partial, write the left util all written.
+    iovec* iov = iovs;
+    int iovcnt = (nb_data > nb_first)? 2 : 1;
+    while (fd > 0 && iovcnt > 0) {
+        ssize_t nwrite = ::writev(fd, iov, iovcnt);
+        
+        if (nwrite < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            // the logs are dropped, for the log file is unavailable,
+            // the st thread must not be blocked by the writer,
+            // the dropped bytes are reported by st thread.
+            int nb_left = 0;
+            for (int i = 0; i < iovcnt; i++) {
+                nb_left += (int)iov[i].iov_len;
+            }
+            failed_errno = errno;
+            __sync_fetch_and_add(&nb_failed_bytes, nb_left);
+            break;
+        }
+        
+        // skip the written iovs.
+        while (iovcnt > 0 && nwrite >= (ssize_t)iov->iov_len) {
+            nwrite -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + nwrite;
+            iov->iov_len -= nwrite;
+        }
+    }
+    
+    // release the space to st thread.
+    __sync_synchronize();
+    tail = h;
+}
+
 SrsFastLog::SrsFastLog()
 {
     _level = SrsLogLevel::Trace;
@@ -96,12 +385,22 @@ SrsFastLog::SrsFastLog()
     fd = -1;
     log_to_file_tank = false;
     utc = false;
+    
+    cache_second = -1;
+    cache_pid = 0;
+    writer = NULL;
 }
 
 SrsFastLog::~SrsFastLog()
 {
     srs_freepa(log_data);
 
+    // the fd is closed by async writer.
+    if (writer) {
+        srs_freep(writer);
+        fd = -1;
+    }
+    
     if (fd > 0) {
         ::close(fd);
         fd = -1;
@@ -127,6 +426,37 @@ int SrsFastLog::initialize()
     return ret;
 }
 
+int SrsFastLog::start()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // refresh the cached pid, which is changed by fork.
+    cache_second = -1;
+    
+    if (!_srs_config || !log_to_file_tank || !_srs_config->get_log_async()) {
+        return ret;
+    }
+    
+    // the size in MB is checked by config, compute in int64 to avoid overflow.
+    int64_t ring_size = (int64_t)_srs_config->get_log_async_size() * 1024 * 1024;
+    
+    writer = new SrsAsyncLogWriter();
+    if ((ret = writer->start(ring_size, _srs_config->get_log_async_block())) != ERROR_SUCCESS) {
+        srs_freep(writer);
+        srs_error("start async log writer failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // the opened log file is used by async writer.
+    if (fd > 0) {
+        writer->reopen(fd);
+    }
+    srs_trace("async log started, size=%dMB, block=%d", 
+        _srs_config->get_log_async_size(), _srs_config->get_log_async_block());
+    
+    return ret;
+}
+
 void SrsFastLog::verbose(const char* tag, int context_id, const char* fmt, ...)
 {
     if (_level > SrsLogLevel::Verbose) {
@@ -235,6 +565,7 @@ void SrsFastLog::error(const char* tag, int context_id, const char* fmt, ...)
 int SrsFastLog::on_reload_utc_time()
 {
     utc = _srs_config->get_utc_time();
+    cache_second = -1;
     
     return ERROR_SUCCESS;
 }
@@ -258,7 +589,8 @@ int SrsFastLog::on_reload_log_tank()
         return ret;
     }
 
-    if (fd > 0) {
+    // the async writer close the old fd when got the new one.
+    if (fd > 0 && !writer) {
         ::close(fd);
     }
     open_log_file();
@@ -291,7 +623,8 @@ int SrsFastLog::on_reload_log_file()
         return ret;
     }
 
-    if (fd > 0) {
+    // the async writer close the old fd when got the new one.
+    if (fd > 0 && !writer) {
         ::close(fd);
     }
     open_log_file();
@@ -307,16 +640,23 @@ bool SrsFastLog::generate_header(bool error, const char* tag, int context_id, co
         return false;
     }
     
-    // to calendar time
-    struct tm* tm;
-    if (utc) {
-        if ((tm = gmtime(&tv.tv_sec)) == NULL) {
-            return false;
-        }
-    } else {
-        if ((tm = localtime(&tv.tv_sec)) == NULL) {
-            return false;
+    // to calendar time, cache it for a second.
+    if (tv.tv_sec != cache_second) {
+        struct tm* tm;
+        if (utc) {
+            if ((tm = gmtime(&tv.tv_sec)) == NULL) {
+                return false;
+            }
+        } else {
+            if ((tm = localtime(&tv.tv_sec)) == NULL) {
+                return false;
+            }
         }
+        
+        snprintf(cache_time, sizeof(cache_time), "%d-%02d-%02d %02d:%02d:%02d",
+            1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec);
+        cache_second = tv.tv_sec;
+        cache_pid = getpid();
     }
     
     // write log header
@@ -325,26 +665,26 @@ bool SrsFastLog::generate_header(bool error, const char* tag, int context_id, co
     if (error) {
         if (tag) {
             log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%s][%d][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, tag, getpid(), context_id, errno);
+                "[%s.%03d][%s][%s][%d][%d][%d] ", 
+                cache_time, (int)(tv.tv_usec / 1000), 
+                level_name, tag, cache_pid, context_id, errno);
         } else {
             log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%d][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, getpid(), context_id, errno);
+                "[%s.%03d][%s][%d][%d][%d] ", 
+                cache_time, (int)(tv.tv_usec / 1000), 
+                level_name, cache_pid, context_id, errno);
         }
     } else {
         if (tag) {
             log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%s][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, tag, getpid(), context_id);
+                "[%s.%03d][%s][%s][%d][%d] ", 
+                cache_time, (int)(tv.tv_usec / 1000), 
+                level_name, tag, cache_pid, context_id);
         } else {
             log_header_size = snprintf(log_data, LOG_MAX_SIZE, 
-                "[%d-%02d-%02d %02d:%02d:%02d.%03d][%s][%d][%d] ", 
-                1900 + tm->tm_year, 1 + tm->tm_mon, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(tv.tv_usec / 1000), 
-                level_name, getpid(), context_id);
+                "[%s.%03d][%s][%d][%d] ", 
+                cache_time, (int)(tv.tv_usec / 1000), 
+                level_name, cache_pid, context_id);
         }
     }
 
@@ -392,9 +732,13 @@ void SrsFastLog::write_log(int& fd, char *str_log, int size, int level)
         open_log_file();
     }
     
-    // write log to file.
+    // write log to file, by async writer if enabled.
     if (fd > 0) {
-        ::write(fd, str_log, size);
+        if (writer) {
+            writer->write(str_log, size);
+        } else {
+            ::write(fd, str_log, size);
+        }
     }
 }
 
@@ -418,5 +762,10 @@ void SrsFastLog::open_log_file()
             S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH
         );
     }
+    
+    // the async writer takes the fd.
+    if (fd > 0 && writer) {
+        writer->reopen(fd);
+    }
 }
 
@@ -35,6 +35,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_reload.hpp>
 
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 
 #include <string>
 #include <map>
@@ -59,6 +61,73 @@ public:
     virtual void clear_cid(); //清除
 };
 
+/**
+* the async log writer, the st thread writes the log lines to a lock-free
+* ring, which is drained to the log file by a dedicated os thread by writev.
+* @remark the ring is single producer(the st thread) and single consumer.
+*/
+class SrsAsyncLogWriter
+{
+private:
+    // the ring buffer, size is power of 2.
+    char* buf;
+    uint32_t size;
+    // the write and read position, never wrap to the ring size.
+    volatile uint32_t head;
+    volatile uint32_t tail;
+private:
+    // the log file, used by the writer thread.
+    int fd;
+    // the new log file to use, swapped by reopen.
+    volatile int pending_fd;
+private:
+    // whether block when ring is full, otherwise drop the log.
+    bool block;
+    // the number of dropped logs, which is not reported yet.
+    int nb_dropped;
+    // the bytes dropped by writer thread for write failed, not reported yet.
+    volatile int nb_failed_bytes;
+    // the errno of last failed write.
+    volatile int failed_errno;
+private:
+    pthread_t tid;
+    bool started;
+    volatile bool stopping;
+public:
+    SrsAsyncLogWriter();
+    virtual ~SrsAsyncLogWriter();
+public:
+    /**
+    * start the writer thread.
+    * @param ring_size the size in bytes of ring, round up to power of 2.
+    * @param block whether block when ring is full, otherwise drop the log.
+    */
+    virtual int start(int64_t ring_size, bool block);
+    /**
+    * drain all logs to file and stop the writer thread.
+    */
+    virtual void stop();
+    /**
+    * use the new log file, the old one is closed by writer thread.
+    */
+    virtual void reopen(int log_fd);
+    /**
+    * write a log line to ring.
+    * @return false if the log is dropped.
+    */
+    virtual bool write(const char* data, int nb_data);
+    /**
+    * stop all started writers, to drain the logs when process exit or abort,
+    * for example, exit() by signal or the srs_assert failed.
+    */
+    static void stop_all();
+private:
+    static void on_abort(int signo);
+    virtual bool enqueue(const char* data, int nb_data);
+    static void* writer_thread(void* arg);
+    virtual void drain();
+};
+
 /**
 * we use memory/disk cache and donot flush when write log.
 * it's ok to use it without config, which will log to console, and default trace level.
@@ -78,11 +147,25 @@ private:
     bool log_to_file_tank;
     // whether use utc time.
     bool utc;
+private:
+    // the time cache of second, to avoid localtime for each log.
+    time_t cache_second;
+    // large enough for the int fields of tm, to avoid format truncation.
+    char cache_time[80];
+    // the pid cache, refresh with the time cache.
+    int cache_pid;
+    // the async writer, NULL to write the log file directly.
+    SrsAsyncLogWriter* writer;
 public:
     SrsFastLog();
     virtual ~SrsFastLog();
 public:
     virtual int initialize();
+    /**
+    * start the async writer when configured,
+    * @remark must start after daemon forked, for the os thread is not forked.
+    */
+    virtual int start();
     virtual void verbose(const char* tag, int context_id, const char* fmt, ...);
     virtual void info(const char* tag, int context_id, const char* fmt, ...);
     virtual void trace(const char* tag, int context_id, const char* fmt, ...);
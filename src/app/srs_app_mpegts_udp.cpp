@@ -130,6 +130,7 @@ SrsMpegtsOverUdp::SrsMpegtsOverUdp(SrsConfDirective* c)
     context = new SrsTsContext();
     buffer = new SrsSimpleBuffer();
     output = _srs_config->get_stream_caster_output(c);
+    peer_addr = INADDR_NONE;
     
     req = NULL;
     io = NULL;
@@ -161,8 +162,18 @@ SrsMpegtsOverUdp::~SrsMpegtsOverUdp()
 
 int SrsMpegtsOverUdp::on_udp_packet(sockaddr_in* from, char* buf, int nb_buf)
 {
-    std::string peer_ip = inet_ntoa(from->sin_addr);
+    if (peer_ip.empty() || peer_addr != from->sin_addr.s_addr) {
+        peer_addr = from->sin_addr.s_addr;
+        peer_ip = inet_ntoa(from->sin_addr);
+    }
     int peer_port = ntohs(from->sin_port);
+    
+    // for the datagram of aligned ts packets, which is the most common case,
+    // parse the ts packets in place, never copy to buffer.
+    if (buffer->length() == 0 && nb_buf > 0 && (nb_buf % SRS_TS_PACKET_SIZE) == 0 && buf[0] == 0x47) {
+        srs_info("udp: got %s:%d packet %d bytes, parse in place", peer_ip.c_str(), peer_port, nb_buf);
+        return on_ts_packets(buf, nb_buf / SRS_TS_PACKET_SIZE);
+    }
 
     // append to buffer.
     buffer->append(buf, nb_buf);
@@ -173,7 +184,7 @@ int SrsMpegtsOverUdp::on_udp_packet(sockaddr_in* from, char* buf, int nb_buf)
     return on_udp_bytes(peer_ip, peer_port, buf, nb_buf);
 }
 
-int SrsMpegtsOverUdp::on_udp_bytes(string host, int port, char* buf, int nb_buf)
+int SrsMpegtsOverUdp::on_udp_bytes(const string& host, int port, char* buf, int nb_buf)
 {
     int ret = ERROR_SUCCESS;
 
@@ -228,8 +239,24 @@ int SrsMpegtsOverUdp::on_udp_bytes(string host, int port, char* buf, int nb_buf)
 
     // use stream to parse ts packet.
     int nb_packet =  buffer->length() / SRS_TS_PACKET_SIZE;
+    if ((ret = on_ts_packets(buffer->bytes(), nb_packet)) != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    // erase consumed bytes
+    if (nb_packet > 0) {
+        buffer->erase(nb_packet * SRS_TS_PACKET_SIZE);
+    }
+
+    return ret;
+}
+
+int SrsMpegtsOverUdp::on_ts_packets(char* buf, int nb_packet)
+{
+    int ret = ERROR_SUCCESS;
+    
     for (int i = 0; i < nb_packet; i++) {
-        char* p = buffer->bytes() + (i * SRS_TS_PACKET_SIZE);
+        char* p = buf + (i * SRS_TS_PACKET_SIZE);
         if ((ret = stream->initialize(p, SRS_TS_PACKET_SIZE)) != ERROR_SUCCESS) {
             return ret;
         }
@@ -242,13 +269,8 @@ int SrsMpegtsOverUdp::on_udp_bytes(string host, int port, char* buf, int nb_buf)
         srs_info("mpegts: parse ts packet completed");
     }
     srs_info("mpegts: parse udp packet completed");
-
-    // erase consumed bytes
-    if (nb_packet > 0) {
-        buffer->erase(nb_packet * SRS_TS_PACKET_SIZE);
-    }
-
-    return ret;
+    
+    return ERROR_SUCCESS;
 }
 
 int SrsMpegtsOverUdp::on_ts_message(SrsTsMessage* msg)
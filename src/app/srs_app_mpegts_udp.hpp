@@ -84,6 +84,13 @@ private:
     SrsTsContext* context;
     SrsSimpleBuffer* buffer;
     std::string output;
+private:
+    /**
+    * the last peer address and its string, the caster always receives
+    * from the same encoder, so only call inet_ntoa when peer changed.
+    */
+    in_addr_t peer_addr;
+    std::string peer_ip;
 private:
     SrsRequest* req;
     st_netfd_t stfd;
@@ -110,7 +117,11 @@ public:
 public:
     virtual int on_udp_packet(sockaddr_in* from, char* buf, int nb_buf);
 private:
-    virtual int on_udp_bytes(std::string host, int port, char* buf, int nb_buf);
+    virtual int on_udp_bytes(const std::string& host, int port, char* buf, int nb_buf);
+    /**
+    * parse the aligned ts packets in buf.
+    */
+    virtual int on_ts_packets(char* buf, int nb_packet);
 // interface ISrsTsHandler
 public:
     virtual int on_ts_message(SrsTsMessage* msg);
@@ -0,0 +1,93 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_pacer.hpp>
+
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_app_st.hpp>
+
+SrsPacer::SrsPacer()
+{
+    rate = 0;
+    tokens = 0;
+    last_us = 0;
+    deadline_us = 0;
+}
+
+SrsPacer::~SrsPacer()
+{
+}
+
+void SrsPacer::start(int kbps, double burst)
+{
+    rate = 0;
+    if (kbps <= 0 || burst <= 0) {
+        return;
+    }
+    
+    // kbps to bytes per ms.
+    rate = kbps / 8.0;
+    
+    // start with a full bucket.
+    tokens = rate * SRS_PACER_BUCKET_MS;
+    last_us = (int64_t)st_utime();
+    deadline_us = last_us + (int64_t)(burst * 1000 * 1000);
+    
+    srs_trace("pacer start, rate=%dkbps, burst=%.2fs", kbps, burst);
+}
+
+bool SrsPacer::active()
+{
+    return rate > 0;
+}
+
+void SrsPacer::consume(int size)
+{
+    if (rate <= 0) {
+        return;
+    }
+    
+    int64_t now = (int64_t)st_utime();
+    
+    // the burst is over, real time now.
+    if (now >= deadline_us) {
+        rate = 0;
+        srs_info("pacer stop for burst is over");
+        return;
+    }
+    
+    // refill the tokens, at most a bucket.
+    tokens += rate * (now - last_us) / 1000.0;
+    tokens = srs_min(tokens, rate * SRS_PACER_BUCKET_MS);
+    last_us = now;
+    
+    // the bytes is sent, wait when in debt.
+    tokens -= size;
+    if (tokens < 0) {
+        int64_t wait_us = (int64_t)(-tokens / rate * 1000);
+        srs_info("pacer wait %dus for %d bytes", (int)wait_us, size);
+        st_usleep((st_utime_t)wait_us);
+    }
+}
+
@@ -0,0 +1,76 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_PACER_HPP
+#define SRS_APP_PACER_HPP
+
+/*
+#include <srs_app_pacer.hpp>
+*/
+#include <srs_core.hpp>
+
+// the bucket of pacer in ms, that is, the max burst bytes is rate*100ms.
+#define SRS_PACER_BUCKET_MS 100
+
+/**
+ * the token bucket pacer for the fast start of players.
+ * when player starts, the gop cache or fast cache is dumped to it,
+ * which is sent at line rate, so a reconnect storm of players will
+ * saturate the uplink. the pacer limits the send rate to X times of
+ * the stream bitrate in the first N seconds, then no limit for the
+ * live stream is real time.
+ * @remark the pacer is used by the socket, before each write.
+ */
+class SrsPacer
+{
+private:
+    // the rate in bytes per ms, 0 to disable.
+    double rate;
+    // the tokens in bytes, negative when in debt.
+    double tokens;
+    // the last time to refill the tokens, in us.
+    int64_t last_us;
+    // the end of burst, in us.
+    int64_t deadline_us;
+public:
+    SrsPacer();
+    virtual ~SrsPacer();
+public:
+    /**
+     * start the pacer in the burst duration.
+     * @param kbps the rate to send in kbps, 0 to disable.
+     * @param burst the duration to limit in seconds.
+     */
+    virtual void start(int kbps, double burst);
+    /**
+     * whether the pacer is limiting the rate.
+     */
+    virtual bool active();
+    /**
+     * consume the tokens of size bytes, sleep when no tokens.
+     */
+    virtual void consume(int size);
+};
+
+#endif
+
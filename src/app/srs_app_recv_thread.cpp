@@ -526,9 +526,10 @@ void SrsPublishRecvThread::set_socket_buffer(int sleep_ms)
     rtmp->set_recv_buffer(nb_rbuf);
 }
 
-SrsHttpRecvThread::SrsHttpRecvThread(SrsResponseOnlyHttpConn* c)
+SrsHttpRecvThread::SrsHttpRecvThread(SrsResponseOnlyHttpConn* c, ISrsWakable* w)
 {
     conn = c;
+    wakable = w;
     error = ERROR_SUCCESS;
     trd = new SrsOneCycleThread("http-receive", this);
 }
@@ -558,6 +559,11 @@ int SrsHttpRecvThread::cycle()
         
         if ((ret = conn->pop_message(&req)) != ERROR_SUCCESS) {
             error = ret;
+            
+            // the player may wait on cond, wakeup to quit.
+            if (wakable) {
+                wakable->wakeup();
+            }
             break;
         }
     }
@@ -45,6 +45,7 @@ class SrsRequest;
 class SrsConsumer;
 class SrsHttpConn;
 class SrsResponseOnlyHttpConn;
+class ISrsWakable;
 
 /**
  * for the recv thread to handle the message.
@@ -228,10 +229,12 @@ class SrsHttpRecvThread : public ISrsOneCycleThreadHandler
 {
 private:
     SrsResponseOnlyHttpConn* conn;
+    // the consumer waiting for messages, wakeup when client closed.
+    ISrsWakable* wakable;
     SrsOneCycleThread* trd;
     int error;
 public:
-    SrsHttpRecvThread(SrsResponseOnlyHttpConn* c);
+    SrsHttpRecvThread(SrsResponseOnlyHttpConn* c, ISrsWakable* w);
     virtual ~SrsHttpRecvThread();
 public:
     virtual int start();
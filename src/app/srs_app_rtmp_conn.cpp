@@ -54,6 +54,8 @@ using namespace std;
 #include <srs_app_security.hpp>
 #include <srs_app_statistic.hpp>
 #include <srs_rtmp_utility.hpp>
+#include <srs_app_pacer.hpp>
+#include <srs_app_event_log.hpp>
 
 // when stream is busy, for example, streaming is already
 // publishing, when a new client to request to publish,
@@ -139,6 +141,7 @@ int SrsRtmpConn::do_cycle()
 {
     int ret = ERROR_SUCCESS;
     
+    int64_t starttime = srs_get_system_time_ms();
     srs_trace("RTMP client ip=%s", ip.c_str());
     //设置接收和发送的超时时间，都是30s
     rtmp->set_recv_timeout(SRS_CONSTS_RTMP_RECV_TIMEOUT_US);
@@ -197,6 +200,8 @@ int SrsRtmpConn::do_cycle()
     ret = service_cycle();
     
     http_hooks_on_close();
+    SrsEventLog::instance()->on_event(SrsLogEventClose, _srs_context->get_id(), req, kbps, 
+        srs_get_system_time_ms() - starttime, ret);
 
     return ret;
 }
@@ -543,8 +548,13 @@ int SrsRtmpConn::stream_service_cycle()
             }
             
             srs_info("start to play stream %s success", req->stream.c_str());
+            SrsEventLog::instance()->on_event(SrsLogEventPlay, _srs_context->get_id(), req, kbps, 0, ret);
+            
+            int64_t starttime = srs_get_system_time_ms();
             ret = playing(source);
             http_hooks_on_stop();
+            SrsEventLog::instance()->on_event(SrsLogEventStop, _srs_context->get_id(), req, kbps,
+                srs_get_system_time_ms() - starttime, ret);
             
             return ret;
         }
@@ -621,6 +631,7 @@ int SrsRtmpConn::check_vhost()
     if ((ret = http_hooks_on_connect()) != ERROR_SUCCESS) {
         return ret;
     }
+    SrsEventLog::instance()->on_event(SrsLogEventConnect, _srs_context->get_id(), req, kbps, 0, ret);
     
     return ret;
 }
@@ -648,11 +659,22 @@ int SrsRtmpConn::playing(SrsSource* source)
         return ret;
     }
     
+    // limit the send rate when dump the gop cache, for the burst of players.
+    SrsPacer pacer;
+    double burst = _srs_config->get_fast_start_burst(req->vhost);
+    if (burst > 0) {
+        int kbps = (int)(consumer->queue_kbps() * _srs_config->get_fast_start_rate(req->vhost));
+        pacer.start(kbps, burst);
+        skt->set_pacer(&pacer);
+    }
+    
     // delivery messages for clients playing stream.
     wakable = consumer;
     ret = do_playing(source, consumer, &trd);
     wakable = NULL;
     
+    skt->set_pacer(NULL);
+    
     // stop isolate recv thread
     trd.stop();
     
@@ -733,24 +755,8 @@ int SrsRtmpConn::do_playing(SrsSource* source, SrsConsumer* consumer, SrsQueueRe
             return ret;
         }
         
-#ifdef SRS_PERF_QUEUE_COND_WAIT
-        // for send wait time debug
-        srs_verbose("send thread now=%"PRId64"us, wait %dms", srs_update_system_time_ms(), mw_sleep);
-        
         // wait for message to incoming.
-        // @see https://github.com/ossrs/srs/issues/251
-        // @see https://github.com/ossrs/srs/issues/257
-        if (realtime) {
-            // for realtime, min required msgs is 0, send when got one+ msgs.
-            consumer->wait(0, mw_sleep);
-        } else {
-            // for no-realtime, got some msgs then send.
-            consumer->wait(SRS_PERF_MW_MIN_MSGS, mw_sleep);
-        }
-        
-        // for send wait time debug
-        srs_verbose("send thread now=%"PRId64"us wakeup", srs_update_system_time_ms());
-#endif
+        consumer->wait_mw(realtime, mw_sleep);
         
         // get messages from consumer.
         // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
@@ -785,12 +791,7 @@ int SrsRtmpConn::do_playing(SrsSource* source, SrsConsumer* consumer, SrsQueueRe
         }
         
         if (count <= 0) {
-#ifndef SRS_PERF_QUEUE_COND_WAIT
-            srs_info("mw sleep %dms for no msg", mw_sleep);
-            st_usleep(mw_sleep * 1000);
-#else
             srs_verbose("mw wait %dms and got nothing.", mw_sleep);
-#endif
             // ignore when nothing got.
             continue;
         }
@@ -855,6 +856,9 @@ int SrsRtmpConn::publishing(SrsSource* source)
         return ret;
     }
 
+    SrsEventLog::instance()->on_event(SrsLogEventPublish, _srs_context->get_id(), req, kbps, 0, ret);
+    int64_t starttime = srs_get_system_time_ms();
+
     bool vhost_is_edge = _srs_config->get_vhost_is_edge(req->vhost);
     if ((ret = acquire_publish(source, vhost_is_edge)) == ERROR_SUCCESS) {
         // use isolate thread to recv,
@@ -881,6 +885,8 @@ int SrsRtmpConn::publishing(SrsSource* source)
     }
 
     http_hooks_on_unpublish();
+    SrsEventLog::instance()->on_event(SrsLogEventUnpublish, _srs_context->get_id(), req, kbps,
+        srs_get_system_time_ms() - starttime, ret);
 
     return ret;
 }
@@ -46,6 +46,7 @@ using namespace std;
 #include <srs_app_mpegts_udp.hpp>
 #include <srs_app_rtsp.hpp>
 #include <srs_app_statistic.hpp>
+#include <srs_app_event_log.hpp>
 #include <srs_app_caster_flv.hpp>
 #include <srs_core_mem_watch.hpp>
 
@@ -827,6 +828,15 @@ int SrsServer::http_handle()
     if ((ret = http_api_mux->handle("/api/v1/clients/", new SrsGoApiClients())) != ERROR_SUCCESS) {
         return ret;
     }
+    if ((ret = http_api_mux->handle("/api/v1/events/streams", new SrsGoApiStreamEvents())) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = http_api_mux->handle("/api/v1/perf", new SrsGoApiPerf())) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = http_api_mux->handle("/metrics", new SrsGoApiMetrics())) != ERROR_SUCCESS) {
+        return ret;
+    }
     
     // test the request info.
     if ((ret = http_api_mux->handle("/api/v1/tests/requests", new SrsGoApiRequests())) != ERROR_SUCCESS) {
@@ -892,6 +902,9 @@ int SrsServer::cycle()
     dispose();
     srs_trace("srs terminated");
     
+    // drain the events to file.
+    SrsEventLog::instance()->close();
+    
     // for valgrind to detect.
     srs_freep(_srs_config);
     srs_freep(_srs_log);
@@ -942,6 +955,7 @@ void SrsServer::on_signal(int signo)
 #ifdef SRS_AUTO_MEM_WATCH
         srs_memory_report();
 #endif
+        // the async log writers are stopped and drained by atexit.
         exit(0);
 #endif
         return;
@@ -992,8 +1006,14 @@ int SrsServer::do_cycle()
         
         for (int i = 0; i < temp_max; i++) {
             //主线程休眠，让出CPU，其他线程如conn接受连接
+            int64_t starttime = (int64_t)st_utime();
             st_usleep(SRS_SYS_CYCLE_INTERVAL * 1000);
             
+            // the overshoot of sleep, wakeup later when other threads busy,
+            // it's a coarse sample of load, not the run queue delay of st.
+            int64_t overshoot = (int64_t)st_utime() - starttime - SRS_SYS_CYCLE_INTERVAL * 1000;
+            SrsStatistic::instance()->on_cycle(srs_max(0, overshoot));
+            
             // asprocess check.
             if (asprocess && ::getppid() != ppid) {
                 srs_warn("asprocess ppid changed from %d to %d", ppid, ::getppid());
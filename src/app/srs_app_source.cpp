@@ -32,6 +32,7 @@ using namespace std;
 #include <srs_rtmp_amf0.hpp>
 #include <srs_kernel_codec.hpp>
 #include <srs_app_hls.hpp>
+#include <srs_app_ts_remux.hpp>
 #include <srs_app_forward.hpp>
 #include <srs_app_config.hpp>
 #include <srs_app_encoder.hpp>
@@ -44,6 +45,7 @@ using namespace std;
 #include <srs_rtmp_msg_array.hpp>
 #include <srs_app_hds.hpp>
 #include <srs_app_statistic.hpp>
+#include <srs_kernel_perf.hpp>
 #include <srs_core_autofree.hpp>
 #include <srs_rtmp_utility.hpp>
 
@@ -263,6 +265,19 @@ int SrsMessageQueue::duration()
     return (int)(av_end_time - av_start_time);
 }
 
+int64_t SrsMessageQueue::bytes()
+{
+    int64_t nb_bytes = 0;
+    
+    int nb_msgs = (int)msgs.size();
+    for (int i = 0; i < nb_msgs; i++) {
+        SrsSharedPtrMessage* msg = msgs.at(i);
+        nb_bytes += msg->size;
+    }
+    
+    return nb_bytes;
+}
+
 void SrsMessageQueue::set_queue_size(double queue_size)
 {
     queue_size_ms = (int)(queue_size * 1000);
@@ -386,6 +401,8 @@ void SrsMessageQueue::shrink()
         msgs.push_back(audio_sh);
     }
     
+    SrsStatistic::instance()->on_queue_shrink(msgs_size - (int)msgs.size());
+    
     if (_ignore_shrink) {
         srs_info("shrink the cache queue, size=%d, removed=%d, max=%.2f", 
             (int)msgs.size(), msgs_size - (int)msgs.size(), queue_size_ms / 1000.0);
@@ -429,6 +446,7 @@ SrsConsumer::SrsConsumer(SrsSource* s, SrsConnection* c)
     jitter = new SrsRtmpJitter();
     queue = new SrsMessageQueue();
     should_update_source_id = false;
+    stat = new SrsConsumerStat();
     
 #ifdef SRS_PERF_QUEUE_COND_WAIT
     mw_wait = st_cond_new();
@@ -436,6 +454,10 @@ SrsConsumer::SrsConsumer(SrsSource* s, SrsConnection* c)
     mw_duration = 0;
     mw_waiting = false;
 #endif
+
+#ifdef SRS_PERF_HISTOGRAM
+    oldest_enqueue_us = 0;
+#endif
 }
 
 SrsConsumer::~SrsConsumer()
@@ -443,6 +465,7 @@ SrsConsumer::~SrsConsumer()
     source->on_consumer_destroy(this);
     srs_freep(jitter);
     srs_freep(queue);
+    srs_freep(stat);
     
 #ifdef SRS_PERF_QUEUE_COND_WAIT
     st_cond_destroy(mw_wait);
@@ -464,6 +487,22 @@ int SrsConsumer::get_time()
     return jitter->get_time();
 }
 
+int SrsConsumer::queue_kbps()
+{
+    int duration = queue->duration();
+    if (duration <= 0) {
+        return 0;
+    }
+    
+    // bytes*8/ms is kbps.
+    return (int)(queue->bytes() * 8 / duration);
+}
+
+SrsConsumerStat* SrsConsumer::get_stat()
+{
+    return stat;
+}
+
 int SrsConsumer::enqueue(SrsSharedPtrMessage* shared_msg, bool atc, SrsRtmpJitterAlgorithm ag)
 {
     int ret = ERROR_SUCCESS;
@@ -477,10 +516,27 @@ int SrsConsumer::enqueue(SrsSharedPtrMessage* shared_msg, bool atc, SrsRtmpJitte
         }
     }
     
-    if ((ret = queue->enqueue(msg, NULL)) != ERROR_SUCCESS) {
+    // the msgs in queue before enqueue, to count the dropped by shrink.
+    int nb_msgs = queue->size();
+    bool is_overflow = false;
+    
+    if ((ret = queue->enqueue(msg, &is_overflow)) != ERROR_SUCCESS) {
         return ret;
     }
     
+    stat->nb_enqueued++;
+    stat->max_duration = srs_max(stat->max_duration, queue->duration());
+    if (is_overflow) {
+        stat->nb_shrinks++;
+        stat->nb_drops += nb_msgs + 1 - queue->size();
+    }
+    
+#ifdef SRS_PERF_HISTOGRAM
+    if (oldest_enqueue_us <= 0) {
+        oldest_enqueue_us = srs_perf_now_us();
+    }
+#endif
+    
 #ifdef SRS_PERF_QUEUE_COND_WAIT
     srs_verbose("enqueue msg, time=%"PRId64", size=%d, duration=%d, waiting=%d, min_msg=%d", 
         msg->timestamp, msg->size, queue->duration(), mw_waiting, mw_min_msgs);
@@ -540,6 +596,21 @@ int SrsConsumer::dump_packets(SrsMessageArray* msgs, int& count)
         return ret;
     }
     
+    if (count > 0) {
+        stat->nb_dumps++;
+        stat->nb_dumped += count;
+    }
+    
+#ifdef SRS_PERF_HISTOGRAM
+    // record the residence of the oldest msg, and the left msgs
+    // are considered enqueued now, for we don't track each msg.
+    if (count > 0 && oldest_enqueue_us > 0) {
+        int64_t now = srs_perf_now_us();
+        srs_perf_record(SrsPerfStageQueueResidence, now - oldest_enqueue_us);
+        oldest_enqueue_us = (queue->size() > 0)? now : 0;
+    }
+#endif
+    
     return ret;
 }
 
@@ -567,9 +638,38 @@ void SrsConsumer::wait(int nb_msgs, int duration)
     
     // use cond block wait for high performance mode.
     st_cond_wait(mw_wait);
+    stat->nb_wakeups++;
 }
 #endif
 
+void SrsConsumer::wait_mw(bool realtime, int mw_sleep)
+{
+#ifdef SRS_PERF_QUEUE_COND_WAIT
+    // for send wait time debug
+    srs_verbose("send thread now=%"PRId64"us, wait %dms", srs_update_system_time_ms(), mw_sleep);
+    
+    // wait for message to incoming.
+    // @see https://github.com/ossrs/srs/issues/251
+    // @see https://github.com/ossrs/srs/issues/257
+    if (realtime) {
+        // for realtime, min required msgs is 0, send when got one+ msgs.
+        wait(0, mw_sleep);
+    } else {
+        // for no-realtime, got some msgs then send.
+        wait(SRS_PERF_MW_MIN_MSGS, mw_sleep);
+    }
+    
+    // for send wait time debug
+    srs_verbose("send thread now=%"PRId64"us wakeup", srs_update_system_time_ms());
+#else
+    if (queue->size() <= 0) {
+        srs_info("mw sleep %dms for no msg", mw_sleep);
+        st_usleep(mw_sleep * 1000);
+        stat->nb_wakeups++;
+    }
+#endif
+}
+
 int SrsConsumer::on_play_client_pause(bool is_pause)
 {
     int ret = ERROR_SUCCESS;
@@ -944,6 +1044,7 @@ SrsSource::SrsSource()
 #ifdef SRS_AUTO_HLS
     hls = new SrsHls();
 #endif
+    ts_remux = new SrsTsRemuxer();
 #ifdef SRS_AUTO_DVR
     dvr = new SrsDvr();
 #endif
@@ -979,6 +1080,9 @@ SrsSource::~SrsSource()
     // never free the consumers, 
     // for all consumers are auto free.
     consumers.clear();
+    
+    // free the remuxer before hls, which is the handler of remuxer.
+    srs_freep(ts_remux);
 
     if (true) {
         std::vector<SrsForwarder*>::iterator it;
@@ -1056,7 +1160,7 @@ bool SrsSource::expired()
     }
     
     // has any consumers?
-    if (!consumers.empty()) {
+    if (!consumers.empty() || ts_remux->has_consumers()) {
         return false;
     }
     
@@ -1083,6 +1187,13 @@ int SrsSource::initialize(SrsRequest* r, ISrsSourceHandler* h)
     if ((ret = hls->initialize(this, _req)) != ERROR_SUCCESS) {
         return ret;
     }
+    if ((ret = ts_remux->initialize(_req, hls)) != ERROR_SUCCESS) {
+        return ret;
+    }
+#else
+    if ((ret = ts_remux->initialize(_req, NULL)) != ERROR_SUCCESS) {
+        return ret;
+    }
 #endif
     
 #ifdef SRS_AUTO_DVR
@@ -1386,11 +1497,11 @@ int SrsSource::on_hls_start()
     // when reload to start hls, hls will never get the sequence header in stream,
     // use the SrsSource.on_hls_start to push the sequence header to HLS.
     // TODO: maybe need to decode the metadata?
-    if (cache_sh_video && (ret = hls->on_video(cache_sh_video, true)) != ERROR_SUCCESS) {
+    if (cache_sh_video && (ret = ts_remux->on_video(cache_sh_video, true)) != ERROR_SUCCESS) {
         srs_error("hls process video sequence header message failed. ret=%d", ret);
         return ret;
     }
-    if (cache_sh_audio && (ret = hls->on_audio(cache_sh_audio)) != ERROR_SUCCESS) {
+    if (cache_sh_audio && (ret = ts_remux->on_audio(cache_sh_audio)) != ERROR_SUCCESS) {
         srs_error("hls process audio sequence header message failed. ret=%d", ret);
         return ret;
     }
@@ -1719,12 +1830,18 @@ int SrsSource::on_audio_imp(SrsSharedPtrMessage* msg)
             flv_sample_rates[sample.sound_rate]);
     }
     
+    // remux to ts once, the ts blocks are shared by hls and http ts clients.
+    if ((ret = ts_remux->on_audio(msg)) != ERROR_SUCCESS) {
 #ifdef SRS_AUTO_HLS
-    if ((ret = hls->on_audio(msg)) != ERROR_SUCCESS) {
         // apply the error strategy for hls.
         // @see https://github.com/ossrs/srs/issues/264
         std::string hls_error_strategy = _srs_config->get_hls_on_error(_req->vhost);
-        if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
+        if (!hls->is_ts_enabled()) {
+            // only http ts clients, the hls error strategy not applied,
+            // drop the frame and never disconnect the publisher.
+            srs_warn("ts remux audio for http ts failed, ignore. ret=%d", ret);
+            ret = ERROR_SUCCESS;
+        } else if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
             srs_warn("hls process audio message failed, ignore and disable hls. ret=%d", ret);
             
             // unpublish, ignore ret.
@@ -1743,8 +1860,12 @@ int SrsSource::on_audio_imp(SrsSharedPtrMessage* msg)
             srs_warn("hls disconnect publisher for audio error. ret=%d", ret);
             return ret;
         }
-    }
+#else
+        // only http ts clients, drop the frame and never disconnect the publisher.
+        srs_warn("ts remux audio for http ts failed, ignore. ret=%d", ret);
+        ret = ERROR_SUCCESS;
 #endif
+    }
     
 #ifdef SRS_AUTO_DVR
     if ((ret = dvr->on_audio(msg)) != ERROR_SUCCESS) {
@@ -1771,6 +1892,7 @@ int SrsSource::on_audio_imp(SrsSharedPtrMessage* msg)
     
     // copy to all consumer
     if (!drop_for_reduce) {
+        SrsPerfAuto(SrsPerfStageSourceFanout);
         for (int i = 0; i < (int)consumers.size(); i++) {
             SrsConsumer* consumer = consumers.at(i);
             if ((ret = consumer->enqueue(msg, atc, jitter_algorithm)) != ERROR_SUCCESS) {
@@ -1934,12 +2056,18 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
             codec.video_data_rate / 1000, codec.frame_rate, codec.duration);
     }
     
+    // remux to ts once, the ts blocks are shared by hls and http ts clients.
+    if ((ret = ts_remux->on_video(msg, is_sequence_header)) != ERROR_SUCCESS) {
 #ifdef SRS_AUTO_HLS
-    if ((ret = hls->on_video(msg, is_sequence_header)) != ERROR_SUCCESS) {
         // apply the error strategy for hls.
         // @see https://github.com/ossrs/srs/issues/264
         std::string hls_error_strategy = _srs_config->get_hls_on_error(_req->vhost);
-        if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
+        if (!hls->is_ts_enabled()) {
+            // only http ts clients, the hls error strategy not applied,
+            // drop the frame and never disconnect the publisher.
+            srs_warn("ts remux video for http ts failed, ignore. ret=%d", ret);
+            ret = ERROR_SUCCESS;
+        } else if (srs_config_hls_is_on_error_ignore(hls_error_strategy)) {
             srs_warn("hls process video message failed, ignore and disable hls. ret=%d", ret);
             
             // unpublish, ignore ret.
@@ -1958,8 +2086,12 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
             srs_warn("hls disconnect publisher for video error. ret=%d", ret);
             return ret;
         }
-    }
+#else
+        // only http ts clients, drop the frame and never disconnect the publisher.
+        srs_warn("ts remux video for http ts failed, ignore. ret=%d", ret);
+        ret = ERROR_SUCCESS;
 #endif
+    }
     
 #ifdef SRS_AUTO_DVR
     if ((ret = dvr->on_video(msg)) != ERROR_SUCCESS) {
@@ -1986,6 +2118,7 @@ int SrsSource::on_video_imp(SrsSharedPtrMessage* msg)
     
     // copy to all consumer
     if (!drop_for_reduce) {
+        SrsPerfAuto(SrsPerfStageSourceFanout);
         for (int i = 0; i < (int)consumers.size(); i++) {
             SrsConsumer* consumer = consumers.at(i);
             if ((ret = consumer->enqueue(msg, atc, jitter_algorithm)) != ERROR_SUCCESS) {
@@ -2175,6 +2308,11 @@ int SrsSource::on_publish()
     }
 #endif
     
+    if ((ret = ts_remux->on_publish()) != ERROR_SUCCESS) {
+        srs_error("start ts remux failed. ret=%d", ret);
+        return ret;
+    }
+    
 #ifdef SRS_AUTO_HLS
     if ((ret = hls->on_publish(_req, false)) != ERROR_SUCCESS) {
         srs_error("start hls failed. ret=%d", ret);
@@ -2223,6 +2361,9 @@ void SrsSource::on_unpublish()
     encoder->on_unpublish();
 #endif
 
+    // flush the cached audio to hls and http ts clients.
+    ts_remux->on_unpublish();
+
 #ifdef SRS_AUTO_HLS
     hls->on_unpublish();
 #endif
@@ -2252,8 +2393,16 @@ void SrsSource::on_unpublish()
     stat->on_stream_close(_req);
     handler->on_unpublish(this, _req);
     
+    // wakeup the waiting players, for the http players quit when unmounted.
+    std::vector<SrsConsumer*>::iterator it;
+    for (it = consumers.begin(); it != consumers.end(); ++it) {
+        SrsConsumer* consumer = *it;
+        consumer->wakeup();
+    }
+    ts_remux->wakeup_consumers();
+    
     // no consumer, stream is die.
-    if (consumers.empty()) {
+    if (consumers.empty() && !ts_remux->has_consumers()) {
         die_at = srs_get_system_time_ms();
     }
 }
@@ -2265,6 +2414,8 @@ int SrsSource::create_consumer(SrsConnection* conn, SrsConsumer*& consumer, bool
     consumer = new SrsConsumer(this, conn);
     consumers.push_back(consumer);
     
+    SrsStatistic::instance()->on_consumer(_req, conn, consumer->get_stat());
+    
     double queue_size = _srs_config->get_queue_length(_req->vhost);
     consumer->set_queue_size(queue_size);
     
@@ -2327,16 +2478,47 @@ int SrsSource::create_consumer(SrsConnection* conn, SrsConsumer*& consumer, bool
     return ret;
 }
 
+int SrsSource::create_ts_consumer(SrsConnection* conn, SrsConsumer*& consumer)
+{
+    int ret = ERROR_SUCCESS;
+    
+    consumer = new SrsConsumer(this, conn);
+    
+    double queue_size = _srs_config->get_queue_length(_req->vhost);
+    consumer->set_queue_size(queue_size);
+    
+    // attach to remuxer, which dumps the PAT/PMT and gop cache.
+    if ((ret = ts_remux->create_consumer(consumer)) != ERROR_SUCCESS) {
+        srs_error("dispatch ts gop cache failed. ret=%d", ret);
+        return ret;
+    }
+    srs_trace("create ts consumer, queue_size=%.2f", queue_size);
+
+    // for edge, when play edge stream, check the state
+    if (_srs_config->get_vhost_is_edge(_req->vhost)) {
+        // notice edge to start for the first client.
+        if ((ret = play_edge->on_client_play()) != ERROR_SUCCESS) {
+            srs_error("notice edge start play stream failed. ret=%d", ret);
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
 void SrsSource::on_consumer_destroy(SrsConsumer* consumer)
 {
+    SrsStatistic::instance()->on_consumer_close(_req, consumer->get_stat());
+    
     std::vector<SrsConsumer*>::iterator it;
     it = std::find(consumers.begin(), consumers.end(), consumer);
     if (it != consumers.end()) {
         consumers.erase(it);
     }
+    ts_remux->on_consumer_destroy(consumer);
     srs_info("handle consumer destroy success.");
     
-    if (consumers.empty()) {
+    if (consumers.empty() && !ts_remux->has_consumers()) {
         play_edge->on_all_client_stop();
         die_at = srs_get_system_time_ms();
     }
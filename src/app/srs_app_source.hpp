@@ -52,6 +52,7 @@ class SrsRtmpServer;
 class SrsEdgeProxyContext;
 class SrsMessageArray;
 class SrsConnection;
+class SrsTsRemuxer;
 #ifdef SRS_AUTO_HLS
 class SrsHls;
 #endif
@@ -65,6 +66,7 @@ class SrsStream;
 #ifdef SRS_AUTO_HDS
 class SrsHds;
 #endif
+struct SrsConsumerStat;
 
 /**
 * the time jitter algorithm:
@@ -161,6 +163,10 @@ public:
     */
     virtual int duration();
     /**
+    * get the total payload bytes of queue.
+    */
+    virtual int64_t bytes();
+    /**
     * set the queue size
     * @param queue_size the queue size in seconds.
     */
@@ -229,6 +235,8 @@ private:
     bool paused;
     // when source id changed, notice all consumers
     bool should_update_source_id;
+    // the queue counters, reported to statistic.
+    SrsConsumerStat* stat;
 #ifdef SRS_PERF_QUEUE_COND_WAIT
     // the cond wait for mw.
     // @see https://github.com/ossrs/srs/issues/251
@@ -237,6 +245,11 @@ private:
     int mw_min_msgs;
     int mw_duration;
 #endif
+#ifdef SRS_PERF_HISTOGRAM
+    // the time in us when the oldest msg enqueued, 0 when queue empty.
+    // @remark the residence of queue is measured by the oldest msg of each dump.
+    int64_t oldest_enqueue_us;
+#endif
 public:
     SrsConsumer(SrsSource* s, SrsConnection* c);
     virtual ~SrsConsumer();
@@ -255,6 +268,16 @@ public:
     */
     virtual int get_time();
     /**
+    * estimate the bitrate in kbps by the queued msgs,
+    * for example, the gop cache dumped when play start.
+    * @return the kbps, 0 if unknown for no duration.
+    */
+    virtual int queue_kbps();
+    /**
+     * get the queue counters of consumer.
+     */
+    virtual SrsConsumerStat* get_stat();
+    /**
     * enqueue an shared ptr message.
     * @param shared_msg, directly ptr, copy it if need to save it.
     * @param whether atc, donot use jitter correct if true.
@@ -276,6 +299,13 @@ public:
     */
     virtual void wait(int nb_msgs, int duration);
 #endif
+    /**
+    * wait for messages in merged-write, the same batching for rtmp and http players,
+    * for realtime, send when got one+ msgs, otherwise wait for SRS_PERF_MW_MIN_MSGS.
+    * @param mw_sleep the merged-write duration in ms.
+    * @remark sleep mw_sleep when queue is empty and cond wait disabled.
+    */
+    virtual void wait_mw(bool realtime, int mw_sleep);
     /**
     * when client send the pause message.
     */
@@ -464,6 +494,8 @@ private:
     // whether stream is monotonically increase.
     bool is_monotonically_increase;
     int64_t last_packet_time;
+    // the shared ts remuxer, for hls and http ts clients.
+    SrsTsRemuxer* ts_remux;
     // hls handler.
 #ifdef SRS_AUTO_HLS
     SrsHls* hls;
@@ -584,6 +616,11 @@ public:
         SrsConnection* conn, SrsConsumer*& consumer,
         bool ds = true, bool dm = true, bool dg = true
     );
+    /**
+    * create consumer for http ts client, which plays the ts blocks
+    * from the shared remuxer, starts with the PAT/PMT and gop cache.
+    */
+    virtual int create_ts_consumer(SrsConnection* conn, SrsConsumer*& consumer);
     virtual void on_consumer_destroy(SrsConsumer* consumer);
     virtual void set_cache(bool enabled);
     virtual SrsRtmpJitterAlgorithm jitter();
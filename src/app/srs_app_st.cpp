@@ -25,6 +25,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_log.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_app_pacer.hpp>
+#include <srs_kernel_perf.hpp>
+#include <srs_app_statistic.hpp>
+
+#include <string.h>
+#ifdef SRS_PERF_SENDFILE
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
 
 //构造函数：传入客户端的fd
 SrsStSocket::SrsStSocket(st_netfd_t client_stfd)
@@ -33,6 +43,7 @@ SrsStSocket::SrsStSocket(st_netfd_t client_stfd)
     //超时时间默认为永不超时
     send_timeout = recv_timeout = ST_UTIME_NO_TIMEOUT;
     recv_bytes = send_bytes = 0;
+    pacer = NULL;
 }
 
 SrsStSocket::~SrsStSocket()
@@ -79,6 +90,11 @@ int64_t SrsStSocket::get_send_bytes()
     return send_bytes;
 }
 
+void SrsStSocket::set_pacer(SrsPacer* v)
+{
+    pacer = v;
+}
+
 //从stfd读取size个字节到buf，nread为读取的字节数
 int SrsStSocket::read(void* buf, size_t size, ssize_t* nread)
 {
@@ -146,7 +162,15 @@ int SrsStSocket::write(void* buf, size_t size, ssize_t* nwrite)
 {
     int ret = ERROR_SUCCESS;
     
+#ifdef SRS_PERF_HISTOGRAM
+    int64_t starttime = srs_perf_now_us();
+#endif
+    
     ssize_t nb_write = st_write(stfd, buf, size, send_timeout);
+    
+#ifdef SRS_PERF_HISTOGRAM
+    srs_perf_record(SrsPerfStageSend, srs_perf_now_us() - starttime);
+#endif
     if (nwrite) {
         *nwrite = nb_write;
     }
@@ -159,11 +183,16 @@ int SrsStSocket::write(void* buf, size_t size, ssize_t* nwrite)
             return ERROR_SOCKET_TIMEOUT;
         }
         
+        SrsStatistic::instance()->on_send_error();
         return ERROR_SOCKET_WRITE;
     }
     
     send_bytes += nb_write;
     
+    if (pacer) {
+        pacer->consume((int)nb_write);
+    }
+    
     return ret;
 }
 //将iov_size个iov写入到stfd, nwrite为写入的个数
@@ -171,7 +200,15 @@ int SrsStSocket::writev(const iovec *iov, int iov_size, ssize_t* nwrite)
 {
     int ret = ERROR_SUCCESS;
     
+#ifdef SRS_PERF_HISTOGRAM
+    int64_t starttime = srs_perf_now_us();
+#endif
+    
     ssize_t nb_write = st_writev(stfd, iov, iov_size, send_timeout);
+    
+#ifdef SRS_PERF_HISTOGRAM
+    srs_perf_record(SrsPerfStageSend, srs_perf_now_us() - starttime);
+#endif
     if (nwrite) {
         *nwrite = nb_write;
     }
@@ -184,11 +221,59 @@ int SrsStSocket::writev(const iovec *iov, int iov_size, ssize_t* nwrite)
             return ERROR_SOCKET_TIMEOUT;
         }
         
+        SrsStatistic::instance()->on_send_error();
         return ERROR_SOCKET_WRITE;
     }
     
     send_bytes += nb_write;
     
+    if (pacer) {
+        pacer->consume((int)nb_write);
+    }
+    
+    return ret;
+}
+
+int SrsStSocket::sendfile(int in_fd, int64_t offset, size_t size, ssize_t* nwrite)
+{
+    int ret = ERROR_SUCCESS;
+    
+    ssize_t nb_write = 0;
+    
+#ifdef SRS_PERF_SENDFILE
+    int out_fd = st_netfd_fileno(stfd);
+    off_t pos = (off_t)offset;
+    
+    while (nb_write < (ssize_t)size) {
+        ssize_t nb_sent = ::sendfile(out_fd, in_fd, &pos, size - nb_write);
+        
+        // the st socket is nonblocking, wait for writable when send buffer full.
+        if (nb_sent < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (st_netfd_poll(stfd, POLLOUT, send_timeout) != 0) {
+                // @see https://github.com/ossrs/srs/issues/200
+                ret = (errno == ETIME)? ERROR_SOCKET_TIMEOUT : ERROR_SOCKET_WRITE;
+                break;
+            }
+            continue;
+        }
+        
+        // when file truncated, sendfile returns 0.
+        if (nb_sent <= 0) {
+            ret = ERROR_SOCKET_WRITE;
+            break;
+        }
+        
+        nb_write += nb_sent;
+    }
+#else
+    ret = ERROR_SOCKET_WRITE;
+#endif
+    
+    if (nwrite) {
+        *nwrite = nb_write;
+    }
+    send_bytes += nb_write;
+    
     return ret;
 }
 
@@ -232,6 +317,15 @@ int srs_st_init()
         return ret;
     }
     srs_trace("st_set_eventsys to %s", st_get_eventsys_name());
+    
+#ifdef __linux__
+    // the st maybe built with select or poll, which is too slow for lots of fds.
+    if (strcmp(st_get_eventsys_name(), "epoll") != 0) {
+        ret = ERROR_ST_SET_EPOLL;
+        srs_error("st eventsys %s is not epoll, please build st with epoll. ret=%d", st_get_eventsys_name(), ret);
+        return ret;
+    }
+#endif
     //初始协程
     if(st_init() != 0){
         ret = ERROR_ST_INITIALIZE;
@@ -35,6 +35,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_st.hpp>
 #include <srs_rtmp_io.hpp>
 
+class SrsPacer;
+
 /**
  * the socket provides TCP socket over st,
  * that is, the sync socket mechanism.
@@ -48,6 +50,8 @@ private:
     int64_t recv_bytes; //接收字节数
     int64_t send_bytes; //发送字节数
     st_netfd_t stfd; //读写的socket
+    // the pacer to limit the send rate, NULL to disable.
+    SrsPacer* pacer;
 public:
     SrsStSocket(st_netfd_t client_stfd);
     virtual ~SrsStSocket();
@@ -60,6 +64,11 @@ public:
     virtual int64_t get_send_timeout();
     virtual int64_t get_recv_bytes();
     virtual int64_t get_send_bytes();
+    /**
+     * set the pacer for write and writev, NULL to disable.
+     * @remark user should free the pacer, after reset it to NULL.
+     */
+    virtual void set_pacer(SrsPacer* v);
 public:
     /**
      * @param nread, the actual read bytes, ignore if NULL.
@@ -75,6 +84,13 @@ public:
     virtual int write(void* buf, size_t size, ssize_t* nwrite);
     //将iov_size个iov写入到stfd, nwrite为写入的个数
     virtual int writev(const iovec *iov, int iov_size, ssize_t* nwrite);
+    /**
+     * send size bytes of file from offset to socket by sendfile(2),
+     * wait for the socket writable when send buffer is full.
+     * @param nwrite, the actual write bytes, ignore if NULL.
+     * @remark the offset of file is not changed.
+     */
+    virtual int sendfile(int in_fd, int64_t offset, size_t size, ssize_t* nwrite);
 };
 
 // initialize st, requires epoll.
@@ -24,7 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_app_statistic.hpp>
 
 #include <unistd.h>
-#include <sstream>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
 using namespace std;
 
 #include <srs_rtmp_stack.hpp>
@@ -41,6 +44,78 @@ int64_t srs_generate_id()
     return srs_gvid++;
 }
 
+// escape the label value of prometheus, the backslash, double-quote and line feed.
+static string srs_metrics_escape(const string& v)
+{
+    string escaped;
+    
+    for (int i = 0; i < (int)v.length(); i++) {
+        char ch = v.at(i);
+        if (ch == '\\' || ch == '"') {
+            escaped.append(1, '\\');
+            escaped.append(1, ch);
+        } else if (ch == '\n') {
+            escaped.append("\\n");
+        } else {
+            escaped.append(1, ch);
+        }
+    }
+    
+    return escaped;
+}
+
+SrsConsumerStat::SrsConsumerStat()
+{
+    cid = -1;
+    nb_enqueued = 0;
+    nb_drops = 0;
+    nb_shrinks = 0;
+    nb_dumps = 0;
+    nb_dumped = 0;
+    nb_wakeups = 0;
+    max_duration = 0;
+}
+
+SrsConsumerStat::~SrsConsumerStat()
+{
+}
+
+void SrsConsumerStat::add(SrsConsumerStat* other)
+{
+    nb_enqueued += other->nb_enqueued;
+    nb_drops += other->nb_drops;
+    nb_shrinks += other->nb_shrinks;
+    nb_dumps += other->nb_dumps;
+    nb_dumped += other->nb_dumped;
+    nb_wakeups += other->nb_wakeups;
+    max_duration = srs_max(max_duration, other->max_duration);
+}
+
+double SrsConsumerStat::avg_batch()
+{
+    if (nb_dumps <= 0) {
+        return 0;
+    }
+    return (double)nb_dumped / nb_dumps;
+}
+
+int SrsConsumerStat::dumps(SrsJsonWriter* json)
+{
+    int ret = ERROR_SUCCESS;
+    
+    json->object_start();
+    json->field_int("enqueued", nb_enqueued);
+    json->field_int("drops", nb_drops);
+    json->field_int("shrinks", nb_shrinks);
+    json->field_int("dumps", nb_dumps);
+    json->field_number("avg_batch", avg_batch());
+    json->field_int("wakeups", nb_wakeups);
+    json->field_int("max_duration", max_duration);
+    json->object_end();
+    
+    return ret;
+}
+
 SrsStatisticVhost::SrsStatisticVhost()
 {
     id = srs_generate_id();
@@ -57,7 +132,7 @@ SrsStatisticVhost::~SrsStatisticVhost()
     srs_freep(kbps);
 }
 
-int SrsStatisticVhost::dumps(stringstream& ss)
+int SrsStatisticVhost::dumps(SrsJsonWriter* json)
 {
     int ret = ERROR_SUCCESS;
     
@@ -65,26 +140,28 @@ int SrsStatisticVhost::dumps(stringstream& ss)
     bool hls_enabled = _srs_config->get_hls_enabled(vhost);
     bool enabled = _srs_config->get_vhost_enabled(vhost);
     
-    ss << SRS_JOBJECT_START
-            << SRS_JFIELD_ORG("id", id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("name", vhost) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("enabled", enabled) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("clients", nb_clients) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("streams", nb_streams) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("send_bytes", kbps->get_send_bytes()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("recv_bytes", kbps->get_recv_bytes()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_OBJ("kbps")
-                << SRS_JFIELD_ORG("recv_30s", kbps->get_recv_kbps_30s()) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("send_30s", kbps->get_send_kbps_30s())
-            << SRS_JOBJECT_END << SRS_JFIELD_CONT
-            << SRS_JFIELD_NAME("hls") << SRS_JOBJECT_START
-                << SRS_JFIELD_BOOL("enabled", hls_enabled);
+    json->object_start();
+    json->field_int("id", id);
+    json->field_str("name", vhost);
+    json->field_bool("enabled", enabled);
+    json->field_int("clients", nb_clients);
+    json->field_int("streams", nb_streams);
+    json->field_int("send_bytes", kbps->get_send_bytes());
+    json->field_int("recv_bytes", kbps->get_recv_bytes());
+    
+    json->field_obj("kbps");
+    json->field_int("recv_30s", kbps->get_recv_kbps_30s());
+    json->field_int("send_30s", kbps->get_send_kbps_30s());
+    json->object_end();
+    
+    json->field_obj("hls");
+    json->field_bool("enabled", hls_enabled);
     if (hls_enabled) {
-        ss                                                  << SRS_JFIELD_CONT;
-        ss      << SRS_JFIELD_ORG("fragment", _srs_config->get_hls_fragment(vhost));
+        json->field_number("fragment", _srs_config->get_hls_fragment(vhost));
     }
-    ss      << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
+    json->object_end();
+    
+    json->object_end();
     
     return ret;
 }
@@ -119,56 +196,80 @@ SrsStatisticStream::~SrsStatisticStream()
     srs_freep(kbps);
 }
 
-int SrsStatisticStream::dumps(stringstream& ss)
+int SrsStatisticStream::dumps(SrsJsonWriter* json)
 {
     int ret = ERROR_SUCCESS;
     
-    ss << SRS_JOBJECT_START
-            << SRS_JFIELD_ORG("id", id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("name", stream) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("vhost", vhost->id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("app", app) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("live_ms", srs_get_system_time_ms()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("clients", nb_clients) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("frames", nb_frames) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("send_bytes", kbps->get_send_bytes()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("recv_bytes", kbps->get_recv_bytes()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_OBJ("kbps")
-                << SRS_JFIELD_ORG("recv_30s", kbps->get_recv_kbps_30s()) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("send_30s", kbps->get_send_kbps_30s())
-            << SRS_JOBJECT_END << SRS_JFIELD_CONT
-            << SRS_JFIELD_OBJ("publish")
-                << SRS_JFIELD_BOOL("active", active) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("cid", connection_cid)
-            << SRS_JOBJECT_END << SRS_JFIELD_CONT;
+    json->object_start();
+    json->field_int("id", id);
+    json->field_str("name", stream);
+    json->field_int("vhost", vhost->id);
+    json->field_str("app", app);
+    json->field_int("live_ms", srs_get_system_time_ms());
+    json->field_int("clients", nb_clients);
+    json->field_int("frames", nb_frames);
+    json->field_int("send_bytes", kbps->get_send_bytes());
+    json->field_int("recv_bytes", kbps->get_recv_bytes());
+    
+    json->field_obj("kbps");
+    json->field_int("recv_30s", kbps->get_recv_kbps_30s());
+    json->field_int("send_30s", kbps->get_send_kbps_30s());
+    json->object_end();
+    
+    json->field_obj("publish");
+    json->field_bool("active", active);
+    json->field_int("cid", connection_cid);
+    json->object_end();
+    
+    if (true) {
+        SrsConsumerStat cs;
+        consumer_stat(&cs);
+        
+        json->name("queue");
+        if ((ret = cs.dumps(json)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
     
     if (!has_video) {
-        ss  << SRS_JFIELD_NULL("video") << SRS_JFIELD_CONT;
+        json->field_null("video");
     } else {
-        ss  << SRS_JFIELD_NAME("video") << SRS_JOBJECT_START
-                << SRS_JFIELD_STR("codec", srs_codec_video2str(vcodec)) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("profile", srs_codec_avc_profile2str(avc_profile)) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("level", srs_codec_avc_level2str(avc_level))
-                << SRS_JOBJECT_END
-            << SRS_JFIELD_CONT;
+        json->field_obj("video");
+        json->field_str("codec", srs_codec_video2str(vcodec));
+        json->field_str("profile", srs_codec_avc_profile2str(avc_profile));
+        json->field_str("level", srs_codec_avc_level2str(avc_level));
+        json->object_end();
     }
     
     if (!has_audio) {
-        ss  << SRS_JFIELD_NULL("audio");
+        json->field_null("audio");
     } else {
-        ss  << SRS_JFIELD_NAME("audio") << SRS_JOBJECT_START
-                << SRS_JFIELD_STR("codec", srs_codec_audio2str(acodec)) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("sample_rate", (int)flv_sample_rates[asample_rate]) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("channel", (int)asound_type + 1) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("profile", srs_codec_aac_object2str(aac_object))
-            << SRS_JOBJECT_END;
+        json->field_obj("audio");
+        json->field_str("codec", srs_codec_audio2str(acodec));
+        json->field_int("sample_rate", flv_sample_rates[asample_rate]);
+        json->field_int("channel", (int)asound_type + 1);
+        json->field_str("profile", srs_codec_aac_object2str(aac_object));
+        json->object_end();
     }
     
-    ss << SRS_JOBJECT_END;
+    json->object_end();
     
     return ret;
 }
 
+void SrsStatisticStream::consumer_stat(SrsConsumerStat* stat)
+{
+    stat->add(&consumers);
+    
+    std::map<int, SrsStatisticClient*>::iterator it;
+    for (it = clients.begin(); it != clients.end(); it++) {
+        SrsStatisticClient* client = it->second;
+        if (client->consumer) {
+            stat->add(client->consumer);
+        }
+    }
+}
+
 void SrsStatisticStream::publish(int cid)
 {
     connection_cid = cid;
@@ -194,33 +295,134 @@ SrsStatisticClient::SrsStatisticClient()
     req = NULL;
     type = SrsRtmpConnUnknown;
     create = srs_get_system_time_ms();
+    consumer = NULL;
 }
 
 SrsStatisticClient::~SrsStatisticClient()
 {
 }
 
-int SrsStatisticClient::dumps(stringstream& ss)
+int SrsStatisticClient::dumps(SrsJsonWriter* json)
 {
     int ret = ERROR_SUCCESS;
     
-    ss << SRS_JOBJECT_START
-            << SRS_JFIELD_ORG("id", id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("vhost", stream->vhost->id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("stream", stream->id) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("ip", req->ip) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("pageUrl", req->pageUrl) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("swfUrl", req->swfUrl) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("tcUrl", req->tcUrl) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("url", req->get_stream_url()) << SRS_JFIELD_CONT
-            << SRS_JFIELD_STR("type", srs_client_type_string(type)) << SRS_JFIELD_CONT
-            << SRS_JFIELD_BOOL("publish", srs_client_type_is_publish(type)) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("alive", srs_get_system_time_ms() - create)
-        << SRS_JOBJECT_END;
+    json->object_start();
+    json->field_int("id", id);
+    json->field_int("vhost", stream->vhost->id);
+    json->field_int("stream", stream->id);
+    json->field_str("ip", req->ip);
+    json->field_str("pageUrl", req->pageUrl);
+    json->field_str("swfUrl", req->swfUrl);
+    json->field_str("tcUrl", req->tcUrl);
+    json->field_str("url", req->get_stream_url());
+    json->field_str("type", srs_client_type_string(type));
+    json->field_bool("publish", srs_client_type_is_publish(type));
+    json->field_int("alive", srs_get_system_time_ms() - create);
+    
+    if (!consumer) {
+        json->field_null("queue");
+    } else {
+        json->name("queue");
+        if ((ret = consumer->dumps(json)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    json->object_end();
     
     return ret;
 }
 
+SrsStatisticStreamSnapshot::SrsStatisticStreamSnapshot()
+{
+    active = false;
+    recv_kbps = send_kbps = 0;
+    nb_clients = 0;
+    vcodec = SrsCodecVideoReserved;
+    acodec = SrsCodecAudioReserved1;
+}
+
+bool SrsStatisticStreamSnapshot::changed(SrsStatisticStreamSnapshot& last)
+{
+    if (active != last.active || nb_clients != last.nb_clients) {
+        return true;
+    }
+    
+    if (vcodec != last.vcodec || acodec != last.acodec) {
+        return true;
+    }
+    
+    // the kbps always jitter a little, ignore the change under threshold.
+    int recv_threshold = srs_max(SRS_STAT_DELTA_KBPS_MIN, last.recv_kbps * SRS_STAT_DELTA_KBPS_PERCENT / 100);
+    int send_threshold = srs_max(SRS_STAT_DELTA_KBPS_MIN, last.send_kbps * SRS_STAT_DELTA_KBPS_PERCENT / 100);
+    if (::abs(recv_kbps - last.recv_kbps) >= recv_threshold || ::abs(send_kbps - last.send_kbps) >= send_threshold) {
+        return true;
+    }
+    
+    return false;
+}
+
+SrsMetricsBuffer::SrsMetricsBuffer(int size)
+{
+    capacity = srs_max(size, 1024);
+    buf = new char[capacity];
+    length = 0;
+}
+
+SrsMetricsBuffer::~SrsMetricsBuffer()
+{
+    srs_freepa(buf);
+}
+
+void SrsMetricsBuffer::reset()
+{
+    length = 0;
+}
+
+char* SrsMetricsBuffer::bytes()
+{
+    return buf;
+}
+
+int SrsMetricsBuffer::size()
+{
+    return length;
+}
+
+void SrsMetricsBuffer::append(const char* fmt, ...)
+{
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int nb = vsnprintf(buf + length, capacity - length, fmt, ap);
+        va_end(ap);
+        
+        if (nb < 0) {
+            return;
+        }
+        
+        // ok, the text fit in the buffer.
+        if (nb < capacity - length) {
+            length += nb;
+            return;
+        }
+        
+        // grow the buffer, at least double it.
+        int new_capacity = srs_max(capacity * 2, length + nb + 1);
+        char* new_buf = new char[new_capacity];
+        memcpy(new_buf, buf, length);
+        srs_freepa(buf);
+        
+        buf = new_buf;
+        capacity = new_capacity;
+    }
+}
+
+void SrsMetricsBuffer::family(const char* name, const char* type, const char* help)
+{
+    append("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
 SrsStatistic* SrsStatistic::_instance = new SrsStatistic();
 
 SrsStatistic::SrsStatistic()
@@ -229,6 +431,17 @@ SrsStatistic::SrsStatistic()
     
     kbps = new SrsKbps();
     kbps->set_io(NULL, NULL);
+    
+    nb_accepts = 0;
+    accept_rate = 0;
+    sleep_overshoot = 0;
+    max_sleep_overshoot = 0;
+    sample_time = 0;
+    sample_accepts = 0;
+    
+    nb_queue_shrinks = 0;
+    nb_queue_drops = 0;
+    nb_send_errors = 0;
 }
 
 SrsStatistic::~SrsStatistic()
@@ -371,6 +584,8 @@ int SrsStatistic::on_client(int id, SrsRequest* req, SrsConnection* conn, SrsRtm
         client->id = id;
         client->stream = stream;
         clients[id] = client;
+        stream->clients[id] = client;
+        vhost->clients[id] = client;
     } else {
         client = clients[id];
     }
@@ -398,6 +613,8 @@ void SrsStatistic::on_disconnect(int id)
     
     srs_freep(client);
     clients.erase(it);
+    stream->clients.erase(id);
+    vhost->clients.erase(id);
     
     stream->nb_clients--;
     vhost->nb_clients--;
@@ -406,11 +623,12 @@ void SrsStatistic::on_disconnect(int id)
 void SrsStatistic::kbps_add_delta(SrsConnection* conn)
 {
     int id = conn->srs_id();
-    if (clients.find(id) == clients.end()) {
+    std::map<int, SrsStatisticClient*>::iterator it = clients.find(id);
+    if (it == clients.end()) {
         return;
     }
     
-    SrsStatisticClient* client = clients[id];
+    SrsStatisticClient* client = it->second;
     
     // resample the kbps to collect the delta.
     conn->resample();
@@ -446,78 +664,355 @@ SrsKbps* SrsStatistic::kbps_sample()
     return kbps;
 }
 
+void SrsStatistic::on_accept(int nb_clients)
+{
+    nb_accepts += nb_clients;
+}
+
+void SrsStatistic::on_cycle(int64_t overshoot)
+{
+    sleep_overshoot = overshoot;
+    max_sleep_overshoot = srs_max(max_sleep_overshoot, overshoot);
+    
+    int64_t now = srs_get_system_time_ms();
+    if (sample_time > 0 && now > sample_time) {
+        accept_rate = (int)((nb_accepts - sample_accepts) * 1000 / (now - sample_time));
+    }
+    
+    sample_time = now;
+    sample_accepts = nb_accepts;
+}
+
+void SrsStatistic::on_queue_shrink(int nb_drops)
+{
+    nb_queue_shrinks++;
+    nb_queue_drops += nb_drops;
+}
+
+void SrsStatistic::on_send_error()
+{
+    nb_send_errors++;
+}
+
+void SrsStatistic::on_consumer(SrsRequest* req, SrsConnection* conn, SrsConsumerStat* cs)
+{
+    cs->cid = conn? conn->srs_id() : -1;
+    
+    std::map<int, SrsStatisticClient*>::iterator it;
+    if ((it = clients.find(cs->cid)) != clients.end()) {
+        SrsStatisticClient* client = it->second;
+        client->consumer = cs;
+    }
+}
+
+void SrsStatistic::on_consumer_close(SrsRequest* req, SrsConsumerStat* cs)
+{
+    if (true) {
+        std::map<int, SrsStatisticClient*>::iterator it;
+        if ((it = clients.find(cs->cid)) != clients.end()) {
+            SrsStatisticClient* client = it->second;
+            if (client->consumer == cs) {
+                client->consumer = NULL;
+            }
+        }
+    }
+    
+    if (true) {
+        std::map<std::string, SrsStatisticStream*>::iterator it;
+        if ((it = rstreams.find(req->get_stream_url())) != rstreams.end()) {
+            SrsStatisticStream* stream = it->second;
+            stream->consumers.add(cs);
+        }
+    }
+}
+
 int64_t SrsStatistic::server_id()
 {
     return _server_id;
 }
 
-int SrsStatistic::dumps_vhosts(stringstream& ss)
+int SrsStatistic::dumps_vhosts(SrsJsonWriter* json)
 {
     int ret = ERROR_SUCCESS;
 
-    ss << SRS_JARRAY_START;
+    json->array_start();
     std::map<int64_t, SrsStatisticVhost*>::iterator it;
     for (it = vhosts.begin(); it != vhosts.end(); it++) {
         SrsStatisticVhost* vhost = it->second;
-        
-        if (it != vhosts.begin()) {
-            ss << SRS_JFIELD_CONT;
-        }
-        
-        if ((ret = vhost->dumps(ss)) != ERROR_SUCCESS) {
+        if ((ret = vhost->dumps(json)) != ERROR_SUCCESS) {
             return ret;
         }
     }
-    ss << SRS_JARRAY_END;
+    json->array_end();
 
     return ret;
 }
 
-int SrsStatistic::dumps_streams(stringstream& ss)
+int SrsStatistic::dumps_streams(SrsJsonWriter* json)
 {
     int ret = ERROR_SUCCESS;
     
-    ss << SRS_JARRAY_START;
+    json->array_start();
     std::map<int64_t, SrsStatisticStream*>::iterator it;
     for (it = streams.begin(); it != streams.end(); it++) {
         SrsStatisticStream* stream = it->second;
-        
-        if (it != streams.begin()) {
-            ss << SRS_JFIELD_CONT;
+        if ((ret = stream->dumps(json)) != ERROR_SUCCESS) {
+            return ret;
         }
+    }
+    json->array_end();
+    
+    return ret;
+}
 
-        if ((ret = stream->dumps(ss)) != ERROR_SUCCESS) {
+int SrsStatistic::dumps_clients(SrsJsonWriter* json, int cursor, int count,
+    SrsStatisticVhost* vhost, SrsStatisticStream* stream, int& next)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // use the smallest index to filter clients.
+    std::map<int, SrsStatisticClient*>* index = &clients;
+    if (stream) {
+        index = &stream->clients;
+    } else if (vhost) {
+        index = &vhost->clients;
+    }
+    
+    next = -1;
+    
+    json->array_start();
+    std::map<int, SrsStatisticClient*>::iterator it = index->upper_bound(cursor);
+    for (int i = 0; i < count && it != index->end(); it++, i++) {
+        SrsStatisticClient* client = it->second;
+        if ((ret = client->dumps(json)) != ERROR_SUCCESS) {
             return ret;
         }
+        
+        next = client->id;
+    }
+    json->array_end();
+    
+    // no more clients.
+    if (it == index->end()) {
+        next = -1;
     }
-    ss << SRS_JARRAY_END;
     
     return ret;
 }
 
-int SrsStatistic::dumps_clients(stringstream& ss, int start, int count)
+int SrsStatistic::dumps_streams_delta(SrsJsonWriter* json, std::map<int64_t, SrsStatisticStreamSnapshot>& snapshots, int& nb_changed)
 {
     int ret = ERROR_SUCCESS;
     
-    ss << SRS_JARRAY_START;
-    std::map<int, SrsStatisticClient*>::iterator it = clients.begin();
-    for (int i = 0; i < start + count && it != clients.end(); it++, i++) {
-        if (i < start) {
+    nb_changed = 0;
+    
+    json->array_start();
+    std::map<int64_t, SrsStatisticStream*>::iterator it;
+    for (it = streams.begin(); it != streams.end(); it++) {
+        SrsStatisticStream* stream = it->second;
+        
+        SrsStatisticStreamSnapshot now;
+        now.active = stream->active;
+        now.recv_kbps = stream->kbps->get_recv_kbps_30s();
+        now.send_kbps = stream->kbps->get_send_kbps_30s();
+        now.nb_clients = stream->nb_clients;
+        now.vcodec = stream->has_video? stream->vcodec : SrsCodecVideoReserved;
+        now.acodec = stream->has_audio? stream->acodec : SrsCodecAudioReserved1;
+        
+        // ignore the stream not changed.
+        std::map<int64_t, SrsStatisticStreamSnapshot>::iterator found = snapshots.find(stream->id);
+        if (found != snapshots.end() && !now.changed(found->second)) {
             continue;
         }
+        snapshots[stream->id] = now;
+        nb_changed++;
         
-        SrsStatisticClient* client = it->second;
+        json->object_start();
+        json->field_int("id", stream->id);
+        json->field_bool("active", now.active);
+        json->field_int("clients", now.nb_clients);
+        json->field_int("frames", stream->nb_frames);
+        json->field_obj("kbps");
+        json->field_int("recv_30s", now.recv_kbps);
+        json->field_int("send_30s", now.send_kbps);
+        json->object_end();
+        json->object_end();
+    }
+    json->array_end();
+    
+    // erase the snapshots of streams which are gone.
+    std::map<int64_t, SrsStatisticStreamSnapshot>::iterator sit;
+    for (sit = snapshots.begin(); sit != snapshots.end();) {
+        if (streams.find(sit->first) == streams.end()) {
+            snapshots.erase(sit++);
+        } else {
+            ++sit;
+        }
+    }
+    
+    return ret;
+}
+
+int SrsStatistic::dumps_server(SrsJsonWriter* json)
+{
+    int ret = ERROR_SUCCESS;
+    
+    json->field_int("accepts", nb_accepts);
+    json->field_int("accept_rate", accept_rate);
+    json->field_int("sleep_overshoot_us", sleep_overshoot);
+    json->field_int("sleep_overshoot_max_us", max_sleep_overshoot);
+    json->field_int("queue_shrinks", nb_queue_shrinks);
+    json->field_int("queue_drops", nb_queue_drops);
+    json->field_int("send_errors", nb_send_errors);
+    
+    return ret;
+}
+
+int SrsStatistic::dumps_metrics(SrsMetricsBuffer* mb, int max_streams)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // the server metrics.
+    if (true) {
+        mb->family("srs_clients", "gauge", "The number of clients.");
+        mb->append("srs_clients %d\n", (int)clients.size());
+        
+        // the clients of each type, index by SrsRtmpConnType.
+        int nb_types[SrsRtmpConnHaivisionPublish + 1];
+        memset(nb_types, 0, sizeof(nb_types));
         
-        if (i != start) {
-            ss << SRS_JFIELD_CONT;
+        std::map<int, SrsStatisticClient*>::iterator it;
+        for (it = clients.begin(); it != clients.end(); it++) {
+            SrsStatisticClient* client = it->second;
+            if (client->type >= SrsRtmpConnUnknown && client->type <= SrsRtmpConnHaivisionPublish) {
+                nb_types[client->type]++;
+            }
         }
         
-        if ((ret = client->dumps(ss)) != ERROR_SUCCESS) {
-            return ret;
+        mb->family("srs_clients_by_type", "gauge", "The number of clients by connection type.");
+        for (int i = SrsRtmpConnUnknown; i <= SrsRtmpConnHaivisionPublish; i++) {
+            mb->append("srs_clients_by_type{type=\"%s\"} %d\n", srs_client_type_string((SrsRtmpConnType)i).c_str(), nb_types[i]);
         }
+        
+        mb->family("srs_streams", "gauge", "The number of streams.");
+        mb->append("srs_streams %d\n", (int)streams.size());
+        mb->family("srs_accepts_total", "counter", "The total accepted clients.");
+        mb->append("srs_accepts_total %"PRId64"\n", nb_accepts);
+        mb->family("srs_sleep_overshoot_us", "gauge", "The overshoot in us of server cycle sleep, of last sample.");
+        mb->append("srs_sleep_overshoot_us %"PRId64"\n", sleep_overshoot);
+        mb->family("srs_send_bytes_total", "counter", "The total bytes sent by server.");
+        mb->append("srs_send_bytes_total %"PRId64"\n", kbps->get_send_bytes());
+        mb->family("srs_recv_bytes_total", "counter", "The total bytes received by server.");
+        mb->append("srs_recv_bytes_total %"PRId64"\n", kbps->get_recv_bytes());
+        mb->family("srs_send_kbps", "gauge", "The send kbps of server in 30s.");
+        mb->append("srs_send_kbps %d\n", kbps->get_send_kbps_30s());
+        mb->family("srs_recv_kbps", "gauge", "The recv kbps of server in 30s.");
+        mb->append("srs_recv_kbps %d\n", kbps->get_recv_kbps_30s());
+        mb->family("srs_queue_shrinks_total", "counter", "The total shrink of message queues.");
+        mb->append("srs_queue_shrinks_total %"PRId64"\n", nb_queue_shrinks);
+        mb->family("srs_queue_drops_total", "counter", "The total messages dropped by queue shrink.");
+        mb->append("srs_queue_drops_total %"PRId64"\n", nb_queue_drops);
+        mb->family("srs_send_errors_total", "counter", "The total failed send, exclude timeout.");
+        mb->append("srs_send_errors_total %"PRId64"\n", nb_send_errors);
     }
-    ss << SRS_JARRAY_END;
     
+    // the vhost metrics, the labels is vhost.
+    if (true) {
+        static const char* families[][3] = {
+            {"srs_vhost_clients", "gauge", "The number of clients of vhost."},
+            {"srs_vhost_streams", "gauge", "The number of streams of vhost."},
+            {"srs_vhost_send_bytes_total", "counter", "The total bytes sent of vhost."},
+            {"srs_vhost_recv_bytes_total", "counter", "The total bytes received of vhost."},
+            {"srs_vhost_send_kbps", "gauge", "The send kbps of vhost in 30s."},
+            {"srs_vhost_recv_kbps", "gauge", "The recv kbps of vhost in 30s."}
+        };
+        
+        for (int i = 0; i < (int)(sizeof(families) / sizeof(families[0])); i++) {
+            mb->family(families[i][0], families[i][1], families[i][2]);
+            
+            std::map<int64_t, SrsStatisticVhost*>::iterator it;
+            for (it = vhosts.begin(); it != vhosts.end(); it++) {
+                SrsStatisticVhost* vhost = it->second;
+                
+                int64_t v = 0;
+                switch (i) {
+                    case 0: v = vhost->nb_clients; break;
+                    case 1: v = vhost->nb_streams; break;
+                    case 2: v = vhost->kbps->get_send_bytes(); break;
+                    case 3: v = vhost->kbps->get_recv_bytes(); break;
+                    case 4: v = vhost->kbps->get_send_kbps_30s(); break;
+                    default: v = vhost->kbps->get_recv_kbps_30s(); break;
+                }
+                
+                mb->append("%s{%s} %"PRId64"\n", families[i][0], vhost->labels.c_str(), v);
+            }
+        }
+    }
+    
+    // the stream metrics, the labels is vhost, app and stream.
+    if (true) {
+        static const char* families[][3] = {
+            {"srs_stream_active", "gauge", "Whether the stream is publishing."},
+            {"srs_stream_clients", "gauge", "The number of clients of stream."},
+            {"srs_stream_frames_total", "counter", "The total video frames of stream."},
+            {"srs_stream_send_bytes_total", "counter", "The total bytes sent of stream."},
+            {"srs_stream_recv_bytes_total", "counter", "The total bytes received of stream."},
+            {"srs_stream_send_kbps", "gauge", "The send kbps of stream in 30s."},
+            {"srs_stream_recv_kbps", "gauge", "The recv kbps of stream in 30s."},
+            {"srs_stream_queue_enqueued_total", "counter", "The total msgs enqueued to consumers of stream."},
+            {"srs_stream_queue_drops_total", "counter", "The total msgs dropped by consumers of stream."}
+        };
+        
+        // select the live streams, the closed streams without clients are
+        // left in statistic, which must not take the place of live streams.
+        int nb_lives = 0;
+        metrics_streams.clear();
+        
+        std::map<int64_t, SrsStatisticStream*>::iterator it;
+        for (it = streams.begin(); it != streams.end(); it++) {
+            SrsStatisticStream* stream = it->second;
+            if (!stream->active && stream->nb_clients <= 0) {
+                continue;
+            }
+            
+            nb_lives++;
+            if ((int)metrics_streams.size() < max_streams) {
+                metrics_streams.push_back(stream);
+            }
+        }
+        
+        for (int i = 0; i < (int)(sizeof(families) / sizeof(families[0])); i++) {
+            mb->family(families[i][0], families[i][1], families[i][2]);
+            
+            for (int j = 0; j < (int)metrics_streams.size(); j++) {
+                SrsStatisticStream* stream = metrics_streams.at(j);
+                
+                int64_t v = 0;
+                switch (i) {
+                    case 0: v = stream->active? 1 : 0; break;
+                    case 1: v = stream->nb_clients; break;
+                    case 2: v = (int64_t)stream->nb_frames; break;
+                    case 3: v = stream->kbps->get_send_bytes(); break;
+                    case 4: v = stream->kbps->get_recv_bytes(); break;
+                    case 5: v = stream->kbps->get_send_kbps_30s(); break;
+                    case 6: v = stream->kbps->get_recv_kbps_30s(); break;
+                    default: {
+                        SrsConsumerStat cs;
+                        stream->consumer_stat(&cs);
+                        v = (i == 7)? cs.nb_enqueued : cs.nb_drops;
+                        break;
+                    }
+                }
+                
+                mb->append("%s{%s} %"PRId64"\n", families[i][0], stream->labels.c_str(), v);
+            }
+        }
+        
+        // the live streams exceed the cardinality limit.
+        int nb_truncated = nb_lives - (int)metrics_streams.size();
+        mb->family("srs_metrics_streams_truncated", "gauge", "The live streams not dumped for the cardinality limit.");
+        mb->append("srs_metrics_streams_truncated %d\n", nb_truncated);
+    }
     
     return ret;
 }
@@ -530,6 +1025,7 @@ SrsStatisticVhost* SrsStatistic::create_vhost(SrsRequest* req)
     if (rvhosts.find(req->vhost) == rvhosts.end()) {
         vhost = new SrsStatisticVhost();
         vhost->vhost = req->vhost;
+        vhost->labels = "vhost=\"" + srs_metrics_escape(req->vhost) + "\"";
         rvhosts[req->vhost] = vhost;
         vhosts[vhost->id] = vhost;
         return vhost;
@@ -553,6 +1049,9 @@ SrsStatisticStream* SrsStatistic::create_stream(SrsStatisticVhost* vhost, SrsReq
         stream->stream = req->stream;
         stream->app = req->app;
         stream->url = url;
+        stream->labels = "vhost=\"" + srs_metrics_escape(vhost->vhost)
+            + "\",app=\"" + srs_metrics_escape(req->app)
+            + "\",stream=\"" + srs_metrics_escape(req->stream) + "\"";
         rstreams[url] = stream;
         streams[stream->id] = stream;
         return stream;
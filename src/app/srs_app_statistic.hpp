@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_core.hpp>
 
 #include <map>
+#include <vector>
 #include <string>
 
 #include <srs_kernel_codec.hpp>
@@ -39,6 +40,45 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 class SrsKbps;
 class SrsRequest;
 class SrsConnection;
+class SrsJsonWriter;
+struct SrsStatisticClient;
+
+/**
+ * the queue counters of consumer, to tune the queue_length and mw_sleep.
+ * @remark the consumer own the object, the statistic only reference it.
+ */
+struct SrsConsumerStat
+{
+public:
+    // the client id of consumer, -1 if no connection, for example, http flv.
+    int cid;
+    // the total msgs enqueued.
+    int64_t nb_enqueued;
+    // the msgs dropped by queue shrink.
+    int64_t nb_drops;
+    // the number of queue shrink.
+    int64_t nb_shrinks;
+    // the number of dump packets which got msgs, and the total msgs dumped.
+    int64_t nb_dumps;
+    int64_t nb_dumped;
+    // the number of wakeup from the wait of msgs.
+    int64_t nb_wakeups;
+    // the max duration in ms of queue.
+    int max_duration;
+public:
+    SrsConsumerStat();
+    virtual ~SrsConsumerStat();
+public:
+    /**
+     * accumulate the counters of other consumer.
+     */
+    virtual void add(SrsConsumerStat* other);
+    /**
+     * the average msgs of each dump packets.
+     */
+    virtual double avg_batch();
+    virtual int dumps(SrsJsonWriter* json);
+};
 
 struct SrsStatisticVhost
 {
@@ -47,6 +87,11 @@ public:
     std::string vhost;
     int nb_streams;
     int nb_clients;
+    // key: client id, value: client object.
+    // @remark the index of clients of vhost.
+    std::map<int, SrsStatisticClient*> clients;
+    // the escaped prometheus labels, cached to avoid build it for each scrape.
+    std::string labels;
 public:
     /**
     * vhost total kbps.
@@ -56,7 +101,7 @@ public:
     SrsStatisticVhost();
     virtual ~SrsStatisticVhost();
 public:
-    virtual int dumps(std::stringstream& ss);
+    virtual int dumps(SrsJsonWriter* json);
 };
 
 struct SrsStatisticStream
@@ -71,6 +116,14 @@ public:
     int connection_cid;
     int nb_clients;
     uint64_t nb_frames;
+    // key: client id, value: client object.
+    // @remark the index of clients of stream.
+    std::map<int, SrsStatisticClient*> clients;
+    // the escaped prometheus labels, cached to avoid build it for each scrape.
+    std::string labels;
+    // the queue counters of closed consumers,
+    // the alive consumers are accumulated by clients when dumps.
+    SrsConsumerStat consumers;
 public:
     /**
     * stream total kbps.
@@ -99,7 +152,11 @@ public:
     SrsStatisticStream();
     virtual ~SrsStatisticStream();
 public:
-    virtual int dumps(std::stringstream& ss);
+    virtual int dumps(SrsJsonWriter* json);
+    /**
+     * get the queue counters of all consumers, closed and alive.
+     */
+    virtual void consumer_stat(SrsConsumerStat* stat);
 public:
     /**
     * publish the stream.
@@ -120,11 +177,75 @@ public:
     SrsRtmpConnType type;
     int id;
     int64_t create;
+    // the queue counters of alive consumer, NULL when not playing.
+    SrsConsumerStat* consumer;
 public:
     SrsStatisticClient();
     virtual ~SrsStatisticClient();
 public:
-    virtual int dumps(std::stringstream& ss);
+    virtual int dumps(SrsJsonWriter* json);
+};
+
+// the kbps of stream changed only when exceed the percent of last kbps,
+// and at least the min kbps, for the kbps always jitter a little.
+#define SRS_STAT_DELTA_KBPS_PERCENT 10
+#define SRS_STAT_DELTA_KBPS_MIN 8
+
+/**
+ * the snapshot of stream state, to find the changed streams.
+ * @remark the frames always increase for a publishing stream,
+ *      so it's dumped but never compared.
+ */
+struct SrsStatisticStreamSnapshot
+{
+public:
+    bool active;
+    int recv_kbps;
+    int send_kbps;
+    int nb_clients;
+    SrsCodecVideo vcodec;
+    SrsCodecAudio acodec;
+public:
+    SrsStatisticStreamSnapshot();
+public:
+    /**
+     * whether the stream changed from last snapshot,
+     * the kbps is changed only when exceed the threshold.
+     */
+    bool changed(SrsStatisticStreamSnapshot& last);
+};
+
+/**
+ * the output buffer of prometheus text format, which is reused
+ * for each scrape, only grow when the metrics exceed the capacity.
+ * @see https://prometheus.io/docs/instrumenting/exposition_formats/
+ */
+class SrsMetricsBuffer
+{
+private:
+    char* buf;
+    int capacity;
+    int length;
+public:
+    SrsMetricsBuffer(int size);
+    virtual ~SrsMetricsBuffer();
+public:
+    /**
+     * reset the buffer to empty, the memory is reserved.
+     */
+    virtual void reset();
+    virtual char* bytes();
+    virtual int size();
+public:
+    /**
+     * append the formated text to buffer, grow when full.
+     */
+    virtual void append(const char* fmt, ...);
+    /**
+     * append the HELP and TYPE line of metric family.
+     * @param type the metric type, counter or gauge.
+     */
+    virtual void family(const char* name, const char* type, const char* help);
 };
 
 class SrsStatistic
@@ -150,6 +271,26 @@ private:
     std::map<int, SrsStatisticClient*> clients;
     // server total kbps.
     SrsKbps* kbps;
+    // the live streams to dump metrics, reused for each scrape.
+    std::vector<SrsStatisticStream*> metrics_streams;
+private:
+    // the total accepted clients.
+    int64_t nb_accepts;
+    // the accept rate in clients per second, of last sample.
+    int accept_rate;
+    // the overshoot in us of the server cycle sleep, of last sample.
+    int64_t sleep_overshoot;
+    // the max overshoot in us of the server cycle sleep, since server start.
+    int64_t max_sleep_overshoot;
+    // the last sample time in ms and the accepted clients.
+    int64_t sample_time;
+    int64_t sample_accepts;
+private:
+    // the total shrink of queues, and the msgs dropped by shrink.
+    int64_t nb_queue_shrinks;
+    int64_t nb_queue_drops;
+    // the total failed send, exclude the timeout.
+    int64_t nb_send_errors;
 private:
     SrsStatistic();
     virtual ~SrsStatistic();
@@ -215,6 +356,37 @@ public:
     * @return the server kbps.
     */
     virtual SrsKbps* kbps_sample();
+    /**
+     * when listener accept clients.
+     * @param nb_clients the number of clients accepted in a batch.
+     */
+    virtual void on_accept(int nb_clients);
+    /**
+     * when server cycle wakeup from sleep, sample the accept rate.
+     * @param overshoot the time in us the wakeup later than the sleep,
+     *      that is, the sleep timer overshoot, which grows when other threads
+     *      busy, but is a coarse sample per cycle, not the run queue delay.
+     */
+    virtual void on_cycle(int64_t overshoot);
+    /**
+     * when message queue shrink, drop the msgs except the sequence header.
+     * @param nb_drops the number of msgs dropped.
+     */
+    virtual void on_queue_shrink(int nb_drops);
+    /**
+     * when send to client failed, exclude the timeout.
+     */
+    virtual void on_send_error();
+    /**
+     * when consumer created for stream.
+     * @param conn the connection of consumer, NULL for http flv.
+     * @param cs the queue counters of consumer, owned by consumer.
+     */
+    virtual void on_consumer(SrsRequest* req, SrsConnection* conn, SrsConsumerStat* cs);
+    /**
+     * when consumer destroy, accumulate the counters to stream.
+     */
+    virtual void on_consumer_close(SrsRequest* req, SrsConsumerStat* cs);
 public:
     /**
     * get the server id, used to identify the server.
@@ -222,19 +394,42 @@ public:
     */
     virtual int64_t server_id();
     /**
-    * dumps the vhosts to sstream in json.
+    * dumps the vhosts to json writer.
     */
-    virtual int dumps_vhosts(std::stringstream& ss);
+    virtual int dumps_vhosts(SrsJsonWriter* json);
     /**
-    * dumps the streams to sstream in json.
+    * dumps the streams to json writer.
     */
-    virtual int dumps_streams(std::stringstream& ss);
+    virtual int dumps_streams(SrsJsonWriter* json);
+    /**
+     * dumps the clients to json writer, paged by cursor.
+     * @param cursor the clients after the cursor(client id) to dump, -1 from the first.
+     * @param count the max count of clients to dump, must be positive.
+     * @param vhost the vhost to filter clients, NULL to ignore.
+     * @param stream the stream to filter clients, NULL to ignore.
+     * @param next output the cursor of next page, -1 if no more clients.
+     */
+    virtual int dumps_clients(SrsJsonWriter* json, int cursor, int count,
+        SrsStatisticVhost* vhost, SrsStatisticStream* stream, int& next);
+    /**
+     * dumps the accept and sleep overshoot stat of server to json fields.
+     */
+    virtual int dumps_server(SrsJsonWriter* json);
+    /**
+     * dumps the changed streams to json writer, compare to the snapshots.
+     * @param snapshots the last snapshots, updated to the current counters,
+     *       the snapshots of streams which are gone are erased.
+     * @param nb_changed output the number of changed streams.
+     */
+    virtual int dumps_streams_delta(SrsJsonWriter* json, std::map<int64_t, SrsStatisticStreamSnapshot>& snapshots, int& nb_changed);
     /**
-     * dumps the clients to sstream in json.
-     * @param start the start index, from 0.
-     * @param count the max count of clients to dump.
+     * dumps the counters and gauges of server, vhosts and streams
+     * in prometheus text format.
+     * @param max_streams the max streams to dumps, to limit the cardinality.
+     * @remark the closed streams without clients are never dumped,
+     *      for the streams are never erased from statistic.
      */
-    virtual int dumps_clients(std::stringstream& ss, int start, int count);
+    virtual int dumps_metrics(SrsMetricsBuffer* mb, int max_streams);
 private:
     virtual SrsStatisticVhost* create_vhost(SrsRequest* req);
     virtual SrsStatisticStream* create_stream(SrsStatisticVhost* vhost, SrsRequest* req);
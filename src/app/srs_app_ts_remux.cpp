@@ -0,0 +1,552 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_app_ts_remux.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_codec.hpp>
+#include <srs_kernel_flv.hpp>
+#include <srs_kernel_ts.hpp>
+#include <srs_rtmp_stack.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_source.hpp>
+#include <srs_core_autofree.hpp>
+
+// when got these audios after last video, clear the gop cache,
+// for the stream maybe pure audio, @see SRS_PURE_AUDIO_GUESS_COUNT.
+#define SRS_TS_PURE_AUDIO_GUESS_COUNT 115
+
+SrsTsBlockWriter::SrsTsBlockWriter()
+{
+    buffer = new SrsSimpleBuffer();
+}
+
+SrsTsBlockWriter::~SrsTsBlockWriter()
+{
+    srs_freep(buffer);
+}
+
+int SrsTsBlockWriter::open(string /*file*/)
+{
+    return ERROR_SUCCESS;
+}
+
+void SrsTsBlockWriter::close()
+{
+}
+
+bool SrsTsBlockWriter::is_open()
+{
+    return true;
+}
+
+int64_t SrsTsBlockWriter::tellg()
+{
+    return buffer->length();
+}
+
+int SrsTsBlockWriter::write(void* buf, size_t count, ssize_t* pnwrite)
+{
+    buffer->append((const char*)buf, (int)count);
+    
+    if (pnwrite) {
+        *pnwrite = count;
+    }
+    
+    return ERROR_SUCCESS;
+}
+
+SrsSharedPtrMessage* SrsTsBlockWriter::detach(int8_t type, int64_t timestamp)
+{
+    int size = buffer->length();
+    if (size <= 0) {
+        return NULL;
+    }
+    
+    char* payload = new char[size];
+    memcpy(payload, buffer->bytes(), size);
+    buffer->erase(size);
+    
+    SrsMessageHeader header;
+    if (type == RTMP_MSG_AudioMessage) {
+        header.initialize_audio(size, (u_int32_t)timestamp, 0);
+    } else if (type == RTMP_MSG_VideoMessage) {
+        header.initialize_video(size, (u_int32_t)timestamp, 0);
+    } else {
+        header.initialize_amf0_script(size, 0);
+        header.timestamp = timestamp;
+    }
+    
+    SrsSharedPtrMessage* block = new SrsSharedPtrMessage();
+    if (block->create(&header, payload, size) != ERROR_SUCCESS) {
+        srs_freepa(payload);
+        srs_freep(block);
+        return NULL;
+    }
+    
+    return block;
+}
+
+ISrsTsRemuxHandler::ISrsTsRemuxHandler()
+{
+}
+
+ISrsTsRemuxHandler::~ISrsTsRemuxHandler()
+{
+}
+
+SrsTsRemuxer::SrsTsRemuxer()
+{
+    req = NULL;
+    handler = NULL;
+    
+    codec = new SrsAvcAacCodec();
+    sample = new SrsCodecSample();
+    cache = new SrsTsCache();
+    context = new SrsTsContext();
+    writer = new SrsTsBlockWriter();
+    
+    vcodec = SrsCodecVideoAVC;
+    acodec = SrsCodecAudioAAC;
+    psi_vcodec = SrsCodecVideoReserved;
+    psi_acodec = SrsCodecAudioReserved1;
+    psi = NULL;
+    
+    enable_gop_cache = true;
+    audio_after_last_video_count = 0;
+}
+
+SrsTsRemuxer::~SrsTsRemuxer()
+{
+    clear_gop_cache();
+    
+    srs_freep(psi);
+    srs_freep(codec);
+    srs_freep(sample);
+    srs_freep(cache);
+    srs_freep(context);
+    srs_freep(writer);
+    
+    // the consumers are owned by the connections.
+    consumers.clear();
+}
+
+int SrsTsRemuxer::initialize(SrsRequest* r, ISrsTsRemuxHandler* h)
+{
+    int ret = ERROR_SUCCESS;
+    
+    req = r;
+    handler = h;
+    
+    return ret;
+}
+
+int SrsTsRemuxer::on_publish()
+{
+    int ret = ERROR_SUCCESS;
+    
+    enable_gop_cache = _srs_config->get_gop_cache(req->vhost);
+    
+    // the default audio codec, the codec in stream will override it.
+    acodec = SrsCodecAudioAAC;
+    std::string default_acodec = _srs_config->get_hls_acodec(req->vhost);
+    if (default_acodec == "mp3") {
+        acodec = SrsCodecAudioMP3;
+    } else if (default_acodec == "an") {
+        acodec = SrsCodecAudioDisabled;
+    }
+    
+    // the video codec, disable it for pure audio.
+    vcodec = SrsCodecVideoAVC;
+    std::string default_vcodec = _srs_config->get_hls_vcodec(req->vhost);
+    if (default_vcodec == "vn") {
+        vcodec = SrsCodecVideoDisabled;
+    }
+    
+    // reset the context to write the PAT/PMT again.
+    psi_vcodec = SrsCodecVideoReserved;
+    psi_acodec = SrsCodecAudioReserved1;
+    context->reset();
+    
+    srs_freep(cache->audio);
+    srs_freep(cache->video);
+    
+    clear_gop_cache();
+    
+    srs_trace("ts: remux publish, vcodec=%d, acodec=%d, gop_cache=%d, consumers=%d",
+        vcodec, acodec, enable_gop_cache, (int)consumers.size());
+    
+    return ret;
+}
+
+void SrsTsRemuxer::on_unpublish()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // the pure audio aggregate some frames, flush it.
+    if ((ret = flush_audio()) != ERROR_SUCCESS) {
+        srs_warn("ts: ignore flush audio failed. ret=%d", ret);
+    }
+    
+    srs_freep(cache->audio);
+    srs_freep(cache->video);
+    
+    clear_gop_cache();
+}
+
+int SrsTsRemuxer::on_audio(SrsSharedPtrMessage* shared_audio)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // when nobody need the ts, only demux the sequence header.
+    if (!is_active() && !SrsFlvCodec::audio_is_sequence_header(shared_audio->payload, shared_audio->size)) {
+        return ret;
+    }
+    
+    sample->clear();
+    if ((ret = codec->audio_aac_demux(shared_audio->payload, shared_audio->size, sample)) != ERROR_SUCCESS) {
+        if (ret != ERROR_HLS_TRY_MP3) {
+            srs_error("ts: aac demux audio failed. ret=%d", ret);
+            return ret;
+        }
+        if ((ret = codec->audio_mp3_demux(shared_audio->payload, shared_audio->size, sample)) != ERROR_SUCCESS) {
+            srs_error("ts: mp3 demux audio failed. ret=%d", ret);
+            return ret;
+        }
+    }
+    srs_info("ts: audio decoded, type=%d, codec=%d, cts=%d, size=%d, time=%"PRId64, 
+        sample->frame_type, codec->audio_codec_id, sample->cts, shared_audio->size, shared_audio->timestamp);
+    SrsCodecAudio ac = (SrsCodecAudio)codec->audio_codec_id;
+    
+    // ts support audio codec: aac/mp3
+    if (ac != SrsCodecAudioAAC && ac != SrsCodecAudioMP3) {
+        return ret;
+    }
+    
+    // the audio codec in stream override the default one,
+    // the PAT/PMT is rewrote when encode the next frame.
+    acodec = ac;
+    
+    // ignore sequence header
+    if (ac == SrsCodecAudioAAC && sample->aac_packet_type == SrsCodecAudioTypeSequenceHeader) {
+        return handler? handler->on_ts_sequence_header() : ret;
+    }
+    
+    if (!is_active()) {
+        return ret;
+    }
+    
+    // the dts calc from rtmp/flv header.
+    int64_t dts = shared_audio->timestamp * 90;
+    
+    // write audio to cache.
+    if ((ret = cache->cache_audio(codec, dts, sample)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // for pure audio, aggregate some frame to one.
+    if (vcodec == SrsCodecVideoDisabled && cache->audio) {
+        if (dts - cache->audio->start_pts < SRS_CONSTS_HLS_PURE_AUDIO_AGGREGATE) {
+            return ret;
+        }
+    }
+    
+    // directly write the audio frame by frame to ts,
+    // it's ok for the hls overload, or maybe cause the audio corrupt,
+    // which introduced by aggregate the audios to a big one.
+    // @see https://github.com/ossrs/srs/issues/512
+    return flush_audio();
+}
+
+int SrsTsRemuxer::on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // when nobody need the ts, only demux the sequence header.
+    if (!is_active() && !is_sps_pps) {
+        return ret;
+    }
+    
+    // user can disable the sps parse to workaround when parse sps failed.
+    // @see https://github.com/ossrs/srs/issues/474
+    if (is_sps_pps) {
+        codec->avc_parse_sps = _srs_config->get_parse_sps(req->vhost);
+    }
+    
+    sample->clear();
+    if ((ret = codec->video_avc_demux(shared_video->payload, shared_video->size, sample)) != ERROR_SUCCESS) {
+        srs_error("ts: codec demux video failed. ret=%d", ret);
+        return ret;
+    }
+    srs_info("ts: video decoded, type=%d, codec=%d, avc=%d, cts=%d, size=%d, time=%"PRId64, 
+        sample->frame_type, codec->video_codec_id, sample->avc_packet_type, sample->cts, shared_video->size, shared_video->timestamp);
+    
+    // ignore info frame,
+    // @see https://github.com/ossrs/srs/issues/288#issuecomment-69863909
+    if (sample->frame_type == SrsCodecVideoAVCFrameVideoInfoFrame) {
+        return ret;
+    }
+    
+    if (codec->video_codec_id != SrsCodecVideoAVC) {
+        return ret;
+    }
+    
+    // ignore sequence header
+    if (sample->frame_type == SrsCodecVideoAVCFrameKeyFrame
+         && sample->avc_packet_type == SrsCodecVideoAVCTypeSequenceHeader) {
+        return handler? handler->on_ts_sequence_header() : ret;
+    }
+    
+    if (!is_active()) {
+        return ret;
+    }
+    
+    int64_t dts = shared_video->timestamp * 90;
+    
+    // write video to cache.
+    if ((ret = cache->cache_video(codec, dts, sample)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    return flush_video(sample->frame_type == SrsCodecVideoAVCFrameKeyFrame);
+}
+
+int SrsTsRemuxer::create_consumer(SrsConsumer* consumer)
+{
+    int ret = ERROR_SUCCESS;
+    
+    consumers.push_back(consumer);
+    
+    // the PAT/PMT must be the first block.
+    if (psi && (ret = consumer->enqueue(psi, true, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // copy gop cache to client, the ts blocks already starts with keyframe.
+    std::vector<SrsSharedPtrMessage*>::iterator it;
+    for (it = gop_cache.begin(); it != gop_cache.end(); ++it) {
+        SrsSharedPtrMessage* block = *it;
+        if ((ret = consumer->enqueue(block, true, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    srs_trace("ts: create consumer, psi=%d, gop=%d, consumers=%d",
+        psi? psi->size : 0, (int)gop_cache.size(), (int)consumers.size());
+    
+    return ret;
+}
+
+void SrsTsRemuxer::on_consumer_destroy(SrsConsumer* consumer)
+{
+    std::vector<SrsConsumer*>::iterator it;
+    it = std::find(consumers.begin(), consumers.end(), consumer);
+    if (it != consumers.end()) {
+        consumers.erase(it);
+    }
+}
+
+bool SrsTsRemuxer::has_consumers()
+{
+    return !consumers.empty();
+}
+
+void SrsTsRemuxer::wakeup_consumers()
+{
+    std::vector<SrsConsumer*>::iterator it;
+    for (it = consumers.begin(); it != consumers.end(); ++it) {
+        SrsConsumer* consumer = *it;
+        consumer->wakeup();
+    }
+}
+
+bool SrsTsRemuxer::is_active()
+{
+    if (!consumers.empty()) {
+        return true;
+    }
+    
+    return handler && handler->is_ts_enabled();
+}
+
+int SrsTsRemuxer::flush_audio()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!cache->audio || cache->audio->payload->length() <= 0) {
+        return ret;
+    }
+    
+    int64_t pts = cache->audio->pts;
+    if ((ret = encode(cache->audio)) != ERROR_SUCCESS) {
+        srs_error("ts: encode audio failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // write success, clear and free the msg
+    srs_freep(cache->audio);
+    
+    SrsSharedPtrMessage* block = writer->detach(RTMP_MSG_AudioMessage, pts / 90);
+    if (!block) {
+        return ret;
+    }
+    SrsAutoFree(SrsSharedPtrMessage, block);
+    
+    if (handler && (ret = handler->on_ts_audio(block, pts)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    cache_gop(block, false);
+    
+    return dispatch(block);
+}
+
+int SrsTsRemuxer::flush_video(bool keyframe)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if (!cache->video || cache->video->payload->length() <= 0) {
+        return ret;
+    }
+    
+    int64_t dts = cache->video->dts;
+    if ((ret = encode(cache->video)) != ERROR_SUCCESS) {
+        srs_error("ts: encode video failed. ret=%d", ret);
+        return ret;
+    }
+    
+    // write success, clear and free the msg
+    srs_freep(cache->video);
+    
+    SrsSharedPtrMessage* block = writer->detach(RTMP_MSG_VideoMessage, dts / 90);
+    if (!block) {
+        return ret;
+    }
+    SrsAutoFree(SrsSharedPtrMessage, block);
+    
+    if (handler && (ret = handler->on_ts_video(block, dts, keyframe)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    cache_gop(block, keyframe);
+    
+    return dispatch(block);
+}
+
+int SrsTsRemuxer::encode(SrsTsMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // when codec changed, write the PAT/PMT to a standalone block,
+    // which is kept for the new segment of hls and new consumer.
+    if (vcodec != psi_vcodec || acodec != psi_acodec) {
+        if ((ret = context->encode_pat_pmt(writer, vcodec, acodec)) != ERROR_SUCCESS) {
+            srs_error("ts: encode PAT/PMT failed. ret=%d", ret);
+            return ret;
+        }
+        psi_vcodec = vcodec;
+        psi_acodec = acodec;
+        
+        srs_freep(psi);
+        psi = writer->detach(RTMP_MSG_AMF0DataMessage, msg->dts / 90);
+        if (!psi) {
+            return ret;
+        }
+        srs_trace("ts: PAT/PMT changed, vcodec=%d, acodec=%d, size=%d", vcodec, acodec, psi->size);
+        
+        if (handler && (ret = handler->on_ts_psi(psi)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        if ((ret = dispatch(psi)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return context->encode(writer, msg, vcodec, acodec);
+}
+
+int SrsTsRemuxer::dispatch(SrsSharedPtrMessage* block)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // copy to all consumer, the block is shared.
+    std::vector<SrsConsumer*>::iterator it;
+    for (it = consumers.begin(); it != consumers.end(); ++it) {
+        SrsConsumer* consumer = *it;
+        if ((ret = consumer->enqueue(block, true, SrsRtmpJitterAlgorithmOFF)) != ERROR_SUCCESS) {
+            srs_error("ts: dispatch block failed. ret=%d", ret);
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
+void SrsTsRemuxer::cache_gop(SrsSharedPtrMessage* block, bool keyframe)
+{
+    if (!enable_gop_cache) {
+        return;
+    }
+    
+    // the gop cache always starts with keyframe.
+    if (keyframe) {
+        clear_gop_cache();
+    }
+    if (gop_cache.empty() && !keyframe) {
+        return;
+    }
+    
+    if (block->is_video()) {
+        audio_after_last_video_count = 0;
+    } else {
+        audio_after_last_video_count++;
+    }
+    
+    // no video, maybe pure audio, clear the gop cache.
+    if (audio_after_last_video_count > SRS_TS_PURE_AUDIO_GUESS_COUNT) {
+        srs_info("ts: clear gop cache for guess pure audio overflow");
+        clear_gop_cache();
+        return;
+    }
+    
+    gop_cache.push_back(block->copy());
+}
+
+void SrsTsRemuxer::clear_gop_cache()
+{
+    std::vector<SrsSharedPtrMessage*>::iterator it;
+    for (it = gop_cache.begin(); it != gop_cache.end(); ++it) {
+        SrsSharedPtrMessage* block = *it;
+        srs_freep(block);
+    }
+    gop_cache.clear();
+    
+    audio_after_last_video_count = 0;
+}
@@ -0,0 +1,196 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_APP_TS_REMUX_HPP
+#define SRS_APP_TS_REMUX_HPP
+
+/*
+#include <srs_app_ts_remux.hpp>
+*/
+#include <srs_core.hpp>
+
+#include <vector>
+
+#include <srs_kernel_codec.hpp>
+#include <srs_kernel_file.hpp>
+#include <srs_kernel_buffer.hpp>
+
+class SrsSharedPtrMessage;
+class SrsCodecSample;
+class SrsAvcAacCodec;
+class SrsTsCache;
+class SrsTsContext;
+class SrsTsMessage;
+class SrsConsumer;
+class SrsRequest;
+
+/**
+* write the ts packets to memory, to build the ts block.
+*/
+class SrsTsBlockWriter : public SrsFileWriter
+{
+private:
+    SrsSimpleBuffer* buffer;
+public:
+    SrsTsBlockWriter();
+    virtual ~SrsTsBlockWriter();
+public:
+    virtual int open(std::string file);
+    virtual void close();
+public:
+    virtual bool is_open();
+    virtual int64_t tellg();
+public:
+    virtual int write(void* buf, size_t count, ssize_t* pnwrite);
+public:
+    /**
+    * detach the written ts packets to a shared ptr message,
+    * and reset the writer for next block.
+    * @param type the message type, audio, video or data(for PSI).
+    * @param timestamp the timestamp in ms of block.
+    * @return the block, NULL when nothing written. user must free it.
+    */
+    virtual SrsSharedPtrMessage* detach(int8_t type, int64_t timestamp);
+};
+
+/**
+* the handler for the shared ts remuxer, for example, the hls.
+*/
+class ISrsTsRemuxHandler
+{
+public:
+    ISrsTsRemuxHandler();
+    virtual ~ISrsTsRemuxHandler();
+public:
+    /**
+    * whether the handler is enabled, the remuxer only packetize the frames
+    * when handler enabled or any ts consumer exists.
+    */
+    virtual bool is_ts_enabled() = 0;
+    /**
+    * when got the audio or video sequence header.
+    */
+    virtual int on_ts_sequence_header() = 0;
+    /**
+    * when PAT/PMT changed, for example, the codec changed.
+    * @param psi the PAT/PMT block, copy it to keep it.
+    */
+    virtual int on_ts_psi(SrsSharedPtrMessage* psi) = 0;
+    /**
+    * when got a ts block of audio.
+    * @param block the ts packets of frames, 188 bytes aligned, copy it to keep it.
+    * @param pts the pts in 90khz of the first frame in block.
+    */
+    virtual int on_ts_audio(SrsSharedPtrMessage* block, int64_t pts) = 0;
+    /**
+    * when got a ts block of video.
+    * @param block the ts packets of frame, 188 bytes aligned, copy it to keep it.
+    * @param dts the dts in 90khz of frame.
+    * @param keyframe whether the frame is keyframe.
+    */
+    virtual int on_ts_video(SrsSharedPtrMessage* block, int64_t dts, bool keyframe) = 0;
+};
+
+/**
+* the shared ts remuxer of source, remux the rtmp stream to ts blocks once,
+* then delivery the ts blocks to hls and all http ts consumers.
+* for each frame, the ts packets are written to a refcounted block, that is,
+* the SrsSharedPtrMessage, so the hls and all http ts clients never copy it.
+*/
+class SrsTsRemuxer
+{
+private:
+    SrsRequest* req;
+    ISrsTsRemuxHandler* handler;
+private:
+    SrsAvcAacCodec* codec;
+    SrsCodecSample* sample;
+    SrsTsCache* cache;
+    SrsTsContext* context;
+    SrsTsBlockWriter* writer;
+private:
+    // the codec of stream, default to the hls_vcodec and hls_acodec,
+    // and the audio codec is updated by the stream.
+    SrsCodecVideo vcodec;
+    SrsCodecAudio acodec;
+    // the codec in PSI, when changed, rewrite the PAT/PMT.
+    SrsCodecVideo psi_vcodec;
+    SrsCodecAudio psi_acodec;
+    // the last PAT/PMT block, for new consumer to start.
+    SrsSharedPtrMessage* psi;
+private:
+    // whether gop cache enabled.
+    bool enable_gop_cache;
+    // the ts blocks from the last video keyframe, for new consumer to start.
+    std::vector<SrsSharedPtrMessage*> gop_cache;
+    // the audio count after last video, to guess the pure audio.
+    int audio_after_last_video_count;
+    // the ts consumers, that is the http ts clients.
+    std::vector<SrsConsumer*> consumers;
+public:
+    SrsTsRemuxer();
+    virtual ~SrsTsRemuxer();
+public:
+    /**
+    * initialize the remuxer.
+    * @param h the handler, for example, the hls. NULL to ignore.
+    */
+    virtual int initialize(SrsRequest* r, ISrsTsRemuxHandler* h);
+    /**
+    * when publish or unpublish stream.
+    * @remark the unpublish flush the cached audio to handler and consumers.
+    */
+    virtual int on_publish();
+    virtual void on_unpublish();
+    /**
+    * remux the audio/video to ts block.
+    * @param is_sps_pps whether the video is h.264 sps/pps.
+    */
+    virtual int on_audio(SrsSharedPtrMessage* shared_audio);
+    virtual int on_video(SrsSharedPtrMessage* shared_video, bool is_sps_pps);
+public:
+    /**
+    * attach the consumer, dumps the PSI and gop cache to it.
+    */
+    virtual int create_consumer(SrsConsumer* consumer);
+    virtual void on_consumer_destroy(SrsConsumer* consumer);
+    /**
+    * whether there is any ts consumer.
+    */
+    virtual bool has_consumers();
+    /**
+    * wakeup all ts consumers waiting for messages.
+    */
+    virtual void wakeup_consumers();
+private:
+    virtual bool is_active();
+    virtual int flush_audio();
+    virtual int flush_video(bool keyframe);
+    virtual int encode(SrsTsMessage* msg);
+    virtual int dispatch(SrsSharedPtrMessage* block);
+    virtual void cache_gop(SrsSharedPtrMessage* block, bool keyframe);
+    virtual void clear_gop_cache();
+};
+
+#endif
+
@@ -43,6 +43,7 @@ using namespace std;
 #include <srs_app_config.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_kernel_error.hpp>
+#include <srs_app_statistic.hpp>
 #include <srs_protocol_kbps.hpp>
 #include <srs_protocol_json.hpp>
 #include <srs_kernel_stream.hpp>
@@ -1434,7 +1435,7 @@ bool srs_is_boolean(const string& str)
     return str == "true" || str == "false";
 }
 
-void srs_api_dump_summaries(std::stringstream& ss)
+void srs_api_dump_summaries(SrsJsonWriter* json)
 {
     SrsRusage* r = srs_get_system_rusage();
     SrsProcSelfStat* u = srs_get_self_proc_stat();
@@ -1487,57 +1488,64 @@ void srs_api_dump_summaries(std::stringstream& ss)
     bool ok = (r->ok && u->ok && s->ok && c->ok 
         && d->ok && m->ok && p->ok && nrs->ok);
     
-    ss << SRS_JOBJECT_START
-        << SRS_JFIELD_ERROR(ERROR_SUCCESS) << SRS_JFIELD_CONT
-        << SRS_JFIELD_ORG("data", SRS_JOBJECT_START)
-            << SRS_JFIELD_ORG("ok", (ok? "true":"false")) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("now_ms", now) << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("self", SRS_JOBJECT_START)
-                << SRS_JFIELD_STR("version", RTMP_SIG_SRS_VERSION) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("pid", getpid()) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("ppid", u->ppid) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("argv", _srs_config->argv()) << SRS_JFIELD_CONT
-                << SRS_JFIELD_STR("cwd", _srs_config->cwd()) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_kbyte", r->r.ru_maxrss) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_percent", self_mem_percent) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("cpu_percent", u->percent) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("srs_uptime", srs_uptime)
-            << SRS_JOBJECT_END << SRS_JFIELD_CONT
-            << SRS_JFIELD_ORG("system", SRS_JOBJECT_START)
-                << SRS_JFIELD_ORG("cpu_percent", s->percent) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("disk_read_KBps", d->in_KBps) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("disk_write_KBps", d->out_KBps) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("disk_busy_percent", d->busy) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_ram_kbyte", m->MemTotal) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_ram_percent", m->percent_ram) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_swap_kbyte", m->SwapTotal) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("mem_swap_percent", m->percent_swap) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("cpus", c->nb_processors) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("cpus_online", c->nb_processors_online) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("uptime", p->os_uptime) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("ilde_time", p->os_ilde_time) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("load_1m", p->load_one_minutes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("load_5m", p->load_five_minutes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("load_15m", p->load_fifteen_minutes) << SRS_JFIELD_CONT
-                // system network bytes stat.
-                << SRS_JFIELD_ORG("net_sample_time", n_sample_time) << SRS_JFIELD_CONT
-                // internet public address network device bytes.
-                << SRS_JFIELD_ORG("net_recv_bytes", nr_bytes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("net_send_bytes", ns_bytes) << SRS_JFIELD_CONT
-                // intranet private address network device bytes.
-                << SRS_JFIELD_ORG("net_recvi_bytes", nri_bytes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("net_sendi_bytes", nsi_bytes) << SRS_JFIELD_CONT
-                // srs network bytes stat.
-                << SRS_JFIELD_ORG("srs_sample_time", nrs->sample_time) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("srs_recv_bytes", nrs->rbytes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("srs_send_bytes", nrs->sbytes) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("conn_sys", nrs->nb_conn_sys) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("conn_sys_et", nrs->nb_conn_sys_et) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("conn_sys_tw", nrs->nb_conn_sys_tw) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("conn_sys_udp", nrs->nb_conn_sys_udp) << SRS_JFIELD_CONT
-                << SRS_JFIELD_ORG("conn_srs", nrs->nb_conn_srs)
-            << SRS_JOBJECT_END
-        << SRS_JOBJECT_END
-        << SRS_JOBJECT_END;
+    json->object_start();
+    json->field_error(ERROR_SUCCESS);
+    
+    json->field_obj("data");
+    json->field_bool("ok", ok);
+    json->field_int("now_ms", now);
+    
+    json->field_obj("self");
+    json->field_str("version", RTMP_SIG_SRS_VERSION);
+    json->field_int("pid", getpid());
+    json->field_int("ppid", u->ppid);
+    json->field_str("argv", _srs_config->argv());
+    json->field_str("cwd", _srs_config->cwd());
+    json->field_int("mem_kbyte", r->r.ru_maxrss);
+    json->field_number("mem_percent", self_mem_percent);
+    json->field_number("cpu_percent", u->percent);
+    json->field_number("srs_uptime", srs_uptime);
+    // the accept and sleep overshoot stat.
+    SrsStatistic::instance()->dumps_server(json);
+    json->object_end();
+    
+    json->field_obj("system");
+    json->field_number("cpu_percent", s->percent);
+    json->field_int("disk_read_KBps", d->in_KBps);
+    json->field_int("disk_write_KBps", d->out_KBps);
+    json->field_number("disk_busy_percent", d->busy);
+    json->field_int("mem_ram_kbyte", m->MemTotal);
+    json->field_number("mem_ram_percent", m->percent_ram);
+    json->field_int("mem_swap_kbyte", m->SwapTotal);
+    json->field_number("mem_swap_percent", m->percent_swap);
+    json->field_int("cpus", c->nb_processors);
+    json->field_int("cpus_online", c->nb_processors_online);
+    json->field_number("uptime", p->os_uptime);
+    json->field_number("ilde_time", p->os_ilde_time);
+    json->field_number("load_1m", p->load_one_minutes);
+    json->field_number("load_5m", p->load_five_minutes);
+    json->field_number("load_15m", p->load_fifteen_minutes);
+    // system network bytes stat.
+    json->field_int("net_sample_time", n_sample_time);
+    // internet public address network device bytes.
+    json->field_int("net_recv_bytes", nr_bytes);
+    json->field_int("net_send_bytes", ns_bytes);
+    // intranet private address network device bytes.
+    json->field_int("net_recvi_bytes", nri_bytes);
+    json->field_int("net_sendi_bytes", nsi_bytes);
+    // srs network bytes stat.
+    json->field_int("srs_sample_time", nrs->sample_time);
+    json->field_int("srs_recv_bytes", nrs->rbytes);
+    json->field_int("srs_send_bytes", nrs->sbytes);
+    json->field_int("conn_sys", nrs->nb_conn_sys);
+    json->field_int("conn_sys_et", nrs->nb_conn_sys_et);
+    json->field_int("conn_sys_tw", nrs->nb_conn_sys_tw);
+    json->field_int("conn_sys_udp", nrs->nb_conn_sys_udp);
+    json->field_int("conn_srs", nrs->nb_conn_srs);
+    json->object_end();
+    
+    json->object_end();
+    
+    json->object_end();
 }
 
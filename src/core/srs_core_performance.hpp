@@ -188,5 +188,51 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #undef SRS_PERF_FAST_FLV_ENCODER
 #define SRS_PERF_FAST_FLV_ENCODER
 
+/**
+ * define the following macro to use the SIMD(SSE2/AVX2) to scan the
+ * h.264 annexb start code, for the ingest of high bitrate stream.
+ * @remark the scalar version is used when compiler not support SSE2,
+ *       and AVX2 only used when compile with -mavx2.
+ */
+#undef SRS_PERF_SIMD_ANNEXB
+#define SRS_PERF_SIMD_ANNEXB
+
+/**
+ * define the following macro to use sendfile(2) to serve the static file
+ * and vod stream with content-length, the file is sent from page cache
+ * to socket in kernel, without copy each byte through user space.
+ * @remark only linux supports it, osx always use the read/write copy.
+ */
+#undef SRS_PERF_SENDFILE
+#ifndef SRS_OSX
+    #define SRS_PERF_SENDFILE
+#endif
+
+/**
+ * define the following macro to accept clients in batch, that is,
+ * when the listen fd is readable, accept4(2) all pending clients in a
+ * loop until EAGAIN, instead of one client for each event loop.
+ * @remark only linux supports accept4, osx always use the st_accept.
+ */
+#undef SRS_PERF_BATCH_ACCEPT
+#ifndef SRS_OSX
+    #define SRS_PERF_BATCH_ACCEPT
+#endif
+/**
+ * the max clients to accept for each wakeup of the listen fd, then yield
+ * to other threads, so a connection storm never starves the publishers.
+ */
+#define SRS_PERF_BATCH_ACCEPT_MAX 64
+
+/**
+ * define the following macro to always record the duration of the hot
+ * stages(chunk decode, source fan-out, queue residence, send, hls segment
+ * and http request) in the log-linear histograms, which are served by the
+ * http api /api/v1/perf.
+ * @remark disable it to remove the clock_gettime from the hot path.
+ */
+#undef SRS_PERF_HISTOGRAM
+#define SRS_PERF_HISTOGRAM
+
 #endif
 
@@ -1161,13 +1161,9 @@ int SrsAvcAacCodec::avc_demux_annexb_format(SrsStream* stream, SrsCodecSample* s
         char* p = stream->data() + stream->pos();
         
         // get the last matched NALU
-        while (!stream->empty()) {
-            if (srs_avc_startswith_annexb(stream, NULL)) {
-                break;
-            }
-            
-            stream->skip(1);
-        }
+        int left = stream->size() - stream->pos();
+        int nb_nalu = srs_avc_find_annexb(p, left);
+        stream->skip(nb_nalu < 0? left : nb_nalu);
         
         char* pp = stream->data() + stream->pos();
         
@@ -99,6 +99,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_SYSTEM_KILL                   1058
 #define ERROR_SYSTEM_DNS_RESOLVE            1059
 #define ERROR_SOCKET_SETKEEPALIVE           1060
+#define ERROR_SYSTEM_CREATE_THREAD          1061
 
 ///////////////////////////////////////////////////////
 // RTMP protocol error.
@@ -267,6 +268,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ERROR_AVC_NALU_UEV                  4027
 #define ERROR_AAC_BYTES_INVALID             4028
 #define ERROR_HTTP_REQUEST_EOF              4029
+#define ERROR_HTTP_SENDFILE_UNSUPPORTED     4030
 
 ///////////////////////////////////////////////////////
 // HTTP API error.
@@ -244,6 +244,11 @@ int64_t SrsFileReader::filesize()
     return size;
 }
 
+int SrsFileReader::get_fd()
+{
+    return fd;
+}
+
 int SrsFileReader::read(void* buf, size_t count, ssize_t* pnread)
 {
     int ret = ERROR_SUCCESS;
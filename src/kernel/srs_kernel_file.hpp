@@ -109,6 +109,11 @@ public:
     virtual void skip(int64_t size);
     virtual int64_t lseek(int64_t offset);
     virtual int64_t filesize();
+    /**
+     * get the fd of file, for the zero copy sendfile.
+     * @return the fd, -1 when not open.
+     */
+    virtual int get_fd();
 public:
     /**
     * read from file. 
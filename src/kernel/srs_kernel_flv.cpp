@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #endif
 
 #include <fcntl.h>
+#include <string.h>
 #include <sstream>
 using namespace std;
 
@@ -185,6 +186,8 @@ SrsSharedPtrMessage::SrsSharedPtrPayload::SrsSharedPtrPayload()
     payload = NULL;
     size = 0;
     shared_count = 0;
+    flv_tag = NULL;
+    flv_timestamp = 0;
 }
 
 SrsSharedPtrMessage::SrsSharedPtrPayload::~SrsSharedPtrPayload()
@@ -193,6 +196,7 @@ SrsSharedPtrMessage::SrsSharedPtrPayload::~SrsSharedPtrPayload()
     srs_memory_unwatch(payload);
 #endif
     srs_freepa(payload);
+    srs_freepa(flv_tag);
 }
 
 SrsSharedPtrMessage::SrsSharedPtrMessage()
@@ -316,6 +320,25 @@ int SrsSharedPtrMessage::chunk_header(char* cache, int nb_cache, bool c0)
     }
 }
 
+char* SrsSharedPtrMessage::flv_tag_cache(bool* pfresh, bool* pmatch)
+{
+    srs_assert(ptr);
+    
+    *pfresh = false;
+    
+    // the first copy create the cache, with its timestamp.
+    if (!ptr->flv_tag) {
+        ptr->flv_tag = new char[SRS_FLV_TAG_HEADER_SIZE + SRS_FLV_PREVIOUS_TAG_SIZE];
+        ptr->flv_timestamp = timestamp;
+        *pfresh = true;
+    }
+    
+    // whether the timestamp in tag header is this copy's.
+    *pmatch = ptr->flv_timestamp == timestamp;
+    
+    return ptr->flv_tag;
+}
+
 //复制SPMessage
 SrsSharedPtrMessage* SrsSharedPtrMessage::copy()
 {
@@ -344,8 +367,6 @@ SrsFlvEncoder::SrsFlvEncoder()
     tag_headers = NULL;
     nb_iovss_cache = 0;
     iovss_cache = NULL;
-    nb_ppts = 0;
-    ppts = NULL;
 #endif
 }
 
@@ -356,7 +377,6 @@ SrsFlvEncoder::~SrsFlvEncoder()
 #ifdef SRS_PERF_FAST_FLV_ENCODER
     srs_freepa(tag_headers);
     srs_freepa(iovss_cache);
-    srs_freepa(ppts);
 #endif
 }
 
@@ -508,51 +528,65 @@ int SrsFlvEncoder::write_tags(SrsSharedPtrMessage** msgs, int count)
         cache = tag_headers = new char[SRS_FLV_TAG_HEADER_SIZE * count];
     }
     
-    // realloc the pts.
-    char* pts = ppts;
-    if (nb_ppts < count) {
-        srs_freepa(ppts);
-        
-        nb_ppts = count;
-        pts = ppts = new char[SRS_FLV_PREVIOUS_TAG_SIZE * count];
-    }
-    
     // the cache is ok, write each messages.
     iovec* iovs = iovss;
     for (int i = 0; i < count; i++) {
         SrsSharedPtrMessage* msg = msgs[i];
         
-        // cache all flv header.
-        if (msg->is_audio()) {
-            if ((ret = write_audio_to_cache(msg->timestamp, msg->payload, msg->size, cache)) != ERROR_SUCCESS) {
-                return ret;
-            }
-        } else if (msg->is_video()) {
-            if ((ret = write_video_to_cache(msg->timestamp, msg->payload, msg->size, cache)) != ERROR_SUCCESS) {
-                return ret;
+        // use the tag header and pts shared by all copies of message,
+        // only encode it when fresh.
+        bool fresh = false;
+        bool match = false;
+        char* shared_tag = msg->flv_tag_cache(&fresh, &match);
+        
+        if (fresh) {
+            // cache all flv header.
+            if (msg->is_audio()) {
+                if ((ret = write_audio_to_cache(msg->timestamp, msg->payload, msg->size, shared_tag)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else if (msg->is_video()) {
+                if ((ret = write_video_to_cache(msg->timestamp, msg->payload, msg->size, shared_tag)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else {
+                if ((ret = write_metadata_to_cache(SrsCodecFlvTagScript, msg->payload, msg->size, shared_tag)) != ERROR_SUCCESS) {
+                    return ret;
+                }
             }
-        } else {
-            if ((ret = write_metadata_to_cache(SrsCodecFlvTagScript, msg->payload, msg->size, cache)) != ERROR_SUCCESS) {
+            
+            // cache all pts.
+            if ((ret = write_pts_to_cache(SRS_FLV_TAG_HEADER_SIZE + msg->size, shared_tag + SRS_FLV_TAG_HEADER_SIZE)) != ERROR_SUCCESS) {
                 return ret;
             }
         }
         
-        // cache all pts.
-        if ((ret = write_pts_to_cache(SRS_FLV_TAG_HEADER_SIZE + msg->size, pts)) != ERROR_SUCCESS) {
-            return ret;
+        // the jitter of consumer changed the timestamp, for instance, the default full jitter,
+        // copy the shared header and patch the timestamp, the type, size and pts never change.
+        char* tag_header = shared_tag;
+        if (!match) {
+            memcpy(cache, shared_tag, SRS_FLV_TAG_HEADER_SIZE);
+            
+            int64_t ts = msg->timestamp & 0x7fffffff;
+            cache[4] = (char)((ts >> 16) & 0xFF);
+            cache[5] = (char)((ts >> 8) & 0xFF);
+            cache[6] = (char)(ts & 0xFF);
+            // TimestampExtended UI8
+            cache[7] = (char)((ts >> 24) & 0xFF);
+            
+            tag_header = cache;
+            cache += SRS_FLV_TAG_HEADER_SIZE;
         }
         
         // all ioves.
-        iovs[0].iov_base = cache;
+        iovs[0].iov_base = tag_header;
         iovs[0].iov_len = SRS_FLV_TAG_HEADER_SIZE;
         iovs[1].iov_base = msg->payload;
         iovs[1].iov_len = msg->size;
-        iovs[2].iov_base = pts;
+        iovs[2].iov_base = shared_tag + SRS_FLV_TAG_HEADER_SIZE;
         iovs[2].iov_len = SRS_FLV_PREVIOUS_TAG_SIZE;
         
         // move next.
-        cache += SRS_FLV_TAG_HEADER_SIZE;
-        pts += SRS_FLV_PREVIOUS_TAG_SIZE;
         iovs += 3;
     }
     
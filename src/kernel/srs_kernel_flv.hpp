@@ -378,6 +378,10 @@ private:
         int size;
         // the reference count
         int shared_count;
+        // the cached flv tag header and previous tag size, for http flv.
+        // @remark the timestamp in tag header is the timestamp of the copy which create it.
+        char* flv_tag;
+        int64_t flv_timestamp;
     public:
         SrsSharedPtrPayload();
         virtual ~SrsSharedPtrPayload();
@@ -428,6 +432,16 @@ public:
      */
      //生成头部信息
     virtual int chunk_header(char* cache, int nb_cache, bool c0);
+    /**
+     * get the cache of flv tag header and previous tag size, shared by all copies,
+     * that is SRS_FLV_TAG_HEADER_SIZE + SRS_FLV_PREVIOUS_TAG_SIZE bytes.
+     * @param pfresh output whether the cache is newly created, user must fill it.
+     * @param pmatch output whether the timestamp in cache is this copy's, if not,
+     *       for instance, the jitter of consumer changed the timestamp, user should
+     *       copy the tag header and patch the timestamp, the pts is always shared.
+     * @see https://github.com/ossrs/srs/issues/405
+     */
+    virtual char* flv_tag_cache(bool* pfresh, bool* pmatch);
 public:
     /**
      * copy current shared ptr message, use ref-count.
@@ -494,12 +508,10 @@ public:
     static int size_tag(int data_size);
 #ifdef SRS_PERF_FAST_FLV_ENCODER
 private:
-    // cache tag header.
+    // cache tag header, for the tag whose timestamp changed by jitter.
+    // @remark the pps(previous tag size) is shared by the message.
     int nb_tag_headers;
     char* tag_headers;
-    // cache pps(previous tag size)
-    int nb_ppts;
-    char* ppts;
     // cache iovss.
     int nb_iovss_cache;
     iovec* iovss_cache;
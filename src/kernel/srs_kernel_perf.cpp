@@ -0,0 +1,215 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_kernel_perf.hpp>
+
+#include <time.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <srs_kernel_utility.hpp>
+
+// the name of stages, must match the SrsPerfStage.
+static const char* _srs_perf_stage_names[] = {
+    "chunk_decode",
+    "source_fanout",
+    "queue_residence",
+    "send",
+    "hls_segment",
+    "http_request"
+};
+
+static SrsPerfHistogram* _srs_perf_stages = NULL;
+
+SrsPerfHistogram::SrsPerfHistogram()
+{
+    name = "";
+    reset();
+}
+
+SrsPerfHistogram::~SrsPerfHistogram()
+{
+}
+
+void SrsPerfHistogram::set_name(const char* v)
+{
+    name = v;
+}
+
+const char* SrsPerfHistogram::get_name()
+{
+    return name;
+}
+
+void SrsPerfHistogram::record(int64_t us)
+{
+    if (us < 0) {
+        return;
+    }
+    
+    buckets[bucket_of(us)]++;
+    
+    count++;
+    sum += us;
+    if (us > max) {
+        max = us;
+    }
+}
+
+void SrsPerfHistogram::reset()
+{
+    memset(buckets, 0, sizeof(buckets));
+    count = sum = max = 0;
+}
+
+void SrsPerfHistogram::merge(SrsPerfHistogram* other)
+{
+    for (int i = 0; i < SRS_PERF_NB_BUCKETS; i++) {
+        buckets[i] += other->buckets[i];
+    }
+    
+    count += other->count;
+    sum += other->sum;
+    if (other->max > max) {
+        max = other->max;
+    }
+}
+
+int64_t SrsPerfHistogram::get_count()
+{
+    return count;
+}
+
+int64_t SrsPerfHistogram::get_max()
+{
+    return max;
+}
+
+int64_t SrsPerfHistogram::avg()
+{
+    if (count <= 0) {
+        return 0;
+    }
+    return sum / count;
+}
+
+int64_t SrsPerfHistogram::percentile(double p)
+{
+    if (count <= 0) {
+        return 0;
+    }
+    
+    // the rank of sample, at least 1.
+    int64_t rank = (int64_t)(p * count / 100.0 + 0.5);
+    rank = srs_max(1, srs_min(rank, count));
+    
+    int64_t total = 0;
+    for (int i = 0; i < SRS_PERF_NB_BUCKETS; i++) {
+        total += buckets[i];
+        if (total >= rank) {
+            return srs_min(upper_of(i), max);
+        }
+    }
+    
+    return max;
+}
+
+int SrsPerfHistogram::bucket_of(int64_t us)
+{
+    if (us < SRS_PERF_SUB_BUCKETS) {
+        return (int)us;
+    }
+    
+    // the exponent, the highest bit of us, >= SRS_PERF_SUB_BUCKETS_BITS.
+    int e = 63 - __builtin_clzll((uint64_t)us);
+    if (e > SRS_PERF_MAX_EXPONENT) {
+        return SRS_PERF_NB_BUCKETS - 1;
+    }
+    
+    // the sub bucket, the next bits after the highest bit.
+    int shift = e - SRS_PERF_SUB_BUCKETS_BITS;
+    int sub = (int)((us >> shift) & (SRS_PERF_SUB_BUCKETS - 1));
+    
+    return (shift + 1) * SRS_PERF_SUB_BUCKETS + sub;
+}
+
+int64_t SrsPerfHistogram::upper_of(int index)
+{
+    if (index < SRS_PERF_SUB_BUCKETS) {
+        return index;
+    }
+    
+    int shift = index / SRS_PERF_SUB_BUCKETS - 1;
+    int64_t sub = index % SRS_PERF_SUB_BUCKETS;
+    
+    int64_t lower = (SRS_PERF_SUB_BUCKETS + sub) << shift;
+    return lower + ((int64_t)1 << shift) - 1;
+}
+
+int64_t srs_perf_now_us()
+{
+#ifndef SRS_OSX
+    timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+        return ((int64_t)now.tv_sec) * 1000 * 1000 + (int64_t)now.tv_nsec / 1000;
+    }
+#endif
+    
+    timeval tv;
+    if (gettimeofday(&tv, NULL) < 0) {
+        return 0;
+    }
+    return ((int64_t)tv.tv_sec) * 1000 * 1000 + (int64_t)tv.tv_usec;
+}
+
+SrsPerfHistogram* srs_perf_histogram(SrsPerfStage stage)
+{
+    srs_assert(stage >= 0 && stage < SrsPerfStageMax);
+    
+    // the histograms are never freed, for they live with the process.
+    if (!_srs_perf_stages) {
+        _srs_perf_stages = new SrsPerfHistogram[SrsPerfStageMax];
+        for (int i = 0; i < SrsPerfStageMax; i++) {
+            _srs_perf_stages[i].set_name(_srs_perf_stage_names[i]);
+        }
+    }
+    
+    return &_srs_perf_stages[stage];
+}
+
+void srs_perf_record(SrsPerfStage stage, int64_t us)
+{
+    srs_perf_histogram(stage)->record(us);
+}
+
+SrsPerfTimer::SrsPerfTimer(SrsPerfStage s)
+{
+    stage = s;
+    starttime = srs_perf_now_us();
+}
+
+SrsPerfTimer::~SrsPerfTimer()
+{
+    srs_perf_record(stage, srs_perf_now_us() - starttime);
+}
+
@@ -0,0 +1,160 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SRS_KERNEL_PERF_HPP
+#define SRS_KERNEL_PERF_HPP
+
+/*
+#include <srs_kernel_perf.hpp>
+*/
+
+#include <srs_core.hpp>
+
+#include <srs_core_performance.hpp>
+
+/**
+ * the hot stages which are always measured by histogram.
+ * @see SRS_PERF_HISTOGRAM
+ */
+enum SrsPerfStage
+{
+    // decode a rtmp chunk, from basic header to the payload read.
+    SrsPerfStageChunkDecode = 0,
+    // fan-out a audio/video frame to all consumers of source.
+    SrsPerfStageSourceFanout,
+    // the time a message resident in consumer queue.
+    SrsPerfStageQueueResidence,
+    // the duration of send syscall, write or writev.
+    SrsPerfStageSend,
+    // write and close the hls segment.
+    SrsPerfStageHlsSegment,
+    // serve a http request, for api and http server.
+    SrsPerfStageHttpRequest,
+    // the max stage, never use it.
+    SrsPerfStageMax
+};
+
+/**
+ * the sub-buckets for each power of 2, so the relative error of
+ * the percentile is less than 1/4, that is, 25%.
+ */
+#define SRS_PERF_SUB_BUCKETS_BITS 2
+#define SRS_PERF_SUB_BUCKETS (1 << SRS_PERF_SUB_BUCKETS_BITS)
+/**
+ * the max power of 2 in us, 2^40us is about 12 days,
+ * the larger value is recorded in the last bucket.
+ */
+#define SRS_PERF_MAX_EXPONENT 40
+#define SRS_PERF_NB_BUCKETS ((SRS_PERF_MAX_EXPONENT - SRS_PERF_SUB_BUCKETS_BITS + 2) * SRS_PERF_SUB_BUCKETS)
+
+/**
+ * the log-linear histogram in us, like the HdrHistogram, for each power
+ * of 2 there are SRS_PERF_SUB_BUCKETS linear buckets, so the memory is
+ * fixed and the record is O(1) without any allocation.
+ * @remark the value less than SRS_PERF_SUB_BUCKETS is recorded exactly.
+ */
+class SrsPerfHistogram
+{
+private:
+    const char* name;
+    int64_t buckets[SRS_PERF_NB_BUCKETS];
+    int64_t count;
+    int64_t sum;
+    int64_t max;
+public:
+    SrsPerfHistogram();
+    virtual ~SrsPerfHistogram();
+public:
+    virtual void set_name(const char* v);
+    virtual const char* get_name();
+    /**
+     * record a sample in us, the negative value is ignored.
+     */
+    virtual void record(int64_t us);
+    /**
+     * reset all samples, for the stat to restart.
+     */
+    virtual void reset();
+    /**
+     * merge the samples of other histogram, as recorded by this one.
+     */
+    virtual void merge(SrsPerfHistogram* other);
+public:
+    virtual int64_t get_count();
+    virtual int64_t get_max();
+    virtual int64_t avg();
+    /**
+     * get the percentile in us, the p in [0, 100],
+     * for example, 99.9 for the p999.
+     * @return the upper bound of the bucket, never larger than max.
+     */
+    virtual int64_t percentile(double p);
+private:
+    virtual int bucket_of(int64_t us);
+    virtual int64_t upper_of(int index);
+};
+
+/**
+ * get the monotonic time in us, for measuring the duration.
+ * @remark we use the CLOCK_MONOTONIC, which is vdso on linux,
+ *       osx use the gettimeofday.
+ */
+extern int64_t srs_perf_now_us();
+
+/**
+ * get the histogram of stage, never NULL for valid stage.
+ */
+extern SrsPerfHistogram* srs_perf_histogram(SrsPerfStage stage);
+
+/**
+ * record the duration in us of stage.
+ */
+extern void srs_perf_record(SrsPerfStage stage, int64_t us);
+
+/**
+ * the auto timer, record the duration from construct to destroy.
+ */
+class SrsPerfTimer
+{
+private:
+    SrsPerfStage stage;
+    int64_t starttime;
+public:
+    SrsPerfTimer(SrsPerfStage s);
+    virtual ~SrsPerfTimer();
+};
+
+/**
+ * measure the scope of stage, for example:
+ *       SrsPerfAuto(SrsPerfStageSend);
+ * @remark do nothing when SRS_PERF_HISTOGRAM disabled.
+ */
+#ifdef SRS_PERF_HISTOGRAM
+    #define SrsPerfAuto(stage) \
+        SrsPerfTimer _srs_perf_timer_##stage(stage)
+#else
+    #define SrsPerfAuto(stage) (void)0
+#endif
+
+#endif
+
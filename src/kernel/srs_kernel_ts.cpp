@@ -206,6 +206,7 @@ SrsTsContext::SrsTsContext()
     pure_audio = false;
     vcodec = SrsCodecVideoReserved;
     acodec = SrsCodecAudioReserved1;
+    packet = new SrsTsPacket(this);
 }
 
 SrsTsContext::~SrsTsContext()
@@ -216,6 +217,15 @@ SrsTsContext::~SrsTsContext()
         srs_freep(channel);
     }
     pids.clear();
+    
+    std::vector<SrsTsMessage*>::iterator it_msg;
+    for (it_msg = msgs.begin(); it_msg != msgs.end(); ++it_msg) {
+        SrsTsMessage* msg = *it_msg;
+        srs_freep(msg);
+    }
+    msgs.clear();
+    
+    srs_freep(packet);
 }
 
 bool SrsTsContext::is_pure_audio()
@@ -268,6 +278,47 @@ void SrsTsContext::set(int pid, SrsTsPidApply apply_pid, SrsTsStream stream)
     channel->stream = stream;
 }
 
+// the max messages in pool, about the audio and video channels.
+#define SRS_TS_MESSAGE_POOL_SIZE 8
+
+SrsTsMessage* SrsTsContext::create_message(SrsTsChannel* c, SrsTsPacket* p)
+{
+    if (msgs.empty()) {
+        return new SrsTsMessage(c, p);
+    }
+    
+    SrsTsMessage* msg = msgs.back();
+    msgs.pop_back();
+    
+    msg->channel = c;
+    msg->packet = p;
+    
+    return msg;
+}
+
+void SrsTsContext::recycle(SrsTsMessage* msg)
+{
+    // the detached msg has no payload, free it.
+    if (!msg->payload || (int)msgs.size() >= SRS_TS_MESSAGE_POOL_SIZE) {
+        srs_freep(msg);
+        return;
+    }
+    
+    // reset the msg, keep the capacity of payload.
+    msg->channel = NULL;
+    msg->packet = NULL;
+    msg->dts = msg->pts = 0;
+    msg->sid = (SrsTsPESStreamId)0x00;
+    msg->continuity_counter = 0;
+    msg->PES_packet_length = 0;
+    msg->is_discontinuity = false;
+    msg->start_pts = 0;
+    msg->write_pcr = false;
+    msg->payload->erase(msg->payload->length());
+    
+    msgs.push_back(msg);
+}
+
 int SrsTsContext::decode(SrsStream* stream, ISrsTsHandler* handler)
 {
     int ret = ERROR_SUCCESS;
@@ -275,9 +326,7 @@ int SrsTsContext::decode(SrsStream* stream, ISrsTsHandler* handler)
     // parse util EOF of stream.
     // for example, parse multiple times for the PES_packet_length(0) packet.
     while (!stream->empty()) {
-        SrsTsPacket* packet = new SrsTsPacket(this);
-        SrsAutoFree(SrsTsPacket, packet);
-
+        // the packet is reused, which parse the header in place.
         SrsTsMessage* msg = NULL;
         if ((ret = packet->decode(stream, &msg)) != ERROR_SUCCESS) {
             srs_error("mpegts: decode ts packet failed. ret=%d", ret);
@@ -287,9 +336,13 @@ int SrsTsContext::decode(SrsStream* stream, ISrsTsHandler* handler)
         if (!msg) {
             continue;
         }
-        SrsAutoFree(SrsTsMessage, msg);
 
-        if ((ret = handler->on_ts_message(msg)) != ERROR_SUCCESS) {
+        ret = handler->on_ts_message(msg);
+        
+        // the msg is recycled to reuse its payload buffer.
+        recycle(msg);
+        
+        if (ret != ERROR_SUCCESS) {
             srs_error("mpegts: handler ts message failed. ret=%d", ret);
             return ret;
         }
@@ -298,11 +351,12 @@ int SrsTsContext::decode(SrsStream* stream, ISrsTsHandler* handler)
     return ret;
 }
 
-int SrsTsContext::encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo vc, SrsCodecAudio ac)
+/**
+* map the flv codecs to the ts stream types and pids.
+*/
+static void srs_ts_codec_to_stream(SrsCodecVideo vc, SrsCodecAudio ac, SrsTsStream* pvs, int16_t* pvpid, SrsTsStream* pas, int16_t* papid)
 {
-    int ret = ERROR_SUCCESS;
-
-    SrsTsStream vs, as;
+    SrsTsStream vs = SrsTsStreamReserved, as = SrsTsStreamReserved;
     int16_t video_pid = 0, audio_pid = 0;
     switch (vc) {
         case SrsCodecVideoAVC: 
@@ -352,6 +406,20 @@ int SrsTsContext::encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo
             break;
     }
     
+    *pvs = vs;
+    *pvpid = video_pid;
+    *pas = as;
+    *papid = audio_pid;
+}
+
+int SrsTsContext::encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo vc, SrsCodecAudio ac)
+{
+    int ret = ERROR_SUCCESS;
+
+    SrsTsStream vs, as;
+    int16_t video_pid = 0, audio_pid = 0;
+    srs_ts_codec_to_stream(vc, ac, &vs, &video_pid, &as, &audio_pid);
+    
     if (as == SrsTsStreamReserved && vs == SrsTsStreamReserved) {
         ret = ERROR_HLS_NO_STREAM;
         srs_error("hls: no video or audio stream, vcodec=%d, acodec=%d. ret=%d", vc, ac, ret);
@@ -375,6 +443,26 @@ int SrsTsContext::encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo
     }
 }
 
+int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, SrsCodecVideo vc, SrsCodecAudio ac)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsTsStream vs, as;
+    int16_t video_pid = 0, audio_pid = 0;
+    srs_ts_codec_to_stream(vc, ac, &vs, &video_pid, &as, &audio_pid);
+    
+    if (as == SrsTsStreamReserved && vs == SrsTsStreamReserved) {
+        ret = ERROR_HLS_NO_STREAM;
+        srs_error("ts: no video or audio stream, vcodec=%d, acodec=%d. ret=%d", vc, ac, ret);
+        return ret;
+    }
+    
+    vcodec = vc;
+    acodec = ac;
+    
+    return encode_pat_pmt(writer, video_pid, vs, audio_pid, as);
+}
+
 int SrsTsContext::encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStream vs, int16_t apid, SrsTsStream as)
 {
     int ret = ERROR_SUCCESS;
@@ -565,12 +653,29 @@ SrsTsPacket::SrsTsPacket(SrsTsContext* c)
     continuity_counter = 0;
     adaptation_field = NULL;
     payload = NULL;
+    af_cache = NULL;
+    pes_cache = NULL;
 }
 
 SrsTsPacket::~SrsTsPacket()
 {
-    srs_freep(adaptation_field);
-    srs_freep(payload);
+    reset_fields();
+    srs_freep(af_cache);
+    srs_freep(pes_cache);
+}
+
+void SrsTsPacket::reset_fields()
+{
+    // the cached fields are freed by dtor.
+    if (adaptation_field != af_cache) {
+        srs_freep(adaptation_field);
+    }
+    adaptation_field = NULL;
+
+    if (payload != pes_cache) {
+        srs_freep(payload);
+    }
+    payload = NULL;
 }
 
 int SrsTsPacket::decode(SrsStream* stream, SrsTsMessage** ppmsg)
@@ -610,10 +715,16 @@ int SrsTsPacket::decode(SrsStream* stream, SrsTsMessage** ppmsg)
         sync_byte, transport_error_indicator, payload_unit_start_indicator, transport_priority, pid,
         transport_scrambling_control, adaption_field_control, continuity_counter);
 
+    // the packet maybe reused by context, reset the optional fields,
+    // for a packet without payload must not keep the last payload.
+    reset_fields();
+    
     // optional: adaptation field
     if (adaption_field_control == SrsTsAdaptationFieldTypeAdaptionOnly || adaption_field_control == SrsTsAdaptationFieldTypeBoth) {
-        srs_freep(adaptation_field);
-        adaptation_field = new SrsTsAdaptationField(this);
+        if (!af_cache) {
+            af_cache = new SrsTsAdaptationField(this);
+        }
+        adaptation_field = af_cache;
 
         if ((ret = adaptation_field->decode(stream)) != ERROR_SUCCESS) {
             srs_error("ts: demux af faield. ret=%d", ret);
@@ -629,18 +740,18 @@ int SrsTsPacket::decode(SrsStream* stream, SrsTsMessage** ppmsg)
     if (adaption_field_control == SrsTsAdaptationFieldTypePayloadOnly || adaption_field_control == SrsTsAdaptationFieldTypeBoth) {
         if (pid == SrsTsPidPAT) {
             // 2.4.4.3 Program association Table
-            srs_freep(payload);
             payload = new SrsTsPayloadPAT(this);
         } else {
             SrsTsChannel* channel = context->get(pid);
             if (channel && channel->apply == SrsTsPidApplyPMT) {
                 // 2.4.4.8 Program Map Table
-                srs_freep(payload);
                 payload = new SrsTsPayloadPMT(this);
             } else if (channel && (channel->apply == SrsTsPidApplyVideo || channel->apply == SrsTsPidApplyAudio)) {
                 // 2.4.3.6 PES packet
-                srs_freep(payload);
-                payload = new SrsTsPayloadPES(this);
+                if (!pes_cache) {
+                    pes_cache = new SrsTsPayloadPES(this);
+                }
+                payload = pes_cache;
             } else {
                 // left bytes as reserved.
                 stream->skip(nb_payload);
@@ -1368,7 +1479,7 @@ int SrsTsPayloadPES::decode(SrsStream* stream, SrsTsMessage** ppmsg)
     // init msg.
     SrsTsMessage* msg = channel->msg;
     if (!msg) {
-        msg = new SrsTsMessage(channel, packet);
+        msg = packet->context->create_message(channel, packet);
         channel->msg = msg;
     }
     
@@ -47,6 +47,7 @@ class SrsCodecSample;
 class SrsSimpleBuffer;
 class SrsTsAdaptationField;
 class SrsTsPayload;
+class SrsTsPayloadPES;
 class SrsTsMessage;
 class SrsTsPacket;
 class SrsTsContext;
@@ -355,6 +356,10 @@ private:
 private:
     std::map<int, SrsTsChannel*> pids;
     bool pure_audio;
+    // the reused packet to decode, for each ts packet.
+    SrsTsPacket* packet;
+    // the pool of messages, to reuse the payload buffer of PES.
+    std::vector<SrsTsMessage*> msgs;
 // encoder
 private:
     // when any codec changed, write the PAT/PMT.
@@ -388,6 +393,15 @@ public:
     * set the pid apply, the parsed pid.
     */
     virtual void set(int pid, SrsTsPidApply apply_pid, SrsTsStream stream = SrsTsStreamReserved);
+    /**
+    * create a message from pool, the payload buffer of message is reused,
+    * so the big PES never realloc and copy again when demux.
+    */
+    virtual SrsTsMessage* create_message(SrsTsChannel* c, SrsTsPacket* p);
+    /**
+    * recycle the message to pool, user should never use it again.
+    */
+    virtual void recycle(SrsTsMessage* msg);
 // decode methods
 public:
     /**
@@ -405,6 +419,13 @@ public:
     * @param ac the audio codec, write the PAT/PMT table when changed.
     */
     virtual int encode(SrsFileWriter* writer, SrsTsMessage* msg, SrsCodecVideo vc, SrsCodecAudio ac);
+    /**
+    * write the PAT/PMT table for the codecs, then the context is ready.
+    * user can use it to start a new ts stream explicitly, for example,
+    * the shared ts remuxer which caches the PAT/PMT for each hls segment and http ts client.
+    * @remark the encode() never write the PAT/PMT again util codec changed.
+    */
+    virtual int encode_pat_pmt(SrsFileWriter* writer, SrsCodecVideo vc, SrsCodecAudio ac);
 private:
     virtual int encode_pat_pmt(SrsFileWriter* writer, int16_t vpid, SrsTsStream vs, int16_t apid, SrsTsStream as);
     virtual int encode_pes(SrsFileWriter* writer, SrsTsMessage* msg, int16_t pid, SrsTsStream sid, bool pure_audio);
@@ -506,6 +527,14 @@ public:
 private:
     SrsTsAdaptationField* adaptation_field;
     SrsTsPayload* payload;
+private:
+    /**
+    * the decoded adaptation field and PES payload of the reused packet,
+    * the most common parts of a ts packet, decode into them in place
+    * to avoid new/delete for each packet.
+    */
+    SrsTsAdaptationField* af_cache;
+    SrsTsPayloadPES* pes_cache;
 public:
     SrsTsContext* context;
 public:
@@ -513,6 +542,11 @@ public:
     virtual ~SrsTsPacket();
 public:
     virtual int decode(SrsStream* stream, SrsTsMessage** ppmsg);
+private:
+    /**
+    * detach the fields of last packet, free them when not the cached one.
+    */
+    virtual void reset_fields();
 public:
     virtual int size();
     virtual int encode(SrsStream* stream);
@@ -35,6 +35,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <srs_core_performance.hpp>
+
+#ifdef SRS_PERF_SIMD_ANNEXB
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+    #elif defined(__SSE2__)
+        #include <emmintrin.h>
+    #endif
+#endif
+
 using namespace std;
 
 #include <srs_kernel_log.hpp>
@@ -427,6 +437,86 @@ bool srs_avc_startswith_annexb(SrsStream* stream, int* pnb_start_code)
     return false;
 }
 
+/**
+* find the first "00 00 01" in bytes, scalar version.
+* @return the offset of first 00, -1 if not found.
+*/
+static int srs_avc_find_00_00_01(char* bytes, int start, int size)
+{
+    for (int i = start; i + 2 < size; i++) {
+        // skip 2bytes when the third byte is not 00 nor 01.
+        if ((u_int8_t)bytes[i + 2] > 0x01) {
+            i += 2;
+            continue;
+        }
+        if (bytes[i] == (char)0x00 && bytes[i + 1] == (char)0x00 && bytes[i + 2] == (char)0x01) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+int srs_avc_find_annexb(char* bytes, int size)
+{
+    int pos = -1;
+    int i = 0;
+    
+#if defined(SRS_PERF_SIMD_ANNEXB) && (defined(__AVX2__) || defined(__SSE2__))
+    // each "00 00 01" contains 00 at the first two bytes, so for each block,
+    // when no 00 in block, no start code starts in block, skip it;
+    // or check each 00 in block.
+    #if defined(__AVX2__)
+        #define SRS_ANNEXB_BLOCK 32
+    #else
+        #define SRS_ANNEXB_BLOCK 16
+    #endif
+    
+    for (; pos < 0 && i + SRS_ANNEXB_BLOCK + 2 <= size; i += SRS_ANNEXB_BLOCK) {
+    #if defined(__AVX2__)
+        __m256i v = _mm256_loadu_si256((const __m256i*)(bytes + i));
+        u_int32_t mask = (u_int32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    #else
+        __m128i v = _mm_loadu_si128((const __m128i*)(bytes + i));
+        u_int32_t mask = (u_int32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    #endif
+        
+        // the start code must be 00 00, so the bit of next byte must set,
+        // except the last byte in block, whose next byte is in next block.
+        mask &= (mask >> 1) | (1u << (SRS_ANNEXB_BLOCK - 1));
+        
+        while (mask) {
+            int k = __builtin_ctz(mask);
+            mask &= mask - 1;
+            
+            char* p = bytes + i + k;
+            if (p[1] == (char)0x00 && p[2] == (char)0x01) {
+                pos = i + k;
+                break;
+            }
+        }
+    }
+    
+    #undef SRS_ANNEXB_BLOCK
+#endif
+    
+    // the scalar version, for the left bytes.
+    if (pos < 0) {
+        pos = srs_avc_find_00_00_01(bytes, i, size);
+    }
+    
+    if (pos < 0) {
+        return -1;
+    }
+    
+    // the start code is N[00] 00 00 01, where N>=0
+    while (pos > 0 && bytes[pos - 1] == (char)0x00) {
+        pos--;
+    }
+    
+    return pos;
+}
+
 bool srs_aac_startswith_adts(SrsStream* stream)
 {
     char* bytes = stream->data() + stream->pos();
@@ -521,9 +611,59 @@ unsigned int mpegts_crc32(const u_int8_t *data, int len)
     return crc;
 }
 
+/**
+* the slice-by-8 tables for mpegts crc32, where the crc_slice_table[0] is crc_table,
+* and the crc_slice_table[k][b] is the crc of byte b followed by k zero bytes.
+* @remark the tables are generated when first used.
+*/
+static u_int32_t crc_slice_table[8][256];
+static bool crc_slice_table_initialized = false;
+
+static void mpegts_crc32_slice8_initialize()
+{
+    for (int i = 0; i < 256; i++) {
+        crc_slice_table[0][i] = crc_table[i];
+    }
+    
+    for (int k = 1; k < 8; k++) {
+        for (int i = 0; i < 256; i++) {
+            u_int32_t v = crc_slice_table[k - 1][i];
+            crc_slice_table[k][i] = (v << 8) ^ crc_table[v >> 24];
+        }
+    }
+    
+    crc_slice_table_initialized = true;
+}
+
+// the slice-by-8 version of mpegts_crc32, process 8 bytes in a time.
+unsigned int mpegts_crc32_slice8(const u_int8_t *data, int len)
+{
+    if (!crc_slice_table_initialized) {
+        mpegts_crc32_slice8_initialize();
+    }
+    
+    u_int32_t crc = 0xffffffff;
+    
+    for (; len >= 8; len -= 8, data += 8) {
+        crc ^= ((u_int32_t)data[0] << 24) | ((u_int32_t)data[1] << 16)
+            | ((u_int32_t)data[2] << 8) | (u_int32_t)data[3];
+        
+        crc = crc_slice_table[7][crc >> 24] ^ crc_slice_table[6][(crc >> 16) & 0xff]
+            ^ crc_slice_table[5][(crc >> 8) & 0xff] ^ crc_slice_table[4][crc & 0xff]
+            ^ crc_slice_table[3][data[4]] ^ crc_slice_table[2][data[5]]
+            ^ crc_slice_table[1][data[6]] ^ crc_slice_table[0][data[7]];
+    }
+    
+    for (; len > 0; len--) {
+        crc = (crc << 8) ^ crc_table[((crc >> 24) ^ *data++) & 0xff];
+    }
+    
+    return crc;
+}
+
 u_int32_t srs_crc32(const void* buf, int size)
 {
-    return mpegts_crc32((const u_int8_t*)buf, size);
+    return mpegts_crc32_slice8((const u_int8_t*)buf, size);
 }
 
 /*
@@ -92,6 +92,14 @@ extern std::string srs_path_basename(std::string path);
 */
 extern bool srs_avc_startswith_annexb(SrsStream* stream, int* pnb_start_code = NULL);
 
+/**
+* find the next avc NALU start code in "AnnexB", that is "N[00] 00 00 01" where N>=0,
+* the position is where srs_avc_startswith_annexb returns true.
+* @remark use SIMD(SSE2/AVX2) to scan when SRS_PERF_SIMD_ANNEXB is defined.
+* @return the offset of start code in bytes, -1 if not found.
+*/
+extern int srs_avc_find_annexb(char* bytes, int size);
+
 /**
 * whether stream starts with the aac ADTS 
 * from aac-mp4a-format-ISO_IEC_14496-3+2001.pdf, page 75, 1.A.2.2 ADTS.
@@ -101,6 +109,7 @@ extern bool srs_aac_startswith_adts(SrsStream* stream);
 
 /**
 * cacl the crc32 of bytes in buf.
+* @remark use the slice-by-8 algorithm of mpegts crc32, for the PSI of ts.
 */
 extern u_int32_t srs_crc32(const void* buf, int size);
 
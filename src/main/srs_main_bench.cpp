@@ -0,0 +1,899 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_core.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <sstream>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_kernel_file.hpp>
+#include <srs_kernel_flv.hpp>
+#include <srs_kernel_codec.hpp>
+#include <srs_kernel_stream.hpp>
+#include <srs_kernel_perf.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_rtmp_stack.hpp>
+#include <srs_rtmp_amf0.hpp>
+#include <srs_rtmp_utility.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_app_server.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_log.hpp>
+#include <srs_app_st.hpp>
+#include <srs_app_thread.hpp>
+#include <srs_app_utility.hpp>
+#include <srs_app_http_client.hpp>
+#include <srs_app_http_conn.hpp>
+
+// for the main objects(server, config, log, context),
+// never subscribe handler in constructor,
+// instead, subscribe handler in initialize method.
+// kernel module.
+ISrsLog* _srs_log = new SrsFastLog();
+ISrsThreadContext* _srs_context = new SrsThreadContext();
+// app module.
+SrsConfig* _srs_config = NULL;
+SrsServer* _srs_server = NULL;
+
+#if defined(SRS_AUTO_HTTP_CORE)
+
+// the property of onMetaData, the wall clock in ms when publisher send it,
+// the player use it to calc the end-to-end latency.
+#define SRS_BENCH_TIME "srs_bench_time"
+// the interval in ms for publisher to send the bench time.
+#define SRS_BENCH_TIME_INTERVAL_MS 1000
+
+// the type of bench client.
+enum SrsBenchClientType
+{
+    SrsBenchClientPublish = 0,
+    SrsBenchClientRtmpPlay,
+    SrsBenchClientFlvPlay
+};
+
+/**
+ * the bench client, run in a st thread, connect to server
+ * and publish or play stream until error.
+ */
+class SrsBenchClient : public ISrsOneCycleThreadHandler
+{
+public:
+    SrsBenchClientType type;
+    std::string url;
+    // the start time in ms, and the time when got the first a/v msg.
+    int64_t starttime;
+    int64_t startup;
+    // the stat of client.
+    int64_t nb_msgs;
+    int64_t nb_bytes;
+    // the error code when client quit, ERROR_SUCCESS when alive.
+    int error;
+    bool alive;
+    // the end-to-end latency in us, by the embeded bench time.
+    SrsPerfHistogram latency;
+private:
+    SrsOneCycleThread* trd;
+public:
+    SrsBenchClient(SrsBenchClientType t, std::string u);
+    virtual ~SrsBenchClient();
+public:
+    virtual int start();
+// interface ISrsOneCycleThreadHandler
+public:
+    virtual int cycle();
+protected:
+    virtual int do_cycle() = 0;
+    // when got a a/v msg or bytes.
+    virtual void on_msg(int size);
+    // when got the onMetaData, sample the latency.
+    virtual void on_metadata(SrsAmf0Object* metadata);
+};
+
+/**
+ * the rtmp client base, connect to server by url.
+ */
+class SrsBenchRtmpClient : public SrsBenchClient
+{
+protected:
+    SrsRequest* req;
+    st_netfd_t stfd;
+    SrsStSocket* io;
+    SrsRtmpClient* client;
+    int stream_id;
+public:
+    SrsBenchRtmpClient(SrsBenchClientType t, std::string u);
+    virtual ~SrsBenchRtmpClient();
+protected:
+    virtual int connect();
+};
+
+/**
+ * the publisher, publish the flv file in loop, in realtime.
+ */
+class SrsBenchPublisher : public SrsBenchRtmpClient
+{
+private:
+    std::string input;
+    // the base timestamp of current loop, and the last timestamp.
+    int64_t base_time;
+    int64_t last_time;
+    // the last time in ms to send the bench time.
+    int64_t last_bench_time;
+public:
+    SrsBenchPublisher(std::string u, std::string i);
+    virtual ~SrsBenchPublisher();
+protected:
+    virtual int do_cycle();
+private:
+    virtual int publish_file();
+    virtual int send_bench_time();
+};
+
+/**
+ * the rtmp player.
+ */
+class SrsBenchRtmpPlayer : public SrsBenchRtmpClient
+{
+public:
+    SrsBenchRtmpPlayer(std::string u);
+    virtual ~SrsBenchRtmpPlayer();
+protected:
+    virtual int do_cycle();
+};
+
+/**
+ * the http-flv player.
+ */
+class SrsBenchFlvPlayer : public SrsBenchClient
+{
+private:
+    ISrsHttpResponseReader* reader;
+public:
+    SrsBenchFlvPlayer(std::string u);
+    virtual ~SrsBenchFlvPlayer();
+protected:
+    virtual int do_cycle();
+private:
+    virtual int read_fully(char* data, int size);
+};
+
+SrsBenchClient::SrsBenchClient(SrsBenchClientType t, std::string u)
+{
+    type = t;
+    url = u;
+    starttime = 0;
+    startup = -1;
+    nb_msgs = 0;
+    nb_bytes = 0;
+    error = ERROR_SUCCESS;
+    alive = false;
+    trd = new SrsOneCycleThread("bench", this);
+}
+
+SrsBenchClient::~SrsBenchClient()
+{
+    srs_freep(trd);
+}
+
+int SrsBenchClient::start()
+{
+    return trd->start();
+}
+
+int SrsBenchClient::cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    starttime = srs_update_system_time_ms();
+    alive = true;
+    
+    if ((ret = do_cycle()) != ERROR_SUCCESS) {
+        srs_warn("bench client %s quit. ret=%d", url.c_str(), ret);
+    }
+    
+    error = ret;
+    alive = false;
+    
+    return ret;
+}
+
+void SrsBenchClient::on_msg(int size)
+{
+    nb_msgs++;
+    nb_bytes += size;
+    
+    if (startup < 0) {
+        startup = srs_update_system_time_ms() - starttime;
+    }
+}
+
+void SrsBenchClient::on_metadata(SrsAmf0Object* metadata)
+{
+    // ignore the cached metadata, which is sent before any a/v.
+    if (startup < 0) {
+        return;
+    }
+    
+    SrsAmf0Any* prop = metadata->get_property(SRS_BENCH_TIME);
+    if (!prop || !prop->is_number()) {
+        return;
+    }
+    
+    int64_t now = srs_update_system_time_ms();
+    latency.record((now - (int64_t)prop->to_number()) * 1000);
+}
+
+SrsBenchRtmpClient::SrsBenchRtmpClient(SrsBenchClientType t, std::string u) : SrsBenchClient(t, u)
+{
+    req = NULL;
+    stfd = NULL;
+    io = NULL;
+    client = NULL;
+    stream_id = 0;
+}
+
+SrsBenchRtmpClient::~SrsBenchRtmpClient()
+{
+    srs_freep(client);
+    srs_freep(io);
+    srs_freep(req);
+    srs_close_stfd(stfd);
+}
+
+int SrsBenchRtmpClient::connect()
+{
+    int ret = ERROR_SUCCESS;
+    
+    // parse the url to tcUrl and stream.
+    req = new SrsRequest();
+    
+    string uri = req->tcUrl = url;
+    if (srs_string_contains(uri, "/")) {
+        req->stream = srs_path_basename(uri);
+        req->tcUrl = uri = srs_path_dirname(uri);
+    }
+    
+    srs_discovery_tc_url(req->tcUrl,
+        req->schema, req->host, req->vhost, req->app, req->stream, req->port,
+        req->param);
+    
+    // connect host.
+    if ((ret = srs_socket_connect(req->host, ::atoi(req->port.c_str()), SRS_CONSTS_RTMP_SEND_TIMEOUT_US, &stfd)) != ERROR_SUCCESS) {
+        srs_error("bench: connect server %s:%s failed. ret=%d", req->host.c_str(), req->port.c_str(), ret);
+        return ret;
+    }
+    io = new SrsStSocket(stfd);
+    client = new SrsRtmpClient(io);
+    
+    client->set_recv_timeout(SRS_CONSTS_RTMP_RECV_TIMEOUT_US);
+    client->set_send_timeout(SRS_CONSTS_RTMP_SEND_TIMEOUT_US);
+    
+    if ((ret = client->handshake()) != ERROR_SUCCESS) {
+        srs_error("bench: handshake with server failed. ret=%d", ret);
+        return ret;
+    }
+    if ((ret = client->connect_app(req->app, req->tcUrl, req, false)) != ERROR_SUCCESS) {
+        srs_error("bench: connect app %s failed. ret=%d", req->tcUrl.c_str(), ret);
+        return ret;
+    }
+    if ((ret = client->create_stream(stream_id)) != ERROR_SUCCESS) {
+        srs_error("bench: create stream failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+SrsBenchPublisher::SrsBenchPublisher(std::string u, std::string i) : SrsBenchRtmpClient(SrsBenchClientPublish, u)
+{
+    input = i;
+    base_time = 0;
+    last_time = 0;
+    last_bench_time = 0;
+}
+
+SrsBenchPublisher::~SrsBenchPublisher()
+{
+}
+
+int SrsBenchPublisher::do_cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if ((ret = connect()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    if ((ret = client->publish(req->stream, stream_id)) != ERROR_SUCCESS) {
+        srs_error("bench: publish %s failed. ret=%d", req->stream.c_str(), ret);
+        return ret;
+    }
+    
+    // publish the file in loop, the timestamp is monotonically.
+    for (;;) {
+        if ((ret = publish_file()) != ERROR_SUCCESS) {
+            return ret;
+        }
+        base_time = last_time;
+    }
+    
+    return ret;
+}
+
+int SrsBenchPublisher::publish_file()
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsFileReader fr;
+    if ((ret = fr.open(input)) != ERROR_SUCCESS) {
+        srs_error("bench: open flv %s failed. ret=%d", input.c_str(), ret);
+        return ret;
+    }
+    
+    SrsFlvDecoder dec;
+    if ((ret = dec.initialize(&fr)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    char header[9];
+    if ((ret = dec.read_header(header)) != ERROR_SUCCESS) {
+        srs_error("bench: read flv header failed. ret=%d", ret);
+        return ret;
+    }
+    
+    char pts[4];
+    if ((ret = dec.read_previous_tag_size(pts)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    while (fr.tellg() < fr.filesize()) {
+        char type = 0;
+        int32_t size = 0;
+        u_int32_t time = 0;
+        if ((ret = dec.read_tag_header(&type, &size, &time)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        char* data = new char[size];
+        if ((ret = dec.read_tag_data(data, size)) != ERROR_SUCCESS) {
+            srs_freepa(data);
+            return ret;
+        }
+        if ((ret = dec.read_previous_tag_size(pts)) != ERROR_SUCCESS) {
+            srs_freepa(data);
+            return ret;
+        }
+        
+        // send in realtime, by the elapsed time from start.
+        int64_t timestamp = base_time + time;
+        int64_t elapsed = srs_update_system_time_ms() - starttime;
+        if (timestamp > elapsed) {
+            st_usleep((timestamp - elapsed) * 1000);
+        }
+        last_time = timestamp;
+        
+        SrsSharedPtrMessage* msg = NULL;
+        if ((ret = srs_rtmp_create_msg(type, (u_int32_t)timestamp, data, size, stream_id, &msg)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        if ((ret = client->send_and_free_message(msg, stream_id)) != ERROR_SUCCESS) {
+            srs_error("bench: send msg failed. ret=%d", ret);
+            return ret;
+        }
+        on_msg(size);
+        
+        if ((ret = send_bench_time()) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
+int SrsBenchPublisher::send_bench_time()
+{
+    int ret = ERROR_SUCCESS;
+    
+    int64_t now = srs_get_system_time_ms();
+    if (now - last_bench_time < SRS_BENCH_TIME_INTERVAL_MS) {
+        return ret;
+    }
+    last_bench_time = now;
+    
+    SrsOnMetaDataPacket* pkt = new SrsOnMetaDataPacket();
+    pkt->metadata->set(SRS_BENCH_TIME, SrsAmf0Any::number((double)now));
+    
+    if ((ret = client->send_and_free_packet(pkt, stream_id)) != ERROR_SUCCESS) {
+        srs_error("bench: send bench time failed. ret=%d", ret);
+        return ret;
+    }
+    
+    return ret;
+}
+
+SrsBenchRtmpPlayer::SrsBenchRtmpPlayer(std::string u) : SrsBenchRtmpClient(SrsBenchClientRtmpPlay, u)
+{
+}
+
+SrsBenchRtmpPlayer::~SrsBenchRtmpPlayer()
+{
+}
+
+int SrsBenchRtmpPlayer::do_cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    if ((ret = connect()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    if ((ret = client->play(req->stream, stream_id)) != ERROR_SUCCESS) {
+        srs_error("bench: play %s failed. ret=%d", req->stream.c_str(), ret);
+        return ret;
+    }
+    
+    for (;;) {
+        SrsCommonMessage* msg = NULL;
+        if ((ret = client->recv_message(&msg)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        SrsAutoFree(SrsCommonMessage, msg);
+        
+        if (msg->header.is_audio() || msg->header.is_video()) {
+            on_msg(msg->size);
+            continue;
+        }
+        
+        if (!msg->header.is_amf0_data() && !msg->header.is_amf3_data()) {
+            continue;
+        }
+        
+        SrsPacket* pkt = NULL;
+        if ((ret = client->decode_message(msg, &pkt)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        SrsAutoFree(SrsPacket, pkt);
+        
+        SrsOnMetaDataPacket* metadata = dynamic_cast<SrsOnMetaDataPacket*>(pkt);
+        if (metadata) {
+            on_metadata(metadata->metadata);
+        }
+    }
+    
+    return ret;
+}
+
+SrsBenchFlvPlayer::SrsBenchFlvPlayer(std::string u) : SrsBenchClient(SrsBenchClientFlvPlay, u)
+{
+    reader = NULL;
+}
+
+SrsBenchFlvPlayer::~SrsBenchFlvPlayer()
+{
+}
+
+int SrsBenchFlvPlayer::do_cycle()
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsHttpUri uri;
+    if ((ret = uri.initialize(url)) != ERROR_SUCCESS) {
+        srs_error("bench: invalid url %s. ret=%d", url.c_str(), ret);
+        return ret;
+    }
+    
+    SrsHttpClient client;
+    if ((ret = client.initialize(uri.get_host(), uri.get_port(), SRS_CONSTS_RTMP_RECV_TIMEOUT_US)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    std::string path = uri.get_path();
+    if (strlen(uri.get_query()) > 0) {
+        path += std::string("?") + uri.get_query();
+    }
+    
+    ISrsHttpMessage* msg = NULL;
+    if ((ret = client.get(path, "", &msg)) != ERROR_SUCCESS) {
+        srs_error("bench: http get %s failed. ret=%d", url.c_str(), ret);
+        return ret;
+    }
+    SrsAutoFree(ISrsHttpMessage, msg);
+    
+    if (msg->status_code() != SRS_CONSTS_HTTP_OK) {
+        ret = ERROR_HTTP_STATUS_INVALID;
+        srs_error("bench: http status %d invalid. ret=%d", msg->status_code(), ret);
+        return ret;
+    }
+    reader = msg->body_reader();
+    
+    // the flv header and the first previous tag size.
+    char header[13];
+    if ((ret = read_fully(header, sizeof(header))) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    for (;;) {
+        char th[11];
+        if ((ret = read_fully(th, sizeof(th))) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        char type = th[0] & 0x1f;
+        int32_t size = ((u_int8_t)th[1] << 16) | ((u_int8_t)th[2] << 8) | (u_int8_t)th[3];
+        
+        // the tag data and the previous tag size.
+        char* data = new char[size + 4];
+        SrsAutoFreeA(char, data);
+        if ((ret = read_fully(data, size + 4)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        if (type == SrsCodecFlvTagAudio || type == SrsCodecFlvTagVideo) {
+            on_msg(size);
+            continue;
+        }
+        
+        if (type != SrsCodecFlvTagScript) {
+            continue;
+        }
+        
+        SrsStream stream;
+        if ((ret = stream.initialize(data, size)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        SrsOnMetaDataPacket* metadata = new SrsOnMetaDataPacket();
+        SrsAutoFree(SrsOnMetaDataPacket, metadata);
+        if (metadata->decode(&stream) == ERROR_SUCCESS) {
+            on_metadata(metadata->metadata);
+        }
+    }
+    
+    return ret;
+}
+
+int SrsBenchFlvPlayer::read_fully(char* data, int size)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int nb_read = 0;
+    while (nb_read < size) {
+        int nb = 0;
+        if ((ret = reader->read(data + nb_read, size - nb_read, &nb)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        nb_read += nb;
+        nb_bytes += nb;
+    }
+    
+    return ret;
+}
+
+/**
+ * get the url of stream for the index of client,
+ * append the index to stream name when there are multiple streams.
+ */
+string srs_bench_url(string url, int index, int nb_streams)
+{
+    if (nb_streams <= 1) {
+        return url;
+    }
+    
+    std::stringstream ss;
+    ss << "_" << (index % nb_streams);
+    
+    // insert before the extension of http-flv, for example, livestream_0.flv
+    size_t pos = url.rfind(".flv");
+    if (pos != string::npos) {
+        return url.substr(0, pos) + ss.str() + url.substr(pos);
+    }
+    
+    return url + ss.str();
+}
+
+/**
+ * get the cpu time in ms of process, user and system.
+ * @param pid the process id, 0 for self.
+ */
+int64_t srs_bench_cpu_ms(int pid)
+{
+    if (pid <= 0) {
+        rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) < 0) {
+            return 0;
+        }
+        return ru.ru_utime.tv_sec * 1000 + ru.ru_utime.tv_usec / 1000
+            + ru.ru_stime.tv_sec * 1000 + ru.ru_stime.tv_usec / 1000;
+    }
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return 0;
+    }
+    
+    // the utime and stime is the 14th and 15th field, in clock ticks.
+    unsigned long utime = 0, stime = 0;
+    int nb = fscanf(f, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+    fclose(f);
+    
+    if (nb != 2) {
+        return 0;
+    }
+    
+    return (int64_t)(utime + stime) * 1000 / sysconf(_SC_CLK_TCK);
+}
+
+/**
+ * dumps the result of clients in json.
+ */
+int srs_bench_dumps(std::stringstream& ss, std::vector<SrsBenchClient*>& clients, SrsBenchClientType type,
+    int64_t duration)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int nb_clients = 0;
+    int nb_alive = 0;
+    int64_t nb_msgs = 0;
+    int64_t nb_bytes = 0;
+    SrsPerfHistogram startup;
+    SrsPerfHistogram latency;
+    
+    for (int i = 0; i < (int)clients.size(); i++) {
+        SrsBenchClient* client = clients.at(i);
+        if (client->type != type) {
+            continue;
+        }
+        
+        nb_clients++;
+        nb_alive += client->alive? 1 : 0;
+        nb_msgs += client->nb_msgs;
+        nb_bytes += client->nb_bytes;
+        
+        if (client->startup >= 0) {
+            startup.record(client->startup);
+        }
+        
+        // merge all latency samples of client.
+        latency.merge(&client->latency);
+    }
+    
+    int64_t kbps = (duration > 0)? nb_bytes * 8 / duration : 0;
+    
+    ss << SRS_JOBJECT_START
+            << SRS_JFIELD_ORG("clients", nb_clients) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("alive", nb_alive) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("msgs", nb_msgs) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("bytes", nb_bytes) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("kbps", kbps) << SRS_JFIELD_CONT
+            << SRS_JFIELD_OBJ("startup_ms")
+                << SRS_JFIELD_ORG("avg", startup.avg()) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("p99", startup.percentile(99)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("max", startup.get_max())
+            << SRS_JOBJECT_END << SRS_JFIELD_CONT
+            << SRS_JFIELD_OBJ("latency_us")
+                << SRS_JFIELD_ORG("avg", latency.avg()) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("p99", latency.percentile(99)) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("max", latency.get_max())
+            << SRS_JOBJECT_END
+        << SRS_JOBJECT_END;
+    
+    return ret;
+}
+
+int run_bench(string input, string rtmp_url, string flv_url, int nb_publishers, int nb_rtmp_players,
+    int nb_flv_players, int duration, int delay, int server_pid, string output)
+{
+    int ret = ERROR_SUCCESS;
+    
+    if ((ret = srs_st_init()) != ERROR_SUCCESS) {
+        srs_error("init st failed. ret=%d", ret);
+        return ret;
+    }
+    
+    std::vector<SrsBenchClient*> clients;
+    int nb_streams = nb_publishers;
+    
+    for (int i = 0; i < nb_publishers; i++) {
+        clients.push_back(new SrsBenchPublisher(srs_bench_url(rtmp_url, i, nb_streams), input));
+    }
+    for (int i = 0; i < nb_rtmp_players; i++) {
+        clients.push_back(new SrsBenchRtmpPlayer(srs_bench_url(rtmp_url, i, nb_streams)));
+    }
+    for (int i = 0; i < nb_flv_players; i++) {
+        clients.push_back(new SrsBenchFlvPlayer(srs_bench_url(flv_url, i, nb_streams)));
+    }
+    
+    int64_t self_cpu = srs_bench_cpu_ms(0);
+    int64_t server_cpu = srs_bench_cpu_ms(server_pid);
+    int64_t starttime = srs_update_system_time_ms();
+    
+    // start the clients, the publishers first.
+    for (int i = 0; i < (int)clients.size(); i++) {
+        SrsBenchClient* client = clients.at(i);
+        if ((ret = client->start()) != ERROR_SUCCESS) {
+            srs_error("start bench client failed. ret=%d", ret);
+            return ret;
+        }
+        if (delay > 0) {
+            st_usleep(delay * 1000);
+        }
+    }
+    
+    // wait for the duration, show the summary every second.
+    for (;;) {
+        st_usleep(1000 * 1000);
+        
+        int64_t elapsed = srs_update_system_time_ms() - starttime;
+        
+        int nb_alive = 0;
+        int64_t nb_bytes = 0;
+        for (int i = 0; i < (int)clients.size(); i++) {
+            SrsBenchClient* client = clients.at(i);
+            nb_alive += client->alive? 1 : 0;
+            nb_bytes += client->nb_bytes;
+        }
+        srs_trace("bench %"PRId64"s, alive %d/%d, bytes %"PRId64", kbps %"PRId64,
+            elapsed / 1000, nb_alive, (int)clients.size(), nb_bytes, (elapsed > 0)? nb_bytes * 8 / elapsed : 0);
+        
+        if (elapsed >= duration * 1000) {
+            break;
+        }
+    }
+    
+    int64_t elapsed = srs_update_system_time_ms() - starttime;
+    self_cpu = srs_bench_cpu_ms(0) - self_cpu;
+    server_cpu = (server_pid > 0)? srs_bench_cpu_ms(server_pid) - server_cpu : 0;
+    int nb_clients = srs_max(1, (int)clients.size());
+    double server_percent = (elapsed > 0)? server_cpu * 100.0 / elapsed : 0;
+    
+    std::stringstream ss;
+    ss << SRS_JOBJECT_START
+            << SRS_JFIELD_ORG("duration_ms", elapsed) << SRS_JFIELD_CONT
+            << SRS_JFIELD_OBJ("cpu")
+                << SRS_JFIELD_ORG("bench_ms", self_cpu) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("server_ms", server_cpu) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("server_percent", server_percent) << SRS_JFIELD_CONT
+                << SRS_JFIELD_ORG("server_ms_per_client", server_cpu / nb_clients)
+            << SRS_JOBJECT_END << SRS_JFIELD_CONT;
+    
+    ss << SRS_JFIELD_NAME("publishers");
+    srs_bench_dumps(ss, clients, SrsBenchClientPublish, elapsed);
+    ss << SRS_JFIELD_CONT << SRS_JFIELD_NAME("rtmp_players");
+    srs_bench_dumps(ss, clients, SrsBenchClientRtmpPlay, elapsed);
+    ss << SRS_JFIELD_CONT << SRS_JFIELD_NAME("flv_players");
+    srs_bench_dumps(ss, clients, SrsBenchClientFlvPlay, elapsed);
+    ss << SRS_JOBJECT_END;
+    
+    std::string result = ss.str();
+    if (output.empty()) {
+        printf("%s\n", result.c_str());
+        return ret;
+    }
+    
+    SrsFileWriter fw;
+    if ((ret = fw.open(output)) != ERROR_SUCCESS) {
+        srs_error("open output %s failed. ret=%d", output.c_str(), ret);
+        return ret;
+    }
+    if ((ret = fw.write((void*)result.data(), result.length(), NULL)) != ERROR_SUCCESS) {
+        srs_error("write output %s failed. ret=%d", output.c_str(), ret);
+        return ret;
+    }
+    srs_trace("bench result write to %s", output.c_str());
+    
+    return ret;
+}
+
+/**
+* main entrance.
+*/
+int main(int argc, char** argv) 
+{
+    // TODO: support both little and big endian.
+    srs_assert(srs_is_little_endian());
+    
+    srs_trace("srs_bench base on %s, to bench the fan-out of server", RTMP_SIG_SRS_SERVER);
+    
+    // parse user options.
+    std::string input, rtmp_url, flv_url, output;
+    int nb_publishers = 0, nb_rtmp_players = 0, nb_flv_players = 0;
+    int duration = 30, delay = 10, server_pid = 0;
+    
+    for (int opt = 0; opt < argc - 1; opt++) {
+        // ignore all options except -x.
+        char* p = argv[opt];
+        
+        // only accept -x
+        if (p[0] != '-' || p[1] == 0 || p[2] != 0) {
+            continue;
+        }
+        
+        // parse according the option name.
+        switch (p[1]) {
+            case 'i': input = argv[opt + 1]; break;
+            case 'y': rtmp_url = argv[opt + 1]; break;
+            case 'f': flv_url = argv[opt + 1]; break;
+            case 'n': nb_publishers = ::atoi(argv[opt + 1]); break;
+            case 'c': nb_rtmp_players = ::atoi(argv[opt + 1]); break;
+            case 'b': nb_flv_players = ::atoi(argv[opt + 1]); break;
+            case 't': duration = ::atoi(argv[opt + 1]); break;
+            case 'd': delay = ::atoi(argv[opt + 1]); break;
+            case 's': server_pid = ::atoi(argv[opt + 1]); break;
+            case 'o': output = argv[opt + 1]; break;
+            default: break;
+        }
+    }
+    
+    bool invalid = nb_publishers + nb_rtmp_players + nb_flv_players <= 0;
+    invalid |= nb_publishers > 0 && (input.empty() || rtmp_url.empty());
+    invalid |= nb_rtmp_players > 0 && rtmp_url.empty();
+    invalid |= nb_flv_players > 0 && flv_url.empty();
+    
+    if (invalid) {
+        printf("bench the publish and play fan-out of server, write the result in json\n"
+               "Usage: %s [-i input_flv] [-y rtmp_url] [-f flv_url] [-n publishers] [-c rtmp_players] [-b flv_players]\n"
+               "          [-t duration] [-d delay] [-s server_pid] [-o output]\n"
+               "   input_flv       the flv file to publish in loop.\n"
+               "   rtmp_url        the rtmp url to publish and play, append _N to stream when multiple publishers.\n"
+               "   flv_url         the http-flv url to play, append _N to stream when multiple publishers.\n"
+               "   publishers      the number of publishers, default 0.\n"
+               "   rtmp_players    the number of rtmp players, default 0.\n"
+               "   flv_players     the number of http-flv players, default 0.\n"
+               "   duration        the duration in seconds to bench, default 30.\n"
+               "   delay           the delay in ms between start clients, default 10.\n"
+               "   server_pid      the pid of server to stat the cpu, default 0 to ignore.\n"
+               "   output          the json file to write result, default to stdout.\n"
+               "For example:\n"
+               "   %s -i doc/source.200kbps.768x320.flv -y rtmp://127.0.0.1/live/livestream -n 1 -c 100\n"
+               "   %s -i doc/source.200kbps.768x320.flv -y rtmp://127.0.0.1/live/livestream -f http://127.0.0.1:8080/live/livestream.flv -n 10 -c 500 -b 500 -t 60 -o bench.json\n",
+               argv[0], argv[0], argv[0]);
+        exit(-1);
+    }
+    
+    return run_bench(input, rtmp_url, flv_url, nb_publishers, nb_rtmp_players, nb_flv_players,
+        duration, delay, server_pid, output);
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+    srs_error("bench requires http-api or http-server");
+    return -1;
+}
+
+#endif
+
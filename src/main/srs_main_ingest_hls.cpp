@@ -691,6 +691,7 @@ public:
 private:
     virtual int do_on_aac_frame(SrsStream* avs, double duration);
     virtual int parse_message_queue();
+    virtual int consume_message(SrsTsMessage* msg);
     virtual int on_ts_video(SrsTsMessage* msg, SrsStream* avs);
     virtual int write_h264_sps_pps(u_int32_t dts, u_int32_t pts);
     virtual int write_h264_ipb_frame(std::string ibps, SrsCodecVideoAVCFrame frame_type, u_int32_t dts, u_int32_t pts);
@@ -898,33 +899,41 @@ int SrsIngestSrsOutput::parse_message_queue()
         std::multimap<int64_t, SrsTsMessage*>::iterator it = queue.begin();
         
         SrsTsMessage* msg = it->second;
-        SrsAutoFree(SrsTsMessage, msg);
         queue.erase(it);
         
         if (msg->channel->stream == SrsTsStreamVideoH264) {
             nb_videos--;
         }
         
-        // parse the stream.
-        SrsStream avs;
-        if ((ret = avs.initialize(msg->payload->bytes(), msg->payload->length())) != ERROR_SUCCESS) {
-            srs_error("mpegts: initialize av stream failed. ret=%d", ret);
+        if ((ret = consume_message(msg)) != ERROR_SUCCESS) {
             return ret;
         }
-        
+    }
+    
+    return ret;
+}
+
+int SrsIngestSrsOutput::consume_message(SrsTsMessage* msg)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // parse the stream.
+    SrsStream avs;
+    if ((ret = avs.initialize(msg->payload->bytes(), msg->payload->length())) == ERROR_SUCCESS) {
         // publish audio or video.
         if (msg->channel->stream == SrsTsStreamVideoH264) {
-            if ((ret = on_ts_video(msg, &avs)) != ERROR_SUCCESS) {
-                return ret;
-            }
-        }
-        if (msg->channel->stream == SrsTsStreamAudioAAC) {
-            if ((ret = on_ts_audio(msg, &avs)) != ERROR_SUCCESS) {
-                return ret;
-            }
+            ret = on_ts_video(msg, &avs);
+        } else if (msg->channel->stream == SrsTsStreamAudioAAC) {
+            ret = on_ts_audio(msg, &avs);
         }
+    } else {
+        srs_error("mpegts: initialize av stream failed. ret=%d", ret);
     }
     
+    // the detached msg owns the payload, recycle it to the ts context,
+    // so the demuxer reuses the payload buffer for the next PES.
+    msg->channel->context->recycle(msg);
+    
     return ret;
 }
 
@@ -937,27 +946,11 @@ int SrsIngestSrsOutput::flush_message_queue()
         std::multimap<int64_t, SrsTsMessage*>::iterator it = queue.begin();
         
         SrsTsMessage* msg = it->second;
-        SrsAutoFree(SrsTsMessage, msg);
         queue.erase(it);
         
-        // parse the stream.
-        SrsStream avs;
-        if ((ret = avs.initialize(msg->payload->bytes(), msg->payload->length())) != ERROR_SUCCESS) {
-            srs_error("mpegts: initialize av stream failed. ret=%d", ret);
+        if ((ret = consume_message(msg)) != ERROR_SUCCESS) {
             return ret;
         }
-        
-        // publish audio or video.
-        if (msg->channel->stream == SrsTsStreamVideoH264) {
-            if ((ret = on_ts_video(msg, &avs)) != ERROR_SUCCESS) {
-                return ret;
-            }
-        }
-        if (msg->channel->stream == SrsTsStreamAudioAAC) {
-            if ((ret = on_ts_audio(msg, &avs)) != ERROR_SUCCESS) {
-                return ret;
-            }
-        }
     }
     
     return ret;
@@ -0,0 +1,1215 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013-2015 SRS(ossrs)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <srs_core.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <sstream>
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_kernel_file.hpp>
+#include <srs_kernel_flv.hpp>
+#include <srs_kernel_ts.hpp>
+#include <srs_kernel_codec.hpp>
+#include <srs_kernel_stream.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_perf.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_rtmp_stack.hpp>
+#include <srs_rtmp_amf0.hpp>
+#include <srs_rtmp_io.hpp>
+#include <srs_rtmp_utility.hpp>
+#include <srs_http_stack.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_app_server.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_log.hpp>
+
+// for the main objects(server, config, log, context),
+// never subscribe handler in constructor,
+// instead, subscribe handler in initialize method.
+// kernel module.
+ISrsLog* _srs_log = new SrsFastLog();
+ISrsThreadContext* _srs_context = new SrsThreadContext();
+// app module.
+SrsConfig* _srs_config = NULL;
+SrsServer* _srs_server = NULL;
+
+// the reference byte-at-a-time crc32, @see srs_kernel_utility.cpp
+extern unsigned int mpegts_crc32(const u_int8_t *data, int len);
+
+// the number of mounts for the http mux bench.
+#define SRS_MICRO_BENCH_MOUNTS 50000
+
+/**
+ * the tag of flv sample file, which feed the benchmarks.
+ */
+struct SrsMicroTag
+{
+public:
+    char type;
+    u_int32_t time;
+    char* data;
+    int size;
+};
+
+/**
+ * the result of a benchmark, comparable across commits.
+ */
+struct SrsMicroResult
+{
+public:
+    std::string name;
+    // the total operations, for example, the number of frames.
+    int64_t ops;
+    // the total bytes processed, 0 if not applicable.
+    int64_t bytes;
+    // the elapsed time in us.
+    int64_t us;
+    // the result of the benchmark, dumped to output,
+    // to avoid the compiler to optimize the work away.
+    int64_t checksum;
+public:
+    SrsMicroResult();
+    virtual ~SrsMicroResult();
+public:
+    virtual double ns_per_op();
+    virtual double mbps();
+    virtual int dumps(std::stringstream& ss);
+};
+
+/**
+ * the context of benchmarks.
+ */
+struct SrsMicroContext
+{
+public:
+    // the tags of flv sample file, empty if no sample.
+    std::vector<SrsMicroTag> tags;
+    // the rounds to run the benchmarks.
+    int rounds;
+public:
+    SrsMicroContext();
+    virtual ~SrsMicroContext();
+public:
+    virtual int load(std::string file);
+    // create the shared ptr messages of tags, user must free them.
+    virtual int create_msgs(SrsSharedPtrMessage** msgs);
+};
+
+/**
+ * the writer which only count the bytes,
+ * to bench the muxer without the cost of disk.
+ */
+class SrsMicroNullWriter : public SrsFileWriter
+{
+private:
+    int64_t nb_bytes;
+public:
+    SrsMicroNullWriter();
+    virtual ~SrsMicroNullWriter();
+public:
+    virtual int64_t size();
+public:
+    virtual int open(std::string p);
+    virtual void close();
+    virtual bool is_open();
+    virtual void lseek(int64_t offset);
+    virtual int64_t tellg();
+    virtual int write(void* buf, size_t count, ssize_t* pnwrite);
+    virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite);
+};
+
+/**
+ * the in-memory io for protocol, write to buffer and read from it.
+ */
+class SrsMicroBufferIO : public ISrsProtocolReaderWriter
+{
+public:
+    SrsSimpleBuffer out;
+    // the bytes to read and the read position.
+    char* in;
+    int nb_in;
+    int pos;
+private:
+    int64_t recv_bytes;
+    int64_t send_bytes;
+public:
+    SrsMicroBufferIO();
+    virtual ~SrsMicroBufferIO();
+public:
+    virtual bool is_never_timeout(int64_t timeout_us);
+    virtual void set_recv_timeout(int64_t timeout_us);
+    virtual int64_t get_recv_timeout();
+    virtual int64_t get_recv_bytes();
+    virtual void set_send_timeout(int64_t timeout_us);
+    virtual int64_t get_send_timeout();
+    virtual int64_t get_send_bytes();
+    virtual int read(void* buf, size_t size, ssize_t* nread);
+    virtual int read_fully(void* buf, size_t size, ssize_t* nread);
+    virtual int write(void* buf, size_t size, ssize_t* nwrite);
+    virtual int writev(const iovec *iov, int iov_size, ssize_t* nwrite);
+};
+
+SrsMicroResult::SrsMicroResult()
+{
+    ops = bytes = us = 0;
+    checksum = 0;
+}
+
+SrsMicroResult::~SrsMicroResult()
+{
+}
+
+double SrsMicroResult::ns_per_op()
+{
+    if (ops <= 0) {
+        return 0;
+    }
+    return us * 1000.0 / ops;
+}
+
+double SrsMicroResult::mbps()
+{
+    if (us <= 0) {
+        return 0;
+    }
+    // bytes/us is MB/s.
+    return (double)bytes / us;
+}
+
+int SrsMicroResult::dumps(std::stringstream& ss)
+{
+    int ret = ERROR_SUCCESS;
+    
+    ss << SRS_JOBJECT_START
+            << SRS_JFIELD_STR("name", name) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("ops", ops) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("bytes", bytes) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("us", us) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("ns_per_op", ns_per_op()) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("mbps", mbps()) << SRS_JFIELD_CONT
+            << SRS_JFIELD_ORG("checksum", checksum)
+        << SRS_JOBJECT_END;
+    
+    return ret;
+}
+
+SrsMicroContext::SrsMicroContext()
+{
+    rounds = 100;
+}
+
+SrsMicroContext::~SrsMicroContext()
+{
+    for (int i = 0; i < (int)tags.size(); i++) {
+        SrsMicroTag& tag = tags.at(i);
+        srs_freepa(tag.data);
+    }
+    tags.clear();
+}
+
+int SrsMicroContext::load(string file)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsFileReader fr;
+    if ((ret = fr.open(file)) != ERROR_SUCCESS) {
+        srs_error("open sample %s failed. ret=%d", file.c_str(), ret);
+        return ret;
+    }
+    
+    SrsFlvDecoder dec;
+    if ((ret = dec.initialize(&fr)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    char header[9];
+    if ((ret = dec.read_header(header)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    char pts[4];
+    if ((ret = dec.read_previous_tag_size(pts)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    while (fr.tellg() < fr.filesize()) {
+        SrsMicroTag tag;
+        int32_t size = 0;
+        if ((ret = dec.read_tag_header(&tag.type, &size, &tag.time)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        tag.size = size;
+        tag.data = new char[size];
+        if ((ret = dec.read_tag_data(tag.data, size)) != ERROR_SUCCESS) {
+            srs_freepa(tag.data);
+            return ret;
+        }
+        tags.push_back(tag);
+        
+        if ((ret = dec.read_previous_tag_size(pts)) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    srs_trace("load sample %s, %d tags", file.c_str(), (int)tags.size());
+    
+    return ret;
+}
+
+int SrsMicroContext::create_msgs(SrsSharedPtrMessage** msgs)
+{
+    int ret = ERROR_SUCCESS;
+    
+    for (int i = 0; i < (int)tags.size(); i++) {
+        SrsMicroTag& tag = tags.at(i);
+        
+        // the msg own the data, so copy it.
+        char* data = new char[tag.size];
+        memcpy(data, tag.data, tag.size);
+        
+        if ((ret = srs_rtmp_create_msg(tag.type, tag.time, data, tag.size, 1, &msgs[i])) != ERROR_SUCCESS) {
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
+SrsMicroNullWriter::SrsMicroNullWriter()
+{
+    nb_bytes = 0;
+}
+
+SrsMicroNullWriter::~SrsMicroNullWriter()
+{
+}
+
+int64_t SrsMicroNullWriter::size()
+{
+    return nb_bytes;
+}
+
+int SrsMicroNullWriter::open(string /*p*/)
+{
+    return ERROR_SUCCESS;
+}
+
+void SrsMicroNullWriter::close()
+{
+}
+
+bool SrsMicroNullWriter::is_open()
+{
+    return true;
+}
+
+void SrsMicroNullWriter::lseek(int64_t offset)
+{
+    nb_bytes = offset;
+}
+
+int64_t SrsMicroNullWriter::tellg()
+{
+    return nb_bytes;
+}
+
+int SrsMicroNullWriter::write(void* /*buf*/, size_t count, ssize_t* pnwrite)
+{
+    nb_bytes += count;
+    if (pnwrite) {
+        *pnwrite = count;
+    }
+    return ERROR_SUCCESS;
+}
+
+int SrsMicroNullWriter::writev(iovec* iov, int iovcnt, ssize_t* pnwrite)
+{
+    ssize_t nb = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        nb += iov[i].iov_len;
+    }
+    
+    nb_bytes += nb;
+    if (pnwrite) {
+        *pnwrite = nb;
+    }
+    return ERROR_SUCCESS;
+}
+
+SrsMicroBufferIO::SrsMicroBufferIO()
+{
+    in = NULL;
+    nb_in = pos = 0;
+    recv_bytes = send_bytes = 0;
+}
+
+SrsMicroBufferIO::~SrsMicroBufferIO()
+{
+}
+
+bool SrsMicroBufferIO::is_never_timeout(int64_t timeout_us)
+{
+    return true;
+}
+
+void SrsMicroBufferIO::set_recv_timeout(int64_t /*timeout_us*/)
+{
+}
+
+int64_t SrsMicroBufferIO::get_recv_timeout()
+{
+    return -1;
+}
+
+int64_t SrsMicroBufferIO::get_recv_bytes()
+{
+    return recv_bytes;
+}
+
+void SrsMicroBufferIO::set_send_timeout(int64_t /*timeout_us*/)
+{
+}
+
+int64_t SrsMicroBufferIO::get_send_timeout()
+{
+    return -1;
+}
+
+int64_t SrsMicroBufferIO::get_send_bytes()
+{
+    return send_bytes;
+}
+
+int SrsMicroBufferIO::read(void* buf, size_t size, ssize_t* nread)
+{
+    if (pos >= nb_in) {
+        return ERROR_SOCKET_READ;
+    }
+    
+    int nb = srs_min((int)size, nb_in - pos);
+    memcpy(buf, in + pos, nb);
+    pos += nb;
+    recv_bytes += nb;
+    
+    if (nread) {
+        *nread = nb;
+    }
+    return ERROR_SUCCESS;
+}
+
+int SrsMicroBufferIO::read_fully(void* buf, size_t size, ssize_t* nread)
+{
+    if (nb_in - pos < (int)size) {
+        return ERROR_SOCKET_READ;
+    }
+    return read(buf, size, nread);
+}
+
+int SrsMicroBufferIO::write(void* buf, size_t size, ssize_t* nwrite)
+{
+    out.append((char*)buf, (int)size);
+    send_bytes += size;
+    
+    if (nwrite) {
+        *nwrite = size;
+    }
+    return ERROR_SUCCESS;
+}
+
+int SrsMicroBufferIO::writev(const iovec *iov, int iov_size, ssize_t* nwrite)
+{
+    ssize_t nb = 0;
+    for (int i = 0; i < iov_size; i++) {
+        out.append((char*)iov[i].iov_base, (int)iov[i].iov_len);
+        nb += iov[i].iov_len;
+    }
+    send_bytes += nb;
+    
+    if (nwrite) {
+        *nwrite = nb;
+    }
+    return ERROR_SUCCESS;
+}
+
+// demux the avc and aac of all tags.
+int bench_codec_demux(SrsMicroContext* ctx, SrsMicroResult* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsAvcAacCodec codec;
+    SrsCodecSample sample;
+    
+    int64_t starttime = srs_perf_now_us();
+    for (int round = 0; round < ctx->rounds; round++) {
+        for (int i = 0; i < (int)ctx->tags.size(); i++) {
+            SrsMicroTag& tag = ctx->tags.at(i);
+            
+            sample.clear();
+            if (tag.type == SrsCodecFlvTagVideo) {
+                if ((ret = codec.video_avc_demux(tag.data, tag.size, &sample)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else if (tag.type == SrsCodecFlvTagAudio) {
+                if ((ret = codec.audio_aac_demux(tag.data, tag.size, &sample)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else {
+                continue;
+            }
+            
+            r->ops++;
+            r->bytes += tag.size;
+        }
+    }
+    r->us = srs_perf_now_us() - starttime;
+    
+    return ret;
+}
+
+// mux all tags to ts, demux and PES packetize by SrsTsContext::encode.
+int bench_ts_encode(SrsMicroContext* ctx, SrsMicroResult* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsMicroNullWriter writer;
+    SrsTsEncoder enc;
+    if ((ret = enc.initialize(&writer)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    int64_t starttime = srs_perf_now_us();
+    for (int round = 0; round < ctx->rounds; round++) {
+        // the timestamp must be monotonically.
+        int64_t base = (int64_t)round * (ctx->tags.empty()? 0 : ctx->tags.back().time + 40);
+        
+        for (int i = 0; i < (int)ctx->tags.size(); i++) {
+            SrsMicroTag& tag = ctx->tags.at(i);
+            
+            if (tag.type == SrsCodecFlvTagVideo) {
+                if ((ret = enc.write_video(base + tag.time, tag.data, tag.size)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else if (tag.type == SrsCodecFlvTagAudio) {
+                if ((ret = enc.write_audio(base + tag.time, tag.data, tag.size)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+            } else {
+                continue;
+            }
+            
+            r->ops++;
+        }
+    }
+    r->us = srs_perf_now_us() - starttime;
+    r->bytes = writer.size();
+    
+    return ret;
+}
+
+// write all tags by SrsFlvEncoder::write_tags, in the batch of 128 msgs.
+int bench_flv_write_tags(SrsMicroContext* ctx, SrsMicroResult* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int nb_msgs = (int)ctx->tags.size();
+    SrsSharedPtrMessage** msgs = new SrsSharedPtrMessage*[nb_msgs];
+    SrsAutoFreeA(SrsSharedPtrMessage*, msgs);
+    if ((ret = ctx->create_msgs(msgs)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    SrsMicroNullWriter writer;
+    SrsFlvEncoder enc;
+    if ((ret = enc.initialize(&writer)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    int64_t starttime = srs_perf_now_us();
+    for (int round = 0; round < ctx->rounds; round++) {
+        for (int i = 0; i < nb_msgs; i += 128) {
+            int count = srs_min(128, nb_msgs - i);
+            if ((ret = enc.write_tags(msgs + i, count)) != ERROR_SUCCESS) {
+                break;
+            }
+            r->ops += count;
+        }
+    }
+    r->us = srs_perf_now_us() - starttime;
+    r->bytes = writer.size();
+    
+    for (int i = 0; i < nb_msgs; i++) {
+        srs_freep(msgs[i]);
+    }
+    
+    return ret;
+}
+
+// encode all tags to rtmp chunks, then decode the chunks to messages.
+int bench_chunk_codec(SrsMicroContext* ctx, SrsMicroResult* encode, SrsMicroResult* decode)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int nb_msgs = (int)ctx->tags.size();
+    SrsSharedPtrMessage** masters = new SrsSharedPtrMessage*[nb_msgs];
+    SrsAutoFreeA(SrsSharedPtrMessage*, masters);
+    if ((ret = ctx->create_msgs(masters)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    SrsSharedPtrMessage** msgs = new SrsSharedPtrMessage*[nb_msgs];
+    SrsAutoFreeA(SrsSharedPtrMessage*, msgs);
+    
+    // encode, the send free the msgs, so copy them each round.
+    SrsMicroBufferIO io;
+    if (true) {
+        SrsProtocol protocol(&io);
+        
+        int64_t starttime = srs_perf_now_us();
+        for (int round = 0; round < ctx->rounds; round++) {
+            for (int i = 0; i < nb_msgs; i++) {
+                msgs[i] = masters[i]->copy();
+            }
+            
+            // only keep the chunks of first round for decode.
+            if (round > 0) {
+                io.out.erase(io.out.length());
+            }
+            
+            if ((ret = protocol.send_and_free_messages(msgs, nb_msgs, 1)) != ERROR_SUCCESS) {
+                break;
+            }
+            
+            encode->ops += nb_msgs;
+        }
+        encode->us = srs_perf_now_us() - starttime;
+        encode->bytes = io.get_send_bytes();
+    }
+    
+    for (int i = 0; i < nb_msgs; i++) {
+        srs_freep(masters[i]);
+    }
+    
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // decode the chunks of one round, by a new protocol each round.
+    if (true) {
+        int64_t starttime = srs_perf_now_us();
+        for (int round = 0; round < ctx->rounds; round++) {
+            io.in = io.out.bytes();
+            io.nb_in = io.out.length();
+            io.pos = 0;
+            
+            SrsProtocol protocol(&io);
+            for (int i = 0; i < nb_msgs; i++) {
+                SrsCommonMessage* msg = NULL;
+                if ((ret = protocol.recv_message(&msg)) != ERROR_SUCCESS) {
+                    return ret;
+                }
+                srs_freep(msg);
+                decode->ops++;
+            }
+            decode->bytes += io.nb_in;
+        }
+        decode->us = srs_perf_now_us() - starttime;
+    }
+    
+    return ret;
+}
+
+// decode the amf0 of packet, which encoded once.
+int bench_amf0_decode(SrsMicroContext* ctx, SrsPacket* pkt, SrsPacket* (*create)(), SrsMicroResult* r)
+{
+    int ret = ERROR_SUCCESS;
+    
+    int size = 0;
+    char* payload = NULL;
+    if ((ret = pkt->encode(size, payload)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    SrsAutoFreeA(char, payload);
+    
+    int64_t starttime = srs_perf_now_us();
+    for (int i = 0; i < ctx->rounds * 100; i++) {
+        SrsStream stream;
+        if ((ret = stream.initialize(payload, size)) != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        SrsPacket* p = create();
+        ret = p->decode(&stream);
+        srs_freep(p);
+        
+        if (ret != ERROR_SUCCESS) {
+            return ret;
+        }
+        
+        r->ops++;
+        r->bytes += size;
+    }
+    r->us = srs_perf_now_us() - starttime;
+    
+    return ret;
+}
+
+SrsPacket* bench_create_connect()
+{
+    return new SrsConnectAppPacket();
+}
+
+SrsPacket* bench_create_metadata()
+{
+    return new SrsOnMetaDataPacket();
+}
+
+int bench_amf0_connect(SrsMicroContext* ctx, SrsMicroResult* r)
+{
+    SrsConnectAppPacket* pkt = new SrsConnectAppPacket();
+    SrsAutoFree(SrsConnectAppPacket, pkt);
+    
+    pkt->command_object->set("app", SrsAmf0Any::str("live"));
+    pkt->command_object->set("flashVer", SrsAmf0Any::str("WIN 15,0,0,239"));
+    pkt->command_object->set("swfUrl", SrsAmf0Any::str("http://ossrs.net/players/srs_player.swf"));
+    pkt->command_object->set("tcUrl", SrsAmf0Any::str("rtmp://127.0.0.1:1935/live"));
+    pkt->command_object->set("fpad", SrsAmf0Any::boolean(false));
+    pkt->command_object->set("capabilities", SrsAmf0Any::number(239));
+    pkt->command_object->set("audioCodecs", SrsAmf0Any::number(3575));
+    pkt->command_object->set("videoCodecs", SrsAmf0Any::number(252));
+    pkt->command_object->set("videoFunction", SrsAmf0Any::number(1));
+    pkt->command_object->set("pageUrl", SrsAmf0Any::str("http://ossrs.net/players/srs_player.html"));
+    pkt->command_object->set("objectEncoding", SrsAmf0Any::number(0));
+    
+    return bench_amf0_decode(ctx, pkt, bench_create_connect, r);
+}
+
+int bench_amf0_metadata(SrsMicroContext* ctx, SrsMicroResult* r)
+{
+    SrsOnMetaDataPacket* pkt = new SrsOnMetaDataPacket();
+    SrsAutoFree(SrsOnMetaDataPacket, pkt);
+    
+    pkt->metadata->set("duration", SrsAmf0Any::number(0));
+    pkt->metadata->set("width", SrsAmf0Any::number(768));
+    pkt->metadata->set("height", SrsAmf0Any::number(320));
+    pkt->metadata->set("videodatarate", SrsAmf0Any::number(200));
+    pkt->metadata->set("framerate", SrsAmf0Any::number(25));
+    pkt->metadata->set("videocodecid", SrsAmf0Any::number(7));
+    pkt->metadata->set("audiodatarate", SrsAmf0Any::number(64));
+    pkt->metadata->set("audiosamplerate", SrsAmf0Any::number(44100));
+    pkt->metadata->set("audiosamplesize", SrsAmf0Any::number(16));
+    pkt->metadata->set("stereo", SrsAmf0Any::boolean(true));
+    pkt->metadata->set("audiocodecid", SrsAmf0Any::number(10));
+    pkt->metadata->set("encoder", SrsAmf0Any::str("Lavf57.71.100"));
+    pkt->metadata->set("filesize", SrsAmf0Any::number(0));
+    
+    return bench_amf0_decode(ctx, pkt, bench_create_metadata, r);
+}
+
+// the reference byte-by-byte scan of annexb start code N[00] 00 00 01.
+int bench_find_annexb_reference(char* bytes, int size)
+{
+    for (int i = 0; i < size - 2; i++) {
+        if (bytes[i] == 0x00 && bytes[i + 1] == 0x00 && bytes[i + 2] == 0x01) {
+            while (i > 0 && bytes[i - 1] == 0x00) {
+                i--;
+            }
+            return i;
+        }
+    }
+    return -1;
+}
+
+// convert the avc NALUs of sample to annexb, the NALU length must be 4bytes.
+void bench_annexb_build(SrsMicroContext* ctx, SrsSimpleBuffer* annexb)
+{
+    static char start_code[] = {0x00, 0x00, 0x00, 0x01};
+    
+    for (int i = 0; i < (int)ctx->tags.size(); i++) {
+        SrsMicroTag& tag = ctx->tags.at(i);
+        
+        // only the avc NALUs, ignore the sequence header.
+        if (tag.type != SrsCodecFlvTagVideo || tag.size < 5) {
+            continue;
+        }
+        if ((tag.data[0] & 0x0f) != SrsCodecVideoAVC || tag.data[1] != SrsCodecVideoAVCTypeNALU) {
+            continue;
+        }
+        
+        char* p = tag.data + 5;
+        char* end = tag.data + tag.size;
+        while (end - p >= 4) {
+            int nb_nalu = (int)(((u_int8_t)p[0] << 24) | ((u_int8_t)p[1] << 16) | ((u_int8_t)p[2] << 8) | (u_int8_t)p[3]);
+            p += 4;
+            if (nb_nalu <= 0 || nb_nalu > end - p) {
+                break;
+            }
+            
+            annexb->append(start_code, sizeof(start_code));
+            annexb->append(p, nb_nalu);
+            p += nb_nalu;
+        }
+    }
+}
+
+// walk all start codes in annexb, the find is reference or SIMD.
+// @param positions output the positions of start codes, NULL to ignore.
+int bench_annexb_walk(char* bytes, int size, bool reference, std::vector<int>* positions)
+{
+    int nb_found = 0;
+    
+    int p = 0;
+    while (p < size) {
+        int pos = reference? bench_find_annexb_reference(bytes + p, size - p) : srs_avc_find_annexb(bytes + p, size - p);
+        if (pos < 0) {
+            break;
+        }
+        
+        p += pos;
+        nb_found++;
+        if (positions) {
+            positions->push_back(p);
+        }
+        
+        // skip the start code N[00] 00 00 01
+        while (p < size && bytes[p] == 0x00) {
+            p++;
+        }
+        p++;
+    }
+    
+    return nb_found;
+}
+
+// verify the SIMD scan equals to the reference byte-by-byte scan,
+// for all start codes of annexb, and each start offset of the head.
+int bench_annexb_verify(char* bytes, int size)
+{
+    int ret = ERROR_SUCCESS;
+    
+    std::vector<int> expect, actual;
+    bench_annexb_walk(bytes, size, true, &expect);
+    bench_annexb_walk(bytes, size, false, &actual);
+    
+    if (expect != actual) {
+        ret = ERROR_SYSTEM_ASSERT_FAILED;
+        srs_error("annexb mismatch, expect %d start codes, actual %d. ret=%d", (int)expect.size(), (int)actual.size(), ret);
+        return ret;
+    }
+    
+    for (int i = 0; i < srs_min(size, 4096); i++) {
+        int e = bench_find_annexb_reference(bytes + i, size - i);
+        int a = srs_avc_find_annexb(bytes + i, size - i);
+        if (e != a) {
+            ret = ERROR_SYSTEM_ASSERT_FAILED;
+            srs_error("annexb mismatch at offset %d, expect=%d, actual=%d. ret=%d", i, e, a, ret);
+            return ret;
+        }
+    }
+    
+    return ret;
+}
+
+// scan the start codes of avc NALUs from sample, for the reference and SIMD.
+int bench_annexb(SrsMicroContext* ctx, SrsMicroResult* r, bool reference)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsSimpleBuffer annexb;
+    bench_annexb_build(ctx, &annexb);
+    if (annexb.length() <= 0) {
+        srs_warn("no avc NALU in sample, ignore the annexb benchmark");
+        return ret;
+    }
+    
+    // the result must be correct before measure it.
+    if (!reference && (ret = bench_annexb_verify(annexb.bytes(), annexb.length())) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    // read the data by volatile pointer each round,
+    // avoid the compiler to hoist the scan out of loop.
+    char* volatile pbytes = annexb.bytes();
+    int size = annexb.length();
+    
+    int64_t found = 0;
+    int64_t starttime = srs_perf_now_us();
+    for (int i = 0; i < ctx->rounds; i++) {
+        int nb_found = bench_annexb_walk(pbytes, size, reference, NULL);
+        found += nb_found;
+        r->ops += nb_found;
+        r->bytes += size;
+    }
+    r->us = srs_perf_now_us() - starttime;
+    
+    // use the result, avoid the compiler to optimize it.
+    r->checksum = found;
+    
+    return ret;
+}
+
+// verify the slice-by-8 crc32 equals to the reference,
+// for all lengths in 1KB and all start alignments in 8 bytes.
+int bench_crc32_verify()
+{
+    int ret = ERROR_SUCCESS;
+    
+    u_int8_t data[1024 + 8];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (u_int8_t)((i * 131 + 17) ^ (i >> 3));
+    }
+    
+    for (int offset = 0; offset < 8; offset++) {
+        for (int len = 0; len <= 1024; len++) {
+            u_int32_t expect = mpegts_crc32(data + offset, len);
+            u_int32_t actual = srs_crc32(data + offset, len);
+            if (expect != actual) {
+                ret = ERROR_SYSTEM_ASSERT_FAILED;
+                srs_error("crc32 mismatch, offset=%d, len=%d, expect=%#x, actual=%#x. ret=%d",
+                    offset, len, expect, actual, ret);
+                return ret;
+            }
+        }
+    }
+    
+    return ret;
+}
+
+// the crc32 of PSI section(188 bytes), for the reference and slice-by-8.
+int bench_crc32(SrsMicroContext* ctx, SrsMicroResult* r, bool reference)
+{
+    int ret = ERROR_SUCCESS;
+    
+    // the result must be correct before measure it.
+    if (!reference && (ret = bench_crc32_verify()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    u_int8_t section[188];
+    for (int i = 0; i < (int)sizeof(section); i++) {
+        section[i] = (u_int8_t)(i * 7 + 3);
+    }
+    
+    // read the data by volatile pointer each round,
+    // avoid the compiler to hoist the crc out of loop.
+    u_int8_t* volatile psection = section;
+    
+    u_int32_t crc = 0;
+    int64_t starttime = srs_perf_now_us();
+    for (int i = 0; i < ctx->rounds * 1000; i++) {
+        if (reference) {
+            crc ^= mpegts_crc32(psection, sizeof(section));
+        } else {
+            crc ^= srs_crc32(psection, sizeof(section));
+        }
+        r->ops++;
+        r->bytes += sizeof(section);
+    }
+    r->us = srs_perf_now_us() - starttime;
+    
+    // use the result, avoid the compiler to optimize it.
+    r->checksum = crc;
+    
+    return ret;
+}
+
+// match the http-flv streams in the 50k mounts, for the radix tree and linear scan.
+int bench_http_mux(SrsMicroContext* ctx, SrsMicroResult* r, bool reference)
+{
+    int ret = ERROR_SUCCESS;
+    
+    std::vector<SrsHttpMuxEntry*> entries;
+    SrsHttpMuxTree tree;
+    
+    for (int i = 0; i < SRS_MICRO_BENCH_MOUNTS; i++) {
+        char pattern[64];
+        snprintf(pattern, sizeof(pattern), "/live/livestream_%d.flv", i);
+        
+        SrsHttpMuxEntry* entry = new SrsHttpMuxEntry();
+        entry->pattern = pattern;
+        entry->explicit_match = true;
+        entries.push_back(entry);
+        tree.insert(pattern, entry);
+    }
+    
+    int nb_matched = 0;
+    int64_t starttime = srs_perf_now_us();
+    for (int i = 0; i < ctx->rounds * 10; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/live/livestream_%d.flv", (i * 7919) % SRS_MICRO_BENCH_MOUNTS);
+        
+        SrsHttpMuxEntry* matched = NULL;
+        if (!reference) {
+            matched = tree.match(path);
+        } else {
+            // the linear scan, match the longest pattern.
+            int nb_path = (int)strlen(path);
+            for (int j = 0; j < (int)entries.size(); j++) {
+                SrsHttpMuxEntry* entry = entries.at(j);
+                int nb_pattern = (int)entry->pattern.length();
+                if (nb_pattern > nb_path || memcmp(entry->pattern.data(), path, nb_pattern) != 0) {
+                    continue;
+                }
+                if (nb_pattern != nb_path && entry->pattern.at(nb_pattern - 1) != '/') {
+                    continue;
+                }
+                if (!matched || matched->pattern.length() < entry->pattern.length()) {
+                    matched = entry;
+                }
+            }
+        }
+        
+        nb_matched += matched? 1 : 0;
+        r->ops++;
+    }
+    r->us = srs_perf_now_us() - starttime;
+    
+    // use the result, avoid the compiler to optimize it.
+    r->checksum = nb_matched;
+    
+    for (int i = 0; i < (int)entries.size(); i++) {
+        SrsHttpMuxEntry* entry = entries.at(i);
+        srs_freep(entry);
+    }
+    
+    return ret;
+}
+
+/**
+ * create the result of benchmark when its name matches the filter.
+ * @return NULL when not match, the benchmark should be skipped.
+ */
+SrsMicroResult* micro_bench_result(std::vector<SrsMicroResult*>& results, string name, string filter)
+{
+    if (!filter.empty() && !srs_string_contains(name, filter)) {
+        return NULL;
+    }
+    
+    SrsMicroResult* r = new SrsMicroResult();
+    r->name = name;
+    results.push_back(r);
+    
+    return r;
+}
+
+int run_micro_bench(string input, int rounds, string filter, string output)
+{
+    int ret = ERROR_SUCCESS;
+    
+    SrsMicroContext ctx;
+    ctx.rounds = srs_max(1, rounds);
+    
+    if (!input.empty() && (ret = ctx.load(input)) != ERROR_SUCCESS) {
+        return ret;
+    }
+    
+    std::vector<SrsMicroResult*> results;
+    
+    // the benchmarks fed from sample file.
+    if (!ctx.tags.empty()) {
+        SrsMicroResult* r = NULL;
+        
+        if ((r = micro_bench_result(results, "codec_demux", filter)) != NULL
+            && (ret = bench_codec_demux(&ctx, r)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        
+        if ((r = micro_bench_result(results, "ts_encode", filter)) != NULL
+            && (ret = bench_ts_encode(&ctx, r)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        
+        if ((r = micro_bench_result(results, "flv_write_tags", filter)) != NULL
+            && (ret = bench_flv_write_tags(&ctx, r)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        
+        if ((r = micro_bench_result(results, "annexb_find", filter)) != NULL
+            && (ret = bench_annexb(&ctx, r, false)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        if ((r = micro_bench_result(results, "annexb_find_reference", filter)) != NULL) {
+            bench_annexb(&ctx, r, true);
+        }
+        
+        // the encode and decode run together, for decode use the encoded chunks.
+        SrsMicroResult* encode = micro_bench_result(results, "chunk_encode", filter);
+        SrsMicroResult* decode = micro_bench_result(results, "chunk_decode", filter);
+        if (encode || decode) {
+            SrsMicroResult ignored;
+            if ((ret = bench_chunk_codec(&ctx, encode? encode : &ignored, decode? decode : &ignored)) != ERROR_SUCCESS) {
+                srs_error("bench chunk failed. ret=%d", ret);
+                return ret;
+            }
+        }
+    } else {
+        srs_warn("no sample file, ignore the codec, muxer, annexb and chunk benchmarks");
+    }
+    
+    // the benchmarks of synthetic data.
+    if (true) {
+        SrsMicroResult* r = NULL;
+        
+        if ((r = micro_bench_result(results, "amf0_connect", filter)) != NULL
+            && (ret = bench_amf0_connect(&ctx, r)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        
+        if ((r = micro_bench_result(results, "amf0_metadata", filter)) != NULL
+            && (ret = bench_amf0_metadata(&ctx, r)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        
+        if ((r = micro_bench_result(results, "crc32", filter)) != NULL
+            && (ret = bench_crc32(&ctx, r, false)) != ERROR_SUCCESS
+        ) {
+            srs_error("bench %s failed. ret=%d", r->name.c_str(), ret);
+            return ret;
+        }
+        if ((r = micro_bench_result(results, "crc32_reference", filter)) != NULL) {
+            bench_crc32(&ctx, r, true);
+        }
+        
+        if ((r = micro_bench_result(results, "http_mux_50k", filter)) != NULL) {
+            bench_http_mux(&ctx, r, false);
+        }
+        if ((r = micro_bench_result(results, "http_mux_50k_reference", filter)) != NULL) {
+            bench_http_mux(&ctx, r, true);
+        }
+    }
+    
+    // dumps the results.
+    std::stringstream ss;
+    ss << SRS_JOBJECT_START
+            << SRS_JFIELD_ORG("rounds", ctx.rounds) << SRS_JFIELD_CONT
+            << SRS_JFIELD_STR("sample", input) << SRS_JFIELD_CONT
+            << SRS_JFIELD_NAME("results") << SRS_JARRAY_START;
+    
+    bool first = true;
+    for (int i = 0; i < (int)results.size(); i++) {
+        SrsMicroResult* r = results.at(i);
+        
+        srs_trace("%-24s ops=%"PRId64", %.2f ns/op, %.2f MB/s", r->name.c_str(), r->ops, r->ns_per_op(), r->mbps());
+        
+        if (!first) {
+            ss << SRS_JFIELD_CONT;
+        }
+        first = false;
+        r->dumps(ss);
+        
+        srs_freep(r);
+    }
+    
+    ss << SRS_JARRAY_END
+        << SRS_JOBJECT_END;
+    
+    std::string result = ss.str();
+    if (output.empty()) {
+        printf("%s\n", result.c_str());
+        return ret;
+    }
+    
+    SrsFileWriter fw;
+    if ((ret = fw.open(output)) != ERROR_SUCCESS) {
+        srs_error("open output %s failed. ret=%d", output.c_str(), ret);
+        return ret;
+    }
+    if ((ret = fw.write((void*)result.data(), result.length(), NULL)) != ERROR_SUCCESS) {
+        srs_error("write output %s failed. ret=%d", output.c_str(), ret);
+        return ret;
+    }
+    srs_trace("micro bench result write to %s", output.c_str());
+    
+    return ret;
+}
+
+/**
+* main entrance.
+*/
+int main(int argc, char** argv) 
+{
+    // TODO: support both little and big endian.
+    srs_assert(srs_is_little_endian());
+    
+    srs_trace("srs_micro_bench base on %s, to bench the kernel codecs and muxers", RTMP_SIG_SRS_SERVER);
+    
+    // parse user options.
+    std::string input, filter, output;
+    int rounds = 100;
+    
+    for (int opt = 0; opt < argc; opt++) {
+        char* p = argv[opt];
+        
+        if (p[0] == '-' && p[1] == 'h') {
+            printf("bench the kernel codecs and muxers, write the result in json\n"
+                   "Usage: %s [-i sample_flv] [-n rounds] [-f filter] [-o output]\n"
+                   "   sample_flv      the flv file to feed the codec, muxer and chunk benchmarks.\n"
+                   "   rounds          the rounds to run each benchmark, default 100.\n"
+                   "   filter          only run the benchmark whose name contains it.\n"
+                   "   output          the json file to write result, default to stdout.\n"
+                   "For example:\n"
+                   "   %s -i doc/source.200kbps.768x320.flv\n"
+                   "   %s -i doc/source.200kbps.768x320.flv -n 10 -f chunk -o micro.json\n",
+                   argv[0], argv[0], argv[0]);
+            exit(0);
+        }
+        
+        // only accept -x value
+        if (opt >= argc - 1 || p[0] != '-' || p[1] == 0 || p[2] != 0) {
+            continue;
+        }
+        
+        // parse according the option name.
+        switch (p[1]) {
+            case 'i': input = argv[opt + 1]; break;
+            case 'n': rounds = ::atoi(argv[opt + 1]); break;
+            case 'f': filter = argv[opt + 1]; break;
+            case 'o': output = argv[opt + 1]; break;
+            default: break;
+        }
+    }
+    
+    return run_micro_bench(input, rounds, filter, output);
+}
+
@@ -40,6 +40,7 @@ using namespace std;
 #include <srs_app_server.hpp>
 #include <srs_app_config.hpp>
 #include <srs_app_log.hpp>
+#include <srs_app_event_log.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_core_performance.hpp>
 
@@ -389,6 +390,15 @@ int run_master()
     if ((ret = _srs_server->initialize_st()) != ERROR_SUCCESS) {
         return ret;
     }
+    
+    // start the async log, after daemon forked.
+    SrsFastLog* log = dynamic_cast<SrsFastLog*>(_srs_log);
+    if (log && (ret = log->start()) != ERROR_SUCCESS) {
+        return ret;
+    }
+    if ((ret = SrsEventLog::instance()->initialize()) != ERROR_SUCCESS) {
+        return ret;
+    }
     //初始化信号
     if ((ret = _srs_server->initialize_signal()) != ERROR_SUCCESS) {
         return ret;
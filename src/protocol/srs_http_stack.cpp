@@ -127,6 +127,52 @@ int srs_go_http_error(ISrsHttpResponseWriter* w, int code)
     return srs_go_http_error(w, code, srs_generate_http_status_text(code));
 }
 
+string srs_http_mime_type(string fullpath)
+{
+    static std::map<std::string, std::string> _mime;
+    if (_mime.empty()) {
+        _mime[".ts"] = "video/MP2T";
+        _mime[".flv"] = "video/x-flv";
+        _mime[".m4v"] = "video/x-m4v";
+        _mime[".3gpp"] = "video/3gpp";
+        _mime[".3gp"] = "video/3gpp";
+        _mime[".mp4"] = "video/mp4";
+        _mime[".aac"] = "audio/x-aac";
+        _mime[".mp3"] = "audio/mpeg";
+        _mime[".m4a"] = "audio/x-m4a";
+        _mime[".ogg"] = "audio/ogg";
+        // @see hls-m3u8-draft-pantos-http-live-streaming-12.pdf, page 5.
+        _mime[".m3u8"] = "application/vnd.apple.mpegurl"; // application/x-mpegURL
+        _mime[".rss"] = "application/rss+xml";
+        _mime[".json"] = "application/json";
+        _mime[".swf"] = "application/x-shockwave-flash";
+        _mime[".doc"] = "application/msword";
+        _mime[".zip"] = "application/zip";
+        _mime[".rar"] = "application/x-rar-compressed";
+        _mime[".xml"] = "text/xml";
+        _mime[".html"] = "text/html";
+        _mime[".js"] = "text/javascript";
+        _mime[".css"] = "text/css";
+        _mime[".ico"] = "image/x-icon";
+        _mime[".png"] = "image/png";
+        _mime[".jpeg"] = "image/jpeg";
+        _mime[".jpg"] = "image/jpeg";
+        _mime[".gif"] = "image/gif";
+    }
+    
+    size_t pos;
+    std::string ext = fullpath;
+    if ((pos = ext.rfind(".")) != string::npos) {
+        ext = ext.substr(pos);
+    }
+    
+    if (_mime.find(ext) == _mime.end()) {
+        return "application/octet-stream";
+    }
+    
+    return _mime[ext];
+}
+
 int srs_go_http_error(ISrsHttpResponseWriter* w, int code, string error)
 {
     int ret = ERROR_SUCCESS;
@@ -347,50 +393,7 @@ int SrsHttpFileServer::serve_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r,
     // unset the content length to encode in chunked encoding.
     w->header()->set_content_length(length);
     
-    static std::map<std::string, std::string> _mime;
-    if (_mime.empty()) {
-        _mime[".ts"] = "video/MP2T";
-        _mime[".flv"] = "video/x-flv";
-        _mime[".m4v"] = "video/x-m4v";
-        _mime[".3gpp"] = "video/3gpp";
-        _mime[".3gp"] = "video/3gpp";
-        _mime[".mp4"] = "video/mp4";
-        _mime[".aac"] = "audio/x-aac";
-        _mime[".mp3"] = "audio/mpeg";
-        _mime[".m4a"] = "audio/x-m4a";
-        _mime[".ogg"] = "audio/ogg";
-        // @see hls-m3u8-draft-pantos-http-live-streaming-12.pdf, page 5.
-        _mime[".m3u8"] = "application/vnd.apple.mpegurl"; // application/x-mpegURL
-        _mime[".rss"] = "application/rss+xml";
-        _mime[".json"] = "application/json";
-        _mime[".swf"] = "application/x-shockwave-flash";
-        _mime[".doc"] = "application/msword";
-        _mime[".zip"] = "application/zip";
-        _mime[".rar"] = "application/x-rar-compressed";
-        _mime[".xml"] = "text/xml";
-        _mime[".html"] = "text/html";
-        _mime[".js"] = "text/javascript";
-        _mime[".css"] = "text/css";
-        _mime[".ico"] = "image/x-icon";
-        _mime[".png"] = "image/png";
-        _mime[".jpeg"] = "image/jpeg";
-        _mime[".jpg"] = "image/jpeg";
-        _mime[".gif"] = "image/gif";
-    }
-    
-    if (true) {
-        size_t pos;
-        std::string ext = fullpath;
-        if ((pos = ext.rfind(".")) != string::npos) {
-            ext = ext.substr(pos);
-        }
-        
-        if (_mime.find(ext) == _mime.end()) {
-            w->header()->set_content_type("application/octet-stream");
-        } else {
-            w->header()->set_content_type(_mime[ext]);
-        }
-    }
+    w->header()->set_content_type(srs_http_mime_type(fullpath));
     
     // write body.
     int64_t left = length;
@@ -470,6 +473,23 @@ int SrsHttpFileServer::copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHt
 {
     int ret = ERROR_SUCCESS;
     
+    // zero copy for response with content-length.
+    if (w->header()->content_length() != -1) {
+        int64_t offset = fs->tellg();
+        
+        ret = w->sendfile(fs, offset, size);
+        if (ret == ERROR_SUCCESS) {
+            fs->lseek(offset + size);
+            return ret;
+        }
+        
+        // nothing sent, fallback to read and write.
+        if (ret != ERROR_HTTP_SENDFILE_UNSUPPORTED) {
+            return ret;
+        }
+        ret = ERROR_SUCCESS;
+    }
+    
     int left = size;
     char* buf = r->http_ts_send_buffer();
     
@@ -501,6 +521,116 @@ SrsHttpMuxEntry::~SrsHttpMuxEntry()
     srs_freep(handler);
 }
 
+SrsHttpMuxNode::SrsHttpMuxNode()
+{
+    entry = NULL;
+}
+
+SrsHttpMuxNode::~SrsHttpMuxNode()
+{
+    std::map<char, SrsHttpMuxNode*>::iterator it;
+    for (it = children.begin(); it != children.end(); ++it) {
+        SrsHttpMuxNode* node = it->second;
+        srs_freep(node);
+    }
+    children.clear();
+}
+
+SrsHttpMuxTree::SrsHttpMuxTree()
+{
+    root = new SrsHttpMuxNode();
+}
+
+SrsHttpMuxTree::~SrsHttpMuxTree()
+{
+    srs_freep(root);
+}
+
+void SrsHttpMuxTree::insert(std::string pattern, SrsHttpMuxEntry* entry)
+{
+    srs_assert(!pattern.empty());
+    
+    SrsHttpMuxNode* node = root;
+    size_t pos = 0;
+    
+    while (pos < pattern.length()) {
+        std::map<char, SrsHttpMuxNode*>::iterator it = node->children.find(pattern.at(pos));
+        
+        // no edge starts with the char, append the left as leaf.
+        if (it == node->children.end()) {
+            SrsHttpMuxNode* leaf = new SrsHttpMuxNode();
+            leaf->label = pattern.substr(pos);
+            leaf->entry = entry;
+            node->children[pattern.at(pos)] = leaf;
+            return;
+        }
+        
+        // the common prefix of pattern and the edge label.
+        SrsHttpMuxNode* child = it->second;
+        size_t n = 0;
+        while (n < child->label.length() && pos + n < pattern.length()
+            && child->label.at(n) == pattern.at(pos + n)
+        ) {
+            n++;
+        }
+        
+        // split the edge when pattern diverges inside the label,
+        // for example, insert /live/ when edge is /live/livestream.flv
+        if (n < child->label.length()) {
+            SrsHttpMuxNode* mid = new SrsHttpMuxNode();
+            mid->label = child->label.substr(0, n);
+            child->label = child->label.substr(n);
+            mid->children[child->label.at(0)] = child;
+            it->second = mid;
+            child = mid;
+        }
+        
+        node = child;
+        pos += n;
+    }
+    
+    node->entry = entry;
+}
+
+SrsHttpMuxEntry* SrsHttpMuxTree::match(const std::string& path)
+{
+    SrsHttpMuxEntry* matched = NULL;
+    
+    SrsHttpMuxNode* node = root;
+    size_t pos = 0;
+    
+    // walk down the path, the deeper matched entry is the longer pattern.
+    while (true) {
+        SrsHttpMuxEntry* entry = node->entry;
+        if (entry && entry->enabled) {
+            // endswith '/', match any path starts with it;
+            // otherwise, exactly match when consumed all path.
+            if (path.at(pos - 1) == '/' || pos == path.length()) {
+                matched = entry;
+            }
+        }
+        
+        if (pos >= path.length()) {
+            break;
+        }
+        
+        std::map<char, SrsHttpMuxNode*>::iterator it = node->children.find(path.at(pos));
+        if (it == node->children.end()) {
+            break;
+        }
+        
+        SrsHttpMuxNode* child = it->second;
+        if (path.compare(pos, child->label.length(), child->label) != 0) {
+            break;
+        }
+        
+        node = child;
+        pos += child->label.length();
+    }
+    
+    return matched;
+}
+
 ISrsHttpMatchHijacker::ISrsHttpMatchHijacker()
 {
 }
@@ -519,6 +649,7 @@ ISrsHttpServeMux::~ISrsHttpServeMux()
 
 SrsHttpServeMux::SrsHttpServeMux()
 {
+    tree = new SrsHttpMuxTree();
 }
 
 SrsHttpServeMux::~SrsHttpServeMux()
@@ -529,6 +660,7 @@ SrsHttpServeMux::~SrsHttpServeMux()
         srs_freep(entry);
     }
     entries.clear();
+    srs_freep(tree);
     
     vhosts.clear();
     hijackers.clear();
@@ -600,6 +732,7 @@ int SrsHttpServeMux::handle(std::string pattern, ISrsHttpHandler* handler)
             srs_freep(exists);
         }
         entries[pattern] = entry;
+        tree->insert(pattern, entry);
     }
     
     // Helpful behavior:
@@ -628,6 +761,7 @@ int SrsHttpServeMux::handle(std::string pattern, ISrsHttpHandler* handler)
             entry->handler->entry = entry;
             
             entries[rpattern] = entry;
+            tree->insert(rpattern, entry);
         }
     }
     
@@ -716,26 +850,11 @@ int SrsHttpServeMux::match(ISrsHttpMessage* r, ISrsHttpHandler** ph)
         path = r->host() + path;
     }
     
-    int nb_matched = 0;
     ISrsHttpHandler* h = NULL;
     
-    std::map<std::string, SrsHttpMuxEntry*>::iterator it;
-    for (it = entries.begin(); it != entries.end(); ++it) {
-        std::string pattern = it->first;
-        SrsHttpMuxEntry* entry = it->second;
-        
-        if (!entry->enabled) {
-            continue;
-        }
-        
-        if (!path_match(pattern, path)) {
-            continue;
-        }
-        
-        if (!h || (int)pattern.length() > nb_matched) {
-            nb_matched = (int)pattern.length();
-            h = entry->handler;
-        }
+    SrsHttpMuxEntry* entry = tree->match(path);
+    if (entry) {
+        h = entry->handler;
     }
     
     *ph = h;
@@ -743,30 +862,6 @@ int SrsHttpServeMux::match(ISrsHttpMessage* r, ISrsHttpHandler** ph)
     return ret;
 }
 
-bool SrsHttpServeMux::path_match(string pattern, string path)
-{
-    if (pattern.empty()) {
-        return false;
-    }
-    
-    int n = (int)pattern.length();
-    
-    // not endswith '/', exactly match.
-    if (pattern.at(n - 1) != '/') {
-        return pattern == path;
-    }
-    
-    // endswith '/', match any,
-    // for example, '/api/' match '/api/[N]'
-    if ((int)path.length() >= n) {
-        if (memcmp(pattern.data(), path.data(), n) == 0) {
-            return true;
-        }
-    }
-    
-    return false;
-}
-
 ISrsHttpMessage::ISrsHttpMessage()
 {
     _http_ts_send_buffer = new char[SRS_HTTP_TS_SEND_BUFFER_SIZE];
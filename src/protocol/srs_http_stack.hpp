@@ -98,6 +98,10 @@ extern bool srs_go_http_body_allowd(int status);
 // returns "application/octet-stream".
 extern std::string srs_go_http_detect(char* data, int size);
 
+// get the mime type of file by its extension,
+// returns "application/octet-stream" for unknown extension.
+extern std::string srs_http_mime_type(std::string fullpath);
+
 // state of message
 enum SrsHttpParseState {
     SrsHttpParseStateInit = 0,
@@ -202,6 +206,15 @@ public:
      * @see https://github.com/ossrs/srs/issues/405
      */
     virtual int writev(iovec* iov, int iovcnt, ssize_t* pnwrite) = 0;
+    /**
+     * send size bytes of file from offset in zero copy, without read the
+     * file to user space, for the static file and vod stream.
+     * @remark only for response with content-length, the chunked response
+     *       and platform without sendfile, use write instead.
+     * @return ERROR_HTTP_SENDFILE_UNSUPPORTED when not supported, user can
+     *       fallback to write before anything sent.
+     */
+    virtual int sendfile(SrsFileReader* fs, int64_t offset, int size) = 0;
     
     // WriteHeader sends an HTTP response header with status code.
     // If WriteHeader is not called explicitly, the first call to Write
@@ -302,11 +315,12 @@ public:
     virtual ~SrsHttpFileServer();
 public:
     virtual int serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r);
-private:
+protected:
     /**
      * serve the file by specified path
      */
     virtual int serve_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
+private:
     virtual int serve_flv_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
     virtual int serve_mp4_file(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
 protected:
@@ -323,7 +337,8 @@ protected:
     virtual int serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int start, int end);
 protected:
     /**
-     * copy the fs to response writer in size bytes.
+     * copy the fs to response writer in size bytes,
+     * from the current position of fs, use sendfile when supported.
      */
     virtual int copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHttpMessage* r, int size);
 };
@@ -342,6 +357,54 @@ public:
     virtual ~SrsHttpMuxEntry();
 };
 
+/**
+ * the node of radix tree, the path compressed prefix tree.
+ * each node holds the label of the edge from its parent,
+ * and the entry when some pattern terminates at this node.
+ */
+class SrsHttpMuxNode
+{
+public:
+    // the label of edge from parent, never empty except the root.
+    std::string label;
+    // the entry whose pattern ends at this node, NULL for intermediate node.
+    // @remark the entry is owned by the mux entries, never free it.
+    SrsHttpMuxEntry* entry;
+    // the children, indexed by the first char of its label.
+    std::map<char, SrsHttpMuxNode*> children;
+public:
+    SrsHttpMuxNode();
+    virtual ~SrsHttpMuxNode();
+};
+
+/**
+ * the radix tree to match the http patterns,
+ * the cost of match is O(length of path) rather than O(number of patterns),
+ * which is important when there are lots of streams mounted.
+ * for the host-specific pattern, the key is prefixed by vhost,
+ * so all patterns of a vhost are in a subtree.
+ */
+class SrsHttpMuxTree
+{
+private:
+    SrsHttpMuxNode* root;
+public:
+    SrsHttpMuxTree();
+    virtual ~SrsHttpMuxTree();
+public:
+    /**
+     * insert the entry for pattern, replace the exists one.
+     */
+    virtual void insert(std::string pattern, SrsHttpMuxEntry* entry);
+    /**
+     * match the longest enabled entry for path, where
+     *      the pattern ends with '/' match any path starts with it,
+     *      the pattern not ends with '/' must exactly match the path.
+     * @return the matched entry, NULL if no entry matched.
+     */
+    virtual SrsHttpMuxEntry* match(const std::string& path);
+};
+
 /**
  * the hijacker for http pattern match.
  */
@@ -403,6 +466,9 @@ class SrsHttpServeMux : public ISrsHttpServeMux
 private:
     // the pattern handler, to handle the http request.
     std::map<std::string, SrsHttpMuxEntry*> entries;
+    // the radix tree of entries to match the request,
+    // @remark the entries owns all entry, the tree only refers to them.
+    SrsHttpMuxTree* tree;
     // the vhost handler.
     // when find the handler to process the request,
     // append the matched vhost when pattern not starts with /,
@@ -439,7 +505,6 @@ public:
 private:
     virtual int find_handler(ISrsHttpMessage* r, ISrsHttpHandler** ph);
     virtual int match(ISrsHttpMessage* r, ISrsHttpHandler** ph);
-    virtual bool path_match(std::string pattern, std::string path);
 };
 
 // for http header.
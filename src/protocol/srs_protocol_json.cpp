@@ -23,9 +23,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <srs_protocol_json.hpp>
 
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
 using namespace std;
 
 #include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
 
 #ifdef SRS_JSON_USE_NXJSON
 
@@ -519,6 +523,474 @@ void SrsJsonArray::add(SrsJsonAny* value)
     properties.push_back(value);
 }
 
+SrsJsonReader::SrsJsonReader(const char* b, int size)
+{
+    bytes = b;
+    nb_bytes = size;
+    
+    // the whole bytes must be a object.
+    const char* p = skip_whitespace(bytes);
+    object = p < bytes + nb_bytes && *p == '{';
+    if (object) {
+        p = skip_value(p, 0);
+        object = p && skip_whitespace(p) == bytes + nb_bytes;
+    }
+}
+
+SrsJsonReader::~SrsJsonReader()
+{
+}
+
+bool SrsJsonReader::is_object()
+{
+    return object;
+}
+
+bool SrsJsonReader::get_integer(const char* name, int64_t* pv)
+{
+    if (!object) {
+        return false;
+    }
+    
+    int nb_name = (int)strlen(name);
+    const char* end = bytes + nb_bytes;
+    
+    // the object is valid, so never check the syntax again.
+    const char* p = skip_whitespace(bytes) + 1;
+    while (true) {
+        p = skip_whitespace(p);
+        if (*p == '}') {
+            return false;
+        }
+        
+        // the key, without the quotes.
+        const char* key = p + 1;
+        p = skip_string(p);
+        int nb_key = (int)(p - key) - 1;
+        
+        p = skip_whitespace(p) + 1;
+        p = skip_whitespace(p);
+        
+        const char* value = p;
+        p = skip_value(p, 0);
+        
+        if (nb_key == nb_name && memcmp(key, name, nb_name) == 0) {
+            // the integer is [-]digits, without fraction or exponent.
+            const char* v = value;
+            bool negative = *v == '-';
+            if (negative) {
+                v++;
+            }
+            
+            int64_t integer = 0;
+            for (; v < p && *v >= '0' && *v <= '9'; v++) {
+                integer = integer * 10 + (*v - '0');
+            }
+            
+            if (v != p || v == value + (negative? 1:0)) {
+                return false;
+            }
+            
+            *pv = negative? -integer : integer;
+            return true;
+        }
+        
+        p = skip_whitespace(p);
+        if (p >= end || *p != ',') {
+            return false;
+        }
+        p++;
+    }
+    
+    return false;
+}
+
+const char* SrsJsonReader::skip_value(const char* p, int depth)
+{
+    const char* end = bytes + nb_bytes;
+    
+    p = skip_whitespace(p);
+    if (p >= end || depth >= SRS_JSON_WRITER_MAX_DEPTH) {
+        return NULL;
+    }
+    
+    if (*p == '"') {
+        return skip_string(p);
+    }
+    
+    if (*p == '{' || *p == '[') {
+        char close = (*p == '{')? '}' : ']';
+        bool is_object = *p == '{';
+        
+        p = skip_whitespace(p + 1);
+        if (p < end && *p == close) {
+            return p + 1;
+        }
+        
+        while (p && p < end) {
+            if (is_object) {
+                p = skip_whitespace(p);
+                if (p >= end || *p != '"' || (p = skip_string(p)) == NULL) {
+                    return NULL;
+                }
+                p = skip_whitespace(p);
+                if (p >= end || *p != ':') {
+                    return NULL;
+                }
+                p++;
+            }
+            
+            if ((p = skip_value(p, depth + 1)) == NULL) {
+                return NULL;
+            }
+            
+            p = skip_whitespace(p);
+            if (p >= end) {
+                return NULL;
+            }
+            if (*p == close) {
+                return p + 1;
+            }
+            if (*p != ',') {
+                return NULL;
+            }
+            p++;
+        }
+        return NULL;
+    }
+    
+    // the literal of true, false and null.
+    static const char* literals[] = {"true", "false", "null"};
+    for (int i = 0; i < 3; i++) {
+        int nb = (int)strlen(literals[i]);
+        if (end - p >= nb && memcmp(p, literals[i], nb) == 0) {
+            return p + nb;
+        }
+    }
+    
+    // the number, [-]digits[.digits][e[+-]digits]
+    const char* start = p;
+    if (*p == '-') {
+        p++;
+    }
+    const char* digits = p;
+    while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E'
+        || ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E'))
+    )) {
+        p++;
+    }
+    if (p == digits || *digits < '0' || *digits > '9') {
+        return NULL;
+    }
+    
+    return (p > start)? p : NULL;
+}
+
+const char* SrsJsonReader::skip_string(const char* p)
+{
+    const char* end = bytes + nb_bytes;
+    
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    
+    return NULL;
+}
+
+const char* SrsJsonReader::skip_whitespace(const char* p)
+{
+    const char* end = bytes + nb_bytes;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        p++;
+    }
+    return p;
+}
+
+SrsJsonWriter::SrsJsonWriter(int size)
+{
+    capacity = srs_max(size, 64);
+    buf = new char[capacity];
+    nb_buf = 0;
+    
+    depth = 0;
+    first[0] = true;
+    named = false;
+}
+
+SrsJsonWriter::~SrsJsonWriter()
+{
+    srs_freepa(buf);
+}
+
+void SrsJsonWriter::reset()
+{
+    nb_buf = 0;
+    depth = 0;
+    first[0] = true;
+    named = false;
+}
+
+char* SrsJsonWriter::bytes()
+{
+    return buf;
+}
+
+int SrsJsonWriter::size()
+{
+    return nb_buf;
+}
+
+string SrsJsonWriter::str()
+{
+    return string(buf, nb_buf);
+}
+
+void SrsJsonWriter::object_start()
+{
+    separate();
+    append("{", 1);
+    
+    srs_assert(depth < SRS_JSON_WRITER_MAX_DEPTH - 1);
+    first[++depth] = true;
+}
+
+void SrsJsonWriter::object_end()
+{
+    srs_assert(depth > 0);
+    depth--;
+    append("}", 1);
+}
+
+void SrsJsonWriter::array_start()
+{
+    separate();
+    append("[", 1);
+    
+    srs_assert(depth < SRS_JSON_WRITER_MAX_DEPTH - 1);
+    first[++depth] = true;
+}
+
+void SrsJsonWriter::array_end()
+{
+    srs_assert(depth > 0);
+    depth--;
+    append("]", 1);
+}
+
+void SrsJsonWriter::name(const char* k)
+{
+    separate();
+    
+    append("\"", 1);
+    append_escaped(k, (int)strlen(k));
+    append("\":", 2);
+    
+    named = true;
+}
+
+void SrsJsonWriter::value_str(const char* v)
+{
+    separate();
+    
+    append("\"", 1);
+    append_escaped(v, (int)strlen(v));
+    append("\"", 1);
+}
+
+void SrsJsonWriter::value_str(const string& v)
+{
+    separate();
+    
+    append("\"", 1);
+    append_escaped(v.data(), (int)v.length());
+    append("\"", 1);
+}
+
+void SrsJsonWriter::value_int(int64_t v)
+{
+    separate();
+    
+    // format the digits in reverse order.
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    
+    // use the unsigned to avoid overflow of INT64_MIN.
+    u_int64_t uv = (v < 0)? (u_int64_t)0 - (u_int64_t)v : (u_int64_t)v;
+    do {
+        *--p = '0' + (char)(uv % 10);
+        uv /= 10;
+    } while (uv > 0);
+    
+    if (v < 0) {
+        *--p = '-';
+    }
+    
+    append(p, (int)(tmp + sizeof(tmp) - p));
+}
+
+void SrsJsonWriter::value_number(double v)
+{
+    separate();
+    
+    // the json never support the NaN and Inf.
+    if (isnan(v) || isinf(v)) {
+        append("null", 4);
+        return;
+    }
+    
+    char tmp[32];
+    int nb = snprintf(tmp, sizeof(tmp), "%.10g", v);
+    append(tmp, nb);
+}
+
+void SrsJsonWriter::value_bool(bool v)
+{
+    separate();
+    
+    if (v) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+}
+
+void SrsJsonWriter::value_null()
+{
+    separate();
+    append("null", 4);
+}
+
+void SrsJsonWriter::field_str(const char* k, const char* v)
+{
+    name(k);
+    value_str(v);
+}
+
+void SrsJsonWriter::field_str(const char* k, const string& v)
+{
+    name(k);
+    value_str(v);
+}
+
+void SrsJsonWriter::field_int(const char* k, int64_t v)
+{
+    name(k);
+    value_int(v);
+}
+
+void SrsJsonWriter::field_number(const char* k, double v)
+{
+    name(k);
+    value_number(v);
+}
+
+void SrsJsonWriter::field_bool(const char* k, bool v)
+{
+    name(k);
+    value_bool(v);
+}
+
+void SrsJsonWriter::field_null(const char* k)
+{
+    name(k);
+    value_null();
+}
+
+void SrsJsonWriter::field_obj(const char* k)
+{
+    name(k);
+    object_start();
+}
+
+void SrsJsonWriter::field_arr(const char* k)
+{
+    name(k);
+    array_start();
+}
+
+void SrsJsonWriter::field_error(int code)
+{
+    field_int("code", code);
+}
+
+void SrsJsonWriter::separate()
+{
+    // the value of field, never need comma.
+    if (named) {
+        named = false;
+        return;
+    }
+    
+    if (!first[depth]) {
+        append(",", 1);
+    }
+    first[depth] = false;
+}
+
+void SrsJsonWriter::append(const char* data, int size)
+{
+    ensure(size);
+    memcpy(buf + nb_buf, data, size);
+    nb_buf += size;
+}
+
+void SrsJsonWriter::append_escaped(const char* data, int size)
+{
+    static const char* hex = "0123456789abcdef";
+    
+    // append the bytes in bulk, only escape the special chars.
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* start = p;
+        while (p < end && (unsigned char)*p >= 0x20 && *p != '"' && *p != '\\') {
+            p++;
+        }
+        if (p > start) {
+            append(start, (int)(p - start));
+        }
+        if (p >= end) {
+            break;
+        }
+        
+        char ch = *p++;
+        switch (ch) {
+            case '"': append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\b': append("\\b", 2); break;
+            case '\f': append("\\f", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', hex[(ch >> 4) & 0x0f], hex[ch & 0x0f]};
+                append(u, 6);
+                break;
+            }
+        }
+    }
+}
+
+void SrsJsonWriter::ensure(int size)
+{
+    if (nb_buf + size <= capacity) {
+        return;
+    }
+    
+    // grow to double size at least.
+    int cap = srs_max(capacity * 2, nb_buf + size);
+    char* nb = new char[cap];
+    memcpy(nb, buf, nb_buf);
+    
+    srs_freepa(buf);
+    buf = nb;
+    capacity = cap;
+}
+
 #ifdef SRS_JSON_USE_NXJSON
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
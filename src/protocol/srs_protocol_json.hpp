@@ -171,6 +171,124 @@ public:
     virtual void add(SrsJsonAny* value);
 };
 
+/**
+ * the zero-copy json reader, scan the json in place without build
+ * the tree of SrsJsonAny, for the small responses which only need some
+ * fields of the top-level object, for example, the http callback:
+ *      SrsJsonReader reader(res.data(), (int)res.length());
+ *      int64_t code = 0;
+ *      if (reader.is_object() && reader.get_integer("code", &code)) {
+ *          // use the code.
+ *      }
+ * @remark user must keep the bytes alive when use the reader.
+ */
+class SrsJsonReader
+{
+private:
+    const char* bytes;
+    int nb_bytes;
+    // whether the bytes is a valid json object.
+    bool object;
+public:
+    SrsJsonReader(const char* b, int size);
+    virtual ~SrsJsonReader();
+public:
+    /**
+     * whether the bytes is a valid json object.
+     */
+    virtual bool is_object();
+    /**
+     * get the integer property of the top-level object.
+     * @return false if not object, not found or not integer.
+     */
+    virtual bool get_integer(const char* name, int64_t* pv);
+private:
+    // skip the json value, return the next position or NULL when invalid.
+    virtual const char* skip_value(const char* p, int depth);
+    virtual const char* skip_string(const char* p);
+    virtual const char* skip_whitespace(const char* p);
+};
+
+// the max depth of json writer, the api never exceed it.
+#define SRS_JSON_WRITER_MAX_DEPTH 32
+
+/**
+ * the streaming json writer, which appends to a growable buffer,
+ * reuse it by reset() to avoid the malloc for each json.
+ * the comma between fields or elements is appended automatically,
+ * and the string is escaped, for example:
+ *      SrsJsonWriter json;
+ *      json.object_start();
+ *          json.field_int("code", 0);
+ *          json.field_obj("data");
+ *              json.field_str("name", "srs");
+ *              json.field_bool("enabled", true);
+ *          json.object_end();
+ *      json.object_end();
+ * it's:
+ *      {"code":0,"data":{"name":"srs","enabled":true}}
+ */
+class SrsJsonWriter
+{
+private:
+    char* buf;
+    int nb_buf;
+    int capacity;
+private:
+    // the current depth of object or array.
+    int depth;
+    // whether the next value is the first one of the depth.
+    bool first[SRS_JSON_WRITER_MAX_DEPTH];
+    // whether the name is written, the value follows without comma.
+    bool named;
+public:
+    SrsJsonWriter(int size = 4096);
+    virtual ~SrsJsonWriter();
+public:
+    /**
+     * reset the writer to write a new json, the buffer is reused.
+     */
+    virtual void reset();
+    virtual char* bytes();
+    virtual int size();
+    virtual std::string str();
+public:
+    virtual void object_start();
+    virtual void object_end();
+    virtual void array_start();
+    virtual void array_end();
+    /**
+     * write the name of field, then write the value or object/array.
+     */
+    virtual void name(const char* k);
+    virtual void value_str(const char* v);
+    virtual void value_str(const std::string& v);
+    virtual void value_int(int64_t v);
+    /**
+     * write the float number, the NaN or Inf is written as null.
+     */
+    virtual void value_number(double v);
+    virtual void value_bool(bool v);
+    virtual void value_null();
+public:
+    // the shortcuts for name then value.
+    virtual void field_str(const char* k, const char* v);
+    virtual void field_str(const char* k, const std::string& v);
+    virtual void field_int(const char* k, int64_t v);
+    virtual void field_number(const char* k, double v);
+    virtual void field_bool(const char* k, bool v);
+    virtual void field_null(const char* k);
+    virtual void field_obj(const char* k);
+    virtual void field_arr(const char* k);
+    // the error code field of api.
+    virtual void field_error(int code);
+private:
+    virtual void separate();
+    virtual void append(const char* data, int size);
+    virtual void append_escaped(const char* data, int size);
+    virtual void ensure(int size);
+};
+
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
@@ -59,11 +59,10 @@ int SrsRawH264Stream::annexb_demux(SrsStream* stream, char** pframe, int* pnb_fr
         
         // find the last frame prefixed by annexb format.
         stream->skip(pnb_start_code);
-        while (!stream->empty()) {
-            if (srs_avc_startswith_annexb(stream, NULL)) {
-                break;
-            }
-            stream->skip(1);
+        if (!stream->empty()) {
+            int left = stream->size() - stream->pos();
+            int nb_frame = srs_avc_find_annexb(stream->data() + stream->pos(), left);
+            stream->skip(nb_frame < 0? left : nb_frame);
         }
         
         // demux the frame.
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <srs_kernel_stream.hpp>
 #include <srs_core_autofree.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_kernel_perf.hpp>
 #include <srs_protocol_buffer.hpp>
 #include <srs_rtmp_utility.hpp>
 #include <srs_rtmp_handshake.hpp>
@@ -980,6 +981,9 @@ int SrsProtocol::recv_interlaced_message(SrsCommonMessage** pmsg)
     }
     srs_verbose("read basic header success. fmt=%d, cid=%d", fmt, cid);
     
+    // measure the chunk decode, exclude the wait for basic header.
+    SrsPerfAuto(SrsPerfStageChunkDecode);
+    
     // the cid must not negative.
     srs_assert(cid >= 0);
     